@@ -30,6 +30,7 @@
 #include <math.h>
 #include <errno.h>
 #include <assert.h>
+#include <time.h>
 
 #include <sys/signal.h>
 
@@ -134,6 +135,46 @@ void PF_PrintVector(coal::vm_c * vm, int argc)
 	printf("'%1.3f %1.3f %1.3f'\n", vec[0], vec[1], vec[2]);
 }
 
+// stand-in for the drawing functions used by the benchmarks
+void PF_Nothing(coal::vm_c * vm, int argc)
+{
+	for (int i = 0; i < argc; i++)
+		vm->AccessParam(i);
+}
+
+
+//==================================================================//
+
+
+static double RunMain(int main_func, int count)
+{
+	clock_t start = clock();
+
+	for (int i = 0; i < count; i++)
+	{
+		if (coalvm->Execute(main_func) != 0)
+			Error("script terminated by error\n");
+	}
+
+	return (double)(clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+}
+
+void Benchmark(int main_func, int count)
+{
+	// the first run decodes the functions for the fast engine
+	coalvm->SetFastExec(true);
+	RunMain(main_func, 1);
+
+	coalvm->SetFastExec(false);
+	double slow_ms = RunMain(main_func, count);
+
+	coalvm->SetFastExec(true);
+	double fast_ms = RunMain(main_func, count);
+
+	printf("%d runs:  original %1.1f ms   fast %1.1f ms   (x%1.2f)\n",
+		   count, slow_ms, fast_ms, slow_ms / (fast_ms > 0 ? fast_ms : 1.0));
+}
+
 
 //==================================================================//
 
@@ -144,12 +185,22 @@ int main(int argc, char **argv)
 	char	filename[1024];
 
 	int   k;
+	int   bench = 0;
+
+	const char *save_image = NULL;
+	const char *load_image = NULL;
 
 	if (argc <= 1 ||
 	    (strcmp(argv[1], "-?") == 0) || (strcmp(argv[1], "-h") == 0) ||
 		(strcmp(argv[1], "-help") == 0) || (strcmp(argv[1], "--help") == 0))
 	{
 		printf("USAGE: coal [OPTIONS] filename.ec ...\n");
+		printf("\n");
+		printf("  -a        dump assembly of compiled functions\n");
+		printf("  -t        trace execution\n");
+		printf("  -b <num>  benchmark: run main() <num> times on each engine\n");
+		printf("  -w <img>  write the compiled program to an image file\n");
+		printf("  -r <img>  read an image file instead of compiling\n");
 		return 0;
 	}
 
@@ -161,6 +212,10 @@ int main(int argc, char **argv)
 
 	coalvm->AddNativeFunction("sys.print", PF_PrintStr);
 
+	coalvm->AddNativeFunction("hud.text_color", PF_Nothing);
+	coalvm->AddNativeFunction("hud.draw_text",  PF_Nothing);
+	coalvm->AddNativeFunction("hud.draw_num",   PF_Nothing);
+
 	if (strcmp(argv[1], "-a") == 0)
 	{
 		coalvm->SetAsmDump(true);
@@ -173,9 +228,32 @@ int main(int argc, char **argv)
 		argv++; argc--;
 	}
 
+	if (strcmp(argv[1], "-b") == 0 && argc > 2)
+	{
+		bench = atoi(argv[2]);
+		argv += 2; argc -= 2;
+	}
+
+	if (strcmp(argv[1], "-w") == 0 && argc > 2)
+	{
+		save_image = argv[2];
+		argv += 2; argc -= 2;
+	}
+	else if (strcmp(argv[1], "-r") == 0 && argc > 2)
+	{
+		load_image = argv[2];
+		argv += 2; argc -= 2;
+	}
+
+	if (load_image)
+	{
+		if (! coalvm->LoadImage(load_image))
+			Error("Failed to load image: %s\n", load_image);
+	}
+
 
 	// compile all the files
-	for (k = 1; k < argc; k++)
+	for (k = 1; k < argc && ! load_image; k++)
 	{
 		if (argv[k][0] == '-')
 			Error("Bad filename: %s\n", argv[k]);
@@ -197,6 +275,9 @@ int main(int argc, char **argv)
 
 	coalvm->ShowStats();
 
+	if (save_image && ! coalvm->SaveImage(save_image))
+		Error("Failed to write image: %s\n", save_image);
+
 
 	// find 'main' function
 
@@ -205,6 +286,12 @@ int main(int argc, char **argv)
 	if (! main_func)
 		Error("No main function!\n");
 
+	if (bench > 0)
+	{
+		Benchmark(main_func, bench);
+		return 0;
+	}
+
 	if (coalvm->Execute(main_func) != 0)
 	{
 		fprintf(stderr, "\n*** script terminated by error\n");
@@ -26,6 +26,7 @@
 #include <stdlib.h>
 #include <stdarg.h>
 #include <string.h>
+#include <stdint.h>
 #include <ctype.h>
 #include <math.h>
 #include <errno.h>
@@ -33,6 +34,8 @@
 
 // #include <sys/signal.h>
 
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "coal.h"
@@ -1578,6 +1581,8 @@ void real_vm_c::GLOB_Function()
 	function_t *df = new function_t;
 	memset(df, 0, sizeof(function_t));
 
+	function_names[func_name] = (int)functions.size();
+
 	functions.push_back(df);
 
 	df->name = func_name;  // already strdup'd
@@ -1807,6 +1812,9 @@ void real_vm_c::GLOB_Globals()
 //
 bool real_vm_c::CompileFile(char *buffer, const char *filename)
 {
+	// functions may get redefined, so throw away any decoded code
+	FAST_Flush();
+
 	comp.source_file = filename;
 	comp.source_line = 1;
 	comp.function_line = 0;
@@ -1850,6 +1858,8 @@ void real_vm_c::ShowStats()
 	printer("string memory: %d / %d\n",  string_mem.usedMemory(), string_mem.totalMemory());
 	printer("instruction memory: %d / %d\n", op_mem.usedMemory(), op_mem.totalMemory());
 	printer("globals memory: %d / %d\n", global_mem.usedMemory(), global_mem.totalMemory());
+	printer("temp strings: %d bytes in %d allocs (peak %d), %d promoted\n",
+			exec.temp_bytes, exec.temp_allocs, exec.temp_peak, (int)promoted_strings.size());
 }
 
 
@@ -1857,7 +1867,10 @@ real_vm_c::real_vm_c() :
 	printer(default_printer),
 	op_mem(), global_mem(), string_mem(), temp_strings(),
 	functions(), native_funcs(),
-	comp(), exec()
+	function_names(), native_names(),
+	comp(), exec(),
+	fast_exec(true), fast_funcs(),
+	promoted_strings(), promoted_free(), promoted_bytes(0)
 {
 	// string #0 must be the empty string
 	int ofs = string_mem.alloc(2);
@@ -26,13 +26,18 @@
 #include <stdlib.h>
 #include <stdarg.h>
 #include <string.h>
+#include <stdint.h>
 #include <ctype.h>
 #include <math.h>
 #include <errno.h>
+#include <limits.h>
 #include <assert.h>
 
 #include "coal.h"
 
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 
@@ -50,7 +55,8 @@ namespace coal
 
 execution_c::execution_c() :
 	s(0), func(0), tracing(false),
-	stack_depth(0), call_depth(0)
+	stack_depth(0), call_depth(0), nesting(0),
+	temp_allocs(0), temp_bytes(0), temp_peak(0)
 { }
 
 execution_c::~execution_c()
@@ -70,18 +76,22 @@ void real_vm_c::default_aborter(const char *msg, ...)
 
 int real_vm_c::GetNativeFunc(const char *name, const char *module)
 {
-	char buffer[256];
+	std::string full_name;
 
 	if (module)
-		sprintf(buffer, "%s.%s", module, name);
-	else
-		strcpy(buffer, name);
+	{
+		full_name = module;
+		full_name += '.';
+	}
 
-	for (int i = 0; i < (int)native_funcs.size(); i++)
-		if (strcmp(native_funcs[i]->name, buffer) == 0)
-			return i;
-	
-	return -1;  // NOT FOUND
+	full_name += name;
+
+	std::unordered_map< std::string, int >::iterator it = native_names.find(full_name);
+
+	if (it == native_names.end())
+		return -1;  // NOT FOUND
+
+	return it->second;
 }
 
 void real_vm_c::AddNativeFunction(const char *name, native_func_t func)
@@ -100,6 +110,8 @@ void real_vm_c::AddNativeFunction(const char *name, native_func_t func)
 	reg->name = strdup(name);
 	reg->func = func;
 
+	native_names[reg->name] = (int)native_funcs.size();
+
 	native_funcs.push_back(reg);
 }
 
@@ -112,15 +124,12 @@ void real_vm_c::SetTrace(bool enable)
 
 int real_vm_c::FindFunction(const char *func_name)
 {
-	for (int i = (int)functions.size()-1; i >= 1; i--)
-	{
-		function_t *f = functions[i];
+	std::unordered_map< std::string, int >::iterator it = function_names.find(func_name);
 
-		if (strcmp(f->name, func_name) == 0)
-			return i;
-	}
+	if (it == function_names.end())
+		return vm_c::NOT_FOUND;
 
-	return vm_c::NOT_FOUND;
+	return it->second;
 }
 
 int real_vm_c::FindVariable(const char *var_name)
@@ -142,6 +151,121 @@ int	real_vm_c::InternaliseString(const char *new_s)
 	return ofs;
 }
 
+//
+// Copies a temporary string into the string heap, for storing in a
+// global variable (which outlives the temp string arena).  The same
+// text always gives the same offset, so a HUD script which keeps
+// storing the same few values does not use more memory each frame.
+// Strings which no global refers to any more are reclaimed by
+// CollectPromotedStrings().
+//
+#define PROMOTE_MIN_SIZE     16
+#define PROMOTE_COLLECT_AT   65536
+
+static int PromoteSize(int len)
+{
+	// round up, so the space of collected strings is easy to re-use
+	int size = PROMOTE_MIN_SIZE;
+
+	while (size < len + 1)
+		size *= 2;
+
+	return size;
+}
+
+int real_vm_c::PromoteString(int temp)
+{
+	if (temp >= 0)
+		return temp;
+
+	const char *s = REF_STRING(temp);
+
+	if (s[0] == 0)
+		return 0;
+
+	std::unordered_map< std::string, int >::iterator it = promoted_strings.find(s);
+
+	if (it != promoted_strings.end())
+		return it->second;
+
+	int size = PromoteSize(strlen(s));
+	int ofs;
+
+	std::vector<int>& free_list = promoted_free[size];
+
+	if (! free_list.empty())
+	{
+		ofs = free_list.back();
+		free_list.pop_back();
+	}
+	else
+		ofs = string_mem.alloc(size);
+
+	promoted_bytes += size;
+
+	strcpy((char *)string_mem.deref(ofs), s);
+
+	promoted_strings[s] = ofs;
+
+	return ofs;
+}
+
+static void MarkStringValue(double value, void *data)
+{
+	std::unordered_set<int> *used = (std::unordered_set<int> *) data;
+
+	if (value > 0 && value < INT_MAX && value == (int)value)
+		used->insert((int)value);
+}
+
+//
+// Frees the promoted strings which no global refers to.  Only called
+// from the outermost Execute(), when no function is running, hence
+// the globals are the only place where a string can be kept.  Every
+// global which looks like a string offset counts, so a number can
+// keep a string alive, but a live string is never freed.
+//
+void real_vm_c::CollectPromotedStrings()
+{
+	std::unordered_set<int> used;
+
+	global_mem.scanDoubles(MarkStringValue, &used);
+
+	std::unordered_map< std::string, int >::iterator it = promoted_strings.begin();
+
+	while (it != promoted_strings.end())
+	{
+		if (used.find(it->second) != used.end())
+		{
+			it++;
+			continue;
+		}
+
+		promoted_free[PromoteSize(it->first.size())].push_back(it->second);
+
+		it = promoted_strings.erase(it);
+	}
+
+	promoted_bytes = 0;
+}
+
+//
+// Allocates a temporary string of 'len' characters (plus the NUL),
+// returning the value which refers to it.  Temporary strings live
+// until the outermost Execute() call returns.
+//
+int real_vm_c::NewTempString(int len, char **buf)
+{
+	int index = temp_strings.alloc(len + 1);
+
+	*buf = (char *) temp_strings.deref(index);
+
+	exec.temp_allocs++;
+	exec.temp_bytes += len + 1;
+
+	return -(1 + index);
+}
+
 
 double * real_vm_c::AccessParam(int p)
 {
@@ -189,14 +313,12 @@ void real_vm_c::ReturnString(const char *s, int len)
 	}
 	else
 	{
-		int index = temp_strings.alloc(len + 1);
+		char *s3;
 
-		char *s3  = (char *) temp_strings.deref(index);
+		G_FLOAT(OFS_RETURN*8) = NewTempString(len, &s3);
 
 		memcpy(s3, s, (size_t)len);
 		s3[len] = 0;
-
-		G_FLOAT(OFS_RETURN*8) = -(1 + index);
 	}
 }
 
@@ -234,13 +356,13 @@ int real_vm_c::STR_Concat(const char * s1, const char * s2)
 	if (len1 == 0 && len2 == 0)
 		return 0;
 
-	int index = temp_strings.alloc(len1 + len2 + 1);
-	char *s3  = (char *) temp_strings.deref(index);
+	char *s3;
+	int result = NewTempString(len1 + len2, &s3);
 
 	strcpy(s3, s1);
 	strcpy(s3 + len1, s2);
 
-	return -(1 + index);
+	return result;
 
 }
 
@@ -474,7 +596,7 @@ void real_vm_c::DoExecute(int fnum)
 				// temp strings must be internalised when assigned
 				// to a global variable.
 				if (*a < 0 && st->b > OFS_RETURN*8)
-					*b = InternaliseString(REF_STRING((int)*a));
+					*b = PromoteString((int)*a);
 				else
 					*b = *a;
 				break;
@@ -518,19 +640,19 @@ void real_vm_c::DoExecute(int fnum)
 				// temp strings must be internalised when assigned
 				// to a global variable.
 				if (st->c > OFS_RETURN*8)
-					*c = InternaliseString(REF_STRING((int)*c));
+					*c = PromoteString((int)*c);
 				break;
 
 			case OP_ADD_SF:
 				*c = STR_ConcatFloat(REF_STRING((int)*a), *b);
 				if (st->c > OFS_RETURN*8)
-					*c = InternaliseString(REF_STRING((int)*c));
+					*c = PromoteString((int)*c);
 				break;
 
 			case OP_ADD_SV:
 				*c = STR_ConcatVector(REF_STRING((int)*a), b);
 				if (st->c > OFS_RETURN*8)
-					*c = InternaliseString(REF_STRING((int)*c));
+					*c = PromoteString((int)*c);
 				break;
 
 			case OP_SUB_F:
@@ -646,8 +768,15 @@ void real_vm_c::DoExecute(int fnum)
 
 int real_vm_c::Execute(int func_id)
 {
-	// re-use the temporary string space
-	temp_strings.reset();
+	int result = 0;
+
+	// a native function may call Execute() again, so only the
+	// outermost call may free the temporary strings.
+	if (exec.nesting++ == 0)
+	{
+		exec.temp_allocs = 0;
+		exec.temp_bytes  = 0;
+	}
 
 	try
 	{
@@ -656,16 +785,30 @@ int real_vm_c::Execute(int func_id)
 			RunError("vm_c::Execute: NULL function");
 		}
 
-		DoExecute(func_id);
+		// the original engine is kept for tracing
+		if (fast_exec && ! exec.tracing)
+			FAST_Execute(func_id);
+		else
+			DoExecute(func_id);
 	}
 	catch (exec_error_x err)
 	{
-		return 9;
+		result = 9;
 	}
 
-	// printer("TEMP_STRINGs: %d / %d\n", temp_strings.usedMemory(), temp_strings.totalMemory());
+	if (--exec.nesting == 0)
+	{
+		if (exec.temp_bytes > exec.temp_peak)
+			exec.temp_peak = exec.temp_bytes;
+
+		// re-use the temporary string space
+		temp_strings.reset();
+
+		if (promoted_bytes >= PROMOTE_COLLECT_AT)
+			CollectPromotedStrings();
+	}
 
-	return 0;
+	return result;
 }
 
 
@@ -46,11 +46,82 @@ public:
 	call_stack_c call_stack[MAX_CALL_STACK+1];
 	int call_depth;
 
+	// number of Execute() calls in progress.  Temporary strings
+	// are freed when the outermost one returns.
+	int nesting;
+
+	// temporary string usage of the last outermost Execute()
+	int temp_allocs;
+	int temp_bytes;
+	int temp_peak;
+
 public:
 	 execution_c();
 	~execution_c();
 };
 
+
+//
+// The fast execution engine (c_fastexec.cc) runs a pre-decoded copy
+// of each function's statements.  Operands are resolved up-front to
+// either the address of a global or a byte offset into the current
+// stack frame, jumps are resolved to statement indices, and some
+// common statement pairs are fused into a single superinstruction.
+//
+
+enum
+{
+	// superinstructions.  The second statement of the pair is kept
+	// (unchanged) after the fused one, since it may be a jump target.
+
+	FOP_PARM_CALL = NUM_OPERATIONS,   // PARM_F + CALL
+
+	FOP_ADD_MOVE,	// ADD_F + MOVE_F
+	FOP_SUB_MOVE,	// SUB_F + MOVE_F
+	FOP_MUL_MOVE,	// MUL_F + MOVE_F
+
+	FOP_LE_IFNOT,	// LE + IFNOT
+	FOP_GE_IFNOT,
+	FOP_LT_IFNOT,
+	FOP_GT_IFNOT,
+	FOP_EQ_IFNOT,	// EQ_F + IFNOT
+	FOP_NE_IFNOT,	// NE_F + IFNOT
+
+	NUM_FAST_OPS
+};
+
+
+struct fast_op_c
+{
+	short op;   // OP_XXX or FOP_XXX
+
+	// which base each operand is relative to: 0 for absolute
+	// (global) addresses, 1 for the current stack frame.
+	byte sel_a, sel_b, sel_c, sel_d;
+
+	intptr_t a, b, c, d;
+
+	int jump;     // index of target statement (jumps)
+	int cost;     // runaway cost when jump is taken (backwards only)
+	int aux;      // argc for calls, flags for string ops, etc..
+
+	int next_s;   // offset of following statement (in op_mem)
+};
+
+
+class fast_func_c
+{
+public:
+	int first_s;  // offset of first statement (in op_mem)
+	int start;    // index to begin execution at
+
+	std::vector<fast_op_c> code;
+
+public:
+	 fast_func_c() : first_s(0), start(0), code() { }
+	~fast_func_c() { }
+};
+
 #endif /* __COAL_EXECUTION_STUFF_H__ */
 
 //--- editor settings ---
@@ -0,0 +1,872 @@
+//----------------------------------------------------------------------
+//  COAL FAST EXECUTION ENGINE
+//----------------------------------------------------------------------
+//
+//  Copyright (C)      2023  The EDGE Team
+//  Copyright (C)      2009  Andrew Apted
+//  Copyright (C) 1996-1997  Id Software, Inc.
+//
+//  Coal is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as
+//  published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  Coal is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+//  the GNU General Public License for more details.
+//
+//----------------------------------------------------------------------
+//
+//  This engine produces the same results as DoExecute() but works on
+//  a pre-decoded form of each function (see fast_op_c), which is
+//  built the first time the function is called.  Compared to the
+//  original engine:
+//
+//  -  operands are already resolved, so there is no per-operand
+//     test for global / local / none.
+//
+//  -  dispatch uses computed goto (when compiled by GCC or Clang),
+//     giving each opcode its own indirect branch.
+//
+//  -  common statement pairs are fused into superinstructions.
+//
+//  -  the runaway counter is only updated by backwards jumps
+//     (by the number of statements jumped over), and tracing is
+//     not checked at all -- the original engine handles that.
+//
+//----------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <assert.h>
+
+#include "coal.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+namespace coal
+{
+
+#include "c_local.h"
+#include "c_execute.h"
+
+
+#define MAX_RUNAWAY  (1000*1000)
+
+#if defined(__GNUC__) || defined(__clang__)
+#define COAL_COMPUTED_GOTO  1
+#endif
+
+
+void real_vm_c::SetFastExec(bool enable)
+{
+	fast_exec = enable;
+}
+
+
+void real_vm_c::FAST_Flush()
+{
+	for (int i = 0; i < (int)fast_funcs.size(); i++)
+		delete fast_funcs[i];
+
+	fast_funcs.clear();
+}
+
+
+void real_vm_c::FAST_Operand(int raw, intptr_t *ofs, byte *sel)
+{
+	if (raw > 0)
+	{
+		// globals never move once allocated
+		*ofs = (intptr_t) REF_GLOBAL(raw);
+		*sel = 0;
+	}
+	else if (raw < 0)
+	{
+		*ofs = (intptr_t) (-(raw + 1) * (int)sizeof(double));
+		*sel = 1;
+	}
+	else
+	{
+		*ofs = 0;
+		*sel = 0;
+	}
+}
+
+
+fast_func_c * real_vm_c::FAST_Decode(function_t *f)
+{
+	fast_func_c *ff = new fast_func_c;
+
+	ff->first_s = f->first_statement;
+
+	int total = (f->last_statement - f->first_statement) / (int)sizeof(statement_t) + 1;
+
+	ff->code.resize(total);
+
+	for (int i = 0; i < total; i++)
+	{
+		int s = f->first_statement + i * (int)sizeof(statement_t);
+
+		statement_t *st = REF_OP(s);
+		fast_op_c   *op = &ff->code[i];
+
+		memset(op, 0, sizeof(fast_op_c));
+
+		op->op     = st->op;
+		op->next_s = s + (int)sizeof(statement_t);
+
+		switch (st->op)
+		{
+			case OP_NULL:
+			case OP_RET:
+				break;
+
+			case OP_CALL:
+				FAST_Operand(st->a, &op->a, &op->sel_a);
+				op->aux = st->b;
+				break;
+
+			case OP_PARM_F:
+			case OP_PARM_V:
+				FAST_Operand(st->a, &op->a, &op->sel_a);
+
+				// parameters go after the locals of the caller
+				op->b = (intptr_t) ((f->locals_end + st->b) * (int)sizeof(double));
+				op->sel_b = 1;
+				break;
+
+			case OP_IF:
+			case OP_IFNOT:
+				FAST_Operand(st->a, &op->a, &op->sel_a);
+				op->jump = st->b;
+				break;
+
+			case OP_GOTO:
+				op->jump = st->b;
+				break;
+
+			case OP_ERROR:
+				// raw values : string offset and line number
+				op->a = st->a;
+				op->b = st->b;
+				break;
+
+			case OP_MOVE_FNC:
+				op->op = OP_MOVE_F;
+				[[fallthrough]];
+
+			case OP_MOVE_F:
+			case OP_MOVE_V:
+				FAST_Operand(st->a, &op->a, &op->sel_a);
+				FAST_Operand(st->b, &op->b, &op->sel_b);
+				break;
+
+			case OP_MOVE_S:
+				// temp strings only need internalising when stored
+				// into a global variable.
+				if (st->b <= OFS_RETURN*8)
+					op->op = OP_MOVE_F;
+
+				FAST_Operand(st->a, &op->a, &op->sel_a);
+				FAST_Operand(st->b, &op->b, &op->sel_b);
+				break;
+
+			default:
+				if (st->op < 0 || st->op >= NUM_OPERATIONS)
+					RunError("Bad opcode %i", st->op);
+
+				if (st->op == OP_NOT_FNC) op->op = OP_NOT_F;
+				if (st->op == OP_EQ_FNC)  op->op = OP_EQ_F;
+				if (st->op == OP_NE_FNC)  op->op = OP_NE_F;
+
+				FAST_Operand(st->a, &op->a, &op->sel_a);
+				FAST_Operand(st->b, &op->b, &op->sel_b);
+				FAST_Operand(st->c, &op->c, &op->sel_c);
+
+				// string results stored in a global get internalised
+				op->aux = (st->c > OFS_RETURN*8) ? 1 : 0;
+				break;
+		}
+	}
+
+	// resolve jump targets to indices, skipping any OP_NULL (they
+	// are emitted for labels).
+	for (int i = 0; i < total; i++)
+	{
+		fast_op_c *op = &ff->code[i];
+
+		if (! (op->op == OP_IF || op->op == OP_IFNOT || op->op == OP_GOTO))
+			continue;
+
+		int target = (op->jump - f->first_statement) / (int)sizeof(statement_t);
+
+		if (target < 0 || target >= total)
+			RunError("Bad jump in %s()", f->name);
+
+		while (target + 1 < total && ff->code[target].op == OP_NULL)
+			target++;
+
+		op->jump = target;
+		op->cost = (target <= i) ? (i - target + 1) : 0;
+	}
+
+	ff->start = 0;
+
+	while (ff->start + 1 < total && ff->code[ff->start].op == OP_NULL)
+		ff->start++;
+
+	FAST_Fuse(ff);
+
+	return ff;
+}
+
+
+// true if the result of 'op' is the input of 'next'
+static inline bool ResultFeeds(const fast_op_c *op, const fast_op_c *next)
+{
+	return (op->c == next->a) && (op->sel_c == next->sel_a);
+}
+
+
+void real_vm_c::FAST_Fuse(fast_func_c *ff)
+{
+	int total = (int)ff->code.size();
+
+	for (int i = 0; i + 1 < total; i++)
+	{
+		fast_op_c *op   = &ff->code[i];
+		fast_op_c *next = &ff->code[i + 1];
+
+		switch (op->op)
+		{
+			case OP_PARM_F:
+				if (next->op == OP_CALL)
+				{
+					op->op = FOP_PARM_CALL;
+
+					op->c     = next->a;
+					op->sel_c = next->sel_a;
+					op->aux   = next->aux;
+
+					op->next_s = next->next_s;
+				}
+				break;
+
+			case OP_ADD_F:
+			case OP_SUB_F:
+			case OP_MUL_F:
+				if (next->op == OP_MOVE_F &&
+					ResultFeeds(op, next))
+				{
+					op->op = (op->op == OP_ADD_F) ? FOP_ADD_MOVE :
+					         (op->op == OP_SUB_F) ? FOP_SUB_MOVE : FOP_MUL_MOVE;
+
+					op->d     = next->b;
+					op->sel_d = next->sel_b;
+				}
+				break;
+
+			case OP_LE:
+			case OP_GE:
+			case OP_LT:
+			case OP_GT:
+			case OP_EQ_F:
+			case OP_NE_F:
+				if (next->op == OP_IFNOT &&
+					ResultFeeds(op, next))
+				{
+					switch (op->op)
+					{
+						case OP_LE:   op->op = FOP_LE_IFNOT; break;
+						case OP_GE:   op->op = FOP_GE_IFNOT; break;
+						case OP_LT:   op->op = FOP_LT_IFNOT; break;
+						case OP_GT:   op->op = FOP_GT_IFNOT; break;
+						case OP_EQ_F: op->op = FOP_EQ_IFNOT; break;
+						case OP_NE_F: op->op = FOP_NE_IFNOT; break;
+					}
+
+					op->jump = next->jump;
+					op->cost = (op->jump <= i) ? (i - op->jump + 1) : 0;
+				}
+				break;
+
+			default:
+				break;
+		}
+	}
+}
+
+
+fast_func_c * real_vm_c::FAST_GetFunction(int func)
+{
+	if ((int)fast_funcs.size() < (int)functions.size())
+		fast_funcs.resize(functions.size(), NULL);
+
+	if (! fast_funcs[func])
+		fast_funcs[func] = FAST_Decode(functions[func]);
+
+	return fast_funcs[func];
+}
+
+
+void real_vm_c::FAST_Execute(int fnum)
+{
+	int runaway = MAX_RUNAWAY;
+
+	// make a stack frame
+	int exitdepth = exec.call_depth;
+
+	EnterFunction(fnum);
+
+	fast_func_c *ff = FAST_GetFunction(fnum);
+
+	const fast_op_c *code = &ff->code[0];
+	const fast_op_c *pc   = code + ff->start;
+
+	// operand addresses are base[sel] + offset
+	intptr_t base[2];
+
+	base[0] = 0;
+	base[1] = (intptr_t) &exec.stack[exec.stack_depth];
+
+#define OPND(x, sel)  ((double *) (base[sel] + (x)))
+#define A  OPND(pc->a, pc->sel_a)
+#define B  OPND(pc->b, pc->sel_b)
+#define C  OPND(pc->c, pc->sel_c)
+#define D  OPND(pc->d, pc->sel_d)
+
+	// errors need exec.s to be valid for the stack trace
+#define FAST_ERROR(...)  \
+	do { exec.s = pc->next_s; RunError(__VA_ARGS__); } while (0)
+
+#define TAKE_JUMP()  \
+	do {  \
+		if (pc->cost > 0 && (runaway -= pc->cost) <= 0)  \
+			FAST_ERROR("runaway loop error");  \
+		pc = code + pc->jump;  \
+	} while (0)
+
+#ifdef COAL_COMPUTED_GOTO
+	static const void * dispatch[NUM_FAST_OPS] =
+	{
+		&&L_OP_NULL, &&L_OP_CALL, &&L_OP_RET,
+		&&L_OP_PARM_F, &&L_OP_PARM_V,
+		&&L_OP_IF, &&L_OP_IFNOT, &&L_OP_GOTO, &&L_OP_ERROR,
+
+		&&L_OP_MOVE_F, &&L_OP_MOVE_V, &&L_OP_MOVE_S, &&L_OP_MOVE_FNC,
+
+		&&L_OP_NOT_F, &&L_OP_NOT_V, &&L_OP_NOT_S, &&L_OP_NOT_FNC,
+		&&L_OP_INC, &&L_OP_DEC,
+
+		&&L_OP_POWER_F, &&L_OP_MUL_F, &&L_OP_MUL_V, &&L_OP_MUL_FV, &&L_OP_MUL_VF,
+		&&L_OP_DIV_F, &&L_OP_DIV_V, &&L_OP_MOD_F,
+
+		&&L_OP_ADD_F, &&L_OP_ADD_V, &&L_OP_ADD_S, &&L_OP_ADD_SF, &&L_OP_ADD_SV,
+		&&L_OP_SUB_F, &&L_OP_SUB_V,
+
+		&&L_OP_EQ_F, &&L_OP_EQ_V, &&L_OP_EQ_S, &&L_OP_EQ_FNC,
+		&&L_OP_NE_F, &&L_OP_NE_V, &&L_OP_NE_S, &&L_OP_NE_FNC,
+		&&L_OP_LE, &&L_OP_GE, &&L_OP_LT, &&L_OP_GT,
+
+		&&L_OP_AND, &&L_OP_OR, &&L_OP_BITAND, &&L_OP_BITOR,
+
+		&&L_FOP_PARM_CALL,
+		&&L_FOP_ADD_MOVE, &&L_FOP_SUB_MOVE, &&L_FOP_MUL_MOVE,
+		&&L_FOP_LE_IFNOT, &&L_FOP_GE_IFNOT, &&L_FOP_LT_IFNOT,
+		&&L_FOP_GT_IFNOT, &&L_FOP_EQ_IFNOT, &&L_FOP_NE_IFNOT,
+	};
+
+#define CASE(x)  case x: L_##x:
+#define NEXT()   goto *dispatch[pc->op]
+#else
+#define CASE(x)  case x:
+#define NEXT()   continue
+#endif
+
+	for (;;)
+	{
+		switch (pc->op)
+		{
+			CASE(OP_NULL)
+				pc++;
+				NEXT();
+
+			CASE(FOP_PARM_CALL)
+				*B = *A;
+				[[fallthrough]];
+
+			CASE(OP_CALL)
+			{
+				double *fv = (pc->op == FOP_PARM_CALL) ? C : A;
+
+				int newf = (int)*fv;
+				if (newf <= 0)
+					FAST_ERROR("NULL function");
+
+				exec.s = pc->next_s;
+
+				/* negative statements are built in functions */
+				if (functions[newf]->first_statement < 0)
+				{
+					EnterNative(newf, pc->aux);
+
+					pc += (pc->op == FOP_PARM_CALL) ? 2 : 1;
+					NEXT();
+				}
+
+				EnterFunction(newf);
+
+				ff   = FAST_GetFunction(newf);
+				code = &ff->code[0];
+				pc   = code + ff->start;
+
+				base[1] = (intptr_t) &exec.stack[exec.stack_depth];
+				NEXT();
+			}
+
+			CASE(OP_RET)
+			{
+				LeaveFunction();
+
+				// all done?
+				if (exec.call_depth == exitdepth)
+					return;
+
+				ff   = FAST_GetFunction(exec.func);
+				code = &ff->code[0];
+				pc   = code + (exec.s - ff->first_s) / (int)sizeof(statement_t);
+
+				base[1] = (intptr_t) &exec.stack[exec.stack_depth];
+				NEXT();
+			}
+
+			CASE(OP_PARM_F)
+				*B = *A;
+				pc++;
+				NEXT();
+
+			CASE(OP_PARM_V)
+			{
+				double *a = A;
+				double *b = B;
+
+				b[0] = a[0];
+				b[1] = a[1];
+				b[2] = a[2];
+
+				pc++;
+				NEXT();
+			}
+
+			CASE(OP_IFNOT)
+				if (! *A)
+					TAKE_JUMP();
+				else
+					pc++;
+				NEXT();
+
+			CASE(OP_IF)
+				if (*A)
+					TAKE_JUMP();
+				else
+					pc++;
+				NEXT();
+
+			CASE(OP_GOTO)
+				TAKE_JUMP();
+				NEXT();
+
+			CASE(OP_ERROR)
+				FAST_ERROR("Assertion failed @ %s:%d\n",
+				           REF_STRING((int)pc->a), (int)pc->b);
+				NEXT(); /* NOT REACHED */
+
+			CASE(OP_MOVE_F)
+			CASE(OP_MOVE_FNC)	// pointers
+				*B = *A;
+				pc++;
+				NEXT();
+
+			CASE(OP_MOVE_S)
+			{
+				// only used when the destination is a global
+				double *a = A;
+
+				if (*a < 0)
+					*B = PromoteString((int)*a);
+				else
+					*B = *a;
+
+				pc++;
+				NEXT();
+			}
+
+			CASE(OP_MOVE_V)
+			{
+				double *a = A;
+				double *b = B;
+
+				b[0] = a[0];
+				b[1] = a[1];
+				b[2] = a[2];
+
+				pc++;
+				NEXT();
+			}
+
+			CASE(OP_NOT_F)
+			CASE(OP_NOT_FNC)
+			CASE(OP_NOT_S)
+				*C = ! *A;
+				pc++;
+				NEXT();
+
+			CASE(OP_NOT_V)
+			{
+				double *a = A;
+
+				*C = !a[0] && !a[1] && !a[2];
+				pc++;
+				NEXT();
+			}
+
+			CASE(OP_INC)
+				*C = *A + 1;
+				pc++;
+				NEXT();
+
+			CASE(OP_DEC)
+				*C = *A - 1;
+				pc++;
+				NEXT();
+
+			CASE(OP_ADD_F)
+				*C = *A + *B;
+				pc++;
+				NEXT();
+
+			CASE(OP_ADD_V)
+			{
+				double *a = A;
+				double *b = B;
+				double *c = C;
+
+				c[0] = a[0] + b[0];
+				c[1] = a[1] + b[1];
+				c[2] = a[2] + b[2];
+
+				pc++;
+				NEXT();
+			}
+
+			CASE(OP_ADD_S)
+			{
+				double *c = C;
+
+				*c = STR_Concat(REF_STRING((int)*A), REF_STRING((int)*B));
+
+				if (pc->aux)
+					*c = PromoteString((int)*c);
+
+				pc++;
+				NEXT();
+			}
+
+			CASE(OP_ADD_SF)
+			{
+				double *c = C;
+
+				*c = STR_ConcatFloat(REF_STRING((int)*A), *B);
+
+				if (pc->aux)
+					*c = PromoteString((int)*c);
+
+				pc++;
+				NEXT();
+			}
+
+			CASE(OP_ADD_SV)
+			{
+				double *c = C;
+
+				*c = STR_ConcatVector(REF_STRING((int)*A), B);
+
+				if (pc->aux)
+					*c = PromoteString((int)*c);
+
+				pc++;
+				NEXT();
+			}
+
+			CASE(OP_SUB_F)
+				*C = *A - *B;
+				pc++;
+				NEXT();
+
+			CASE(OP_SUB_V)
+			{
+				double *a = A;
+				double *b = B;
+				double *c = C;
+
+				c[0] = a[0] - b[0];
+				c[1] = a[1] - b[1];
+				c[2] = a[2] - b[2];
+
+				pc++;
+				NEXT();
+			}
+
+			CASE(OP_MUL_F)
+				*C = *A * *B;
+				pc++;
+				NEXT();
+
+			CASE(OP_MUL_V)
+			{
+				double *a = A;
+				double *b = B;
+
+				*C = a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+				pc++;
+				NEXT();
+			}
+
+			CASE(OP_MUL_FV)
+			{
+				double *a = A;
+				double *b = B;
+				double *c = C;
+
+				c[0] = a[0] * b[0];
+				c[1] = a[0] * b[1];
+				c[2] = a[0] * b[2];
+
+				pc++;
+				NEXT();
+			}
+
+			CASE(OP_MUL_VF)
+			{
+				double *a = A;
+				double *b = B;
+				double *c = C;
+
+				c[0] = b[0] * a[0];
+				c[1] = b[0] * a[1];
+				c[2] = b[0] * a[2];
+
+				pc++;
+				NEXT();
+			}
+
+			CASE(OP_DIV_F)
+			{
+				double *b = B;
+
+				if (*b == 0)
+					FAST_ERROR("Division by zero");
+
+				*C = *A / *b;
+				pc++;
+				NEXT();
+			}
+
+			CASE(OP_DIV_V)
+			{
+				double *a = A;
+				double *b = B;
+				double *c = C;
+
+				if (*b == 0)
+					FAST_ERROR("Division by zero");
+
+				c[0] = a[0] / *b;
+				c[1] = a[1] / *b;
+				c[2] = a[2] / *b;
+
+				pc++;
+				NEXT();
+			}
+
+			CASE(OP_MOD_F)
+			{
+				double *a = A;
+				double *b = B;
+
+				if (*b == 0)
+					FAST_ERROR("Division by zero");
+
+				float d = floorf(*a / *b);
+				*C = *a - d * (*b);
+
+				pc++;
+				NEXT();
+			}
+
+			CASE(OP_POWER_F)
+				*C = powf(*A, *B);
+				pc++;
+				NEXT();
+
+			CASE(OP_GE)
+				*C = *A >= *B;
+				pc++;
+				NEXT();
+
+			CASE(OP_LE)
+				*C = *A <= *B;
+				pc++;
+				NEXT();
+
+			CASE(OP_GT)
+				*C = *A > *B;
+				pc++;
+				NEXT();
+
+			CASE(OP_LT)
+				*C = *A < *B;
+				pc++;
+				NEXT();
+
+			CASE(OP_EQ_F)
+			CASE(OP_EQ_FNC)
+				*C = *A == *B;
+				pc++;
+				NEXT();
+
+			CASE(OP_EQ_V)
+			{
+				double *a = A;
+				double *b = B;
+
+				*C = (a[0] == b[0]) && (a[1] == b[1]) && (a[2] == b[2]);
+				pc++;
+				NEXT();
+			}
+
+			CASE(OP_EQ_S)
+			{
+				double *a = A;
+				double *b = B;
+
+				*C = (*a == *b) ? 1 :
+					!strcmp(REF_STRING((int)*a), REF_STRING((int)*b));
+				pc++;
+				NEXT();
+			}
+
+			CASE(OP_NE_F)
+			CASE(OP_NE_FNC)
+				*C = *A != *B;
+				pc++;
+				NEXT();
+
+			CASE(OP_NE_V)
+			{
+				double *a = A;
+				double *b = B;
+
+				*C = (a[0] != b[0]) || (a[1] != b[1]) || (a[2] != b[2]);
+				pc++;
+				NEXT();
+			}
+
+			CASE(OP_NE_S)
+			{
+				double *a = A;
+				double *b = B;
+
+				*C = (*a == *b) ? 0 :
+					!! strcmp(REF_STRING((int)*a), REF_STRING((int)*b));
+				pc++;
+				NEXT();
+			}
+
+			CASE(OP_AND)
+				*C = *A && *B;
+				pc++;
+				NEXT();
+
+			CASE(OP_OR)
+				*C = *A || *B;
+				pc++;
+				NEXT();
+
+			CASE(OP_BITAND)
+				*C = (int)*A & (int)*B;
+				pc++;
+				NEXT();
+
+			CASE(OP_BITOR)
+				*C = (int)*A | (int)*B;
+				pc++;
+				NEXT();
+
+			/* ---- superinstructions ---- */
+
+			CASE(FOP_ADD_MOVE)
+				*D = *C = *A + *B;
+				pc += 2;
+				NEXT();
+
+			CASE(FOP_SUB_MOVE)
+				*D = *C = *A - *B;
+				pc += 2;
+				NEXT();
+
+			CASE(FOP_MUL_MOVE)
+				*D = *C = *A * *B;
+				pc += 2;
+				NEXT();
+
+#define COMPARE_IFNOT(cond)  \
+			{  \
+				double r = (cond);  \
+				*C = r;  \
+				if (! r)  \
+					TAKE_JUMP();  \
+				else  \
+					pc += 2;  \
+				NEXT();  \
+			}
+
+			CASE(FOP_LE_IFNOT)  COMPARE_IFNOT(*A <= *B)
+			CASE(FOP_GE_IFNOT)  COMPARE_IFNOT(*A >= *B)
+			CASE(FOP_LT_IFNOT)  COMPARE_IFNOT(*A <  *B)
+			CASE(FOP_GT_IFNOT)  COMPARE_IFNOT(*A >  *B)
+			CASE(FOP_EQ_IFNOT)  COMPARE_IFNOT(*A == *B)
+			CASE(FOP_NE_IFNOT)  COMPARE_IFNOT(*A != *B)
+
+#undef COMPARE_IFNOT
+
+			default:
+				FAST_ERROR("Bad opcode %i", pc->op);
+		}
+	}
+
+#undef OPND
+#undef A
+#undef B
+#undef C
+#undef D
+#undef FAST_ERROR
+#undef TAKE_JUMP
+#undef CASE
+#undef NEXT
+}
+
+
+}  // namespace coal
+
+//--- editor settings ---
+// vi:ts=4:sw=4:noexpandtab
@@ -0,0 +1,297 @@
+//----------------------------------------------------------------------
+//  COAL PROGRAM IMAGES
+//----------------------------------------------------------------------
+//
+//  Copyright (C)      2023  The EDGE Team
+//
+//  Coal is free software; you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as
+//  published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  Coal is distributed in the hope that it will be useful, but
+//  WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+//  the GNU General Public License for more details.
+//
+//----------------------------------------------------------------------
+//
+//  An image is a snapshot of a compiled program: the function table,
+//  the statements, the globals and the string heap.  Loading one is
+//  much quicker than compiling the source again.
+//
+//  Images are only meant for caching on the same machine, hence
+//  values are stored in the native byte order, and the header
+//  records the sizes of the important types.
+//
+//----------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <stdint.h>
+#include <assert.h>
+
+#include "coal.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+
+namespace coal
+{
+
+#include "c_local.h"
+#include "c_execute.h"
+
+
+#define IMAGE_MAGIC    "CoalImg1"
+#define IMAGE_VERSION  1
+
+
+static void WriteInt(FILE *fp, int value)
+{
+	fwrite(&value, sizeof(int), 1, fp);
+}
+
+static void WriteStr(FILE *fp, const char *str)
+{
+	int len = str ? (int)strlen(str) : 0;
+
+	WriteInt(fp, len);
+	fwrite(str ? str : "", 1, len, fp);
+}
+
+static bool ReadInt(FILE *fp, int *value)
+{
+	return fread(value, sizeof(int), 1, fp) == 1;
+}
+
+static char * ReadStr(FILE *fp)
+{
+	int len;
+
+	if (! ReadInt(fp, &len) || len < 0 || len > 4096)
+		return NULL;
+
+	char *str = (char *) malloc(len + 1);
+
+	if (fread(str, 1, len, fp) != (size_t)len)
+	{
+		free(str);
+		return NULL;
+	}
+
+	str[len] = 0;
+
+	return str;
+}
+
+
+bool real_vm_c::SaveImage(const char *filename)
+{
+	FILE *fp = fopen(filename, "wb");
+
+	if (! fp)
+		return false;
+
+	fwrite(IMAGE_MAGIC, 1, 8, fp);
+
+	WriteInt(fp, IMAGE_VERSION);
+	WriteInt(fp, (int)sizeof(statement_t));
+	WriteInt(fp, (int)sizeof(double));
+	WriteInt(fp, MAX_PARMS);
+
+	// function #0 is the null function, always present
+	WriteInt(fp, (int)functions.size() - 1);
+
+	for (int i = 1; i < (int)functions.size(); i++)
+	{
+		function_t *f = functions[i];
+
+		WriteStr(fp, f->name);
+		WriteStr(fp, f->source_file);
+
+		WriteInt(fp, f->source_line);
+		WriteInt(fp, f->return_size);
+		WriteInt(fp, f->parm_num);
+
+		for (int p = 0; p < MAX_PARMS; p++)
+		{
+			WriteInt(fp, f->parm_ofs[p]);
+			WriteInt(fp, f->parm_size[p]);
+		}
+
+		WriteInt(fp, f->locals_ofs);
+		WriteInt(fp, f->locals_size);
+		WriteInt(fp, f->locals_end);
+		WriteInt(fp, f->last_statement);
+
+		// native functions are stored by name, since the numbering
+		// depends on the order they were registered.
+		if (f->first_statement < 0)
+		{
+			WriteInt(fp, -1);
+			WriteStr(fp, native_funcs[-(f->first_statement + 1)]->name);
+		}
+		else
+			WriteInt(fp, f->first_statement);
+	}
+
+	op_mem.write(fp);
+	global_mem.write(fp);
+	string_mem.write(fp);
+
+	fwrite(IMAGE_MAGIC, 1, 8, fp);
+
+	bool ok = (ferror(fp) == 0);
+
+	if (fclose(fp) != 0)
+		ok = false;
+
+	return ok;
+}
+
+
+bool real_vm_c::LoadImage(const char *filename)
+{
+	// only possible with a fresh VM
+	if (functions.size() != 1)
+		return false;
+
+	FILE *fp = fopen(filename, "rb");
+
+	if (! fp)
+		return false;
+
+	std::vector< function_t* > new_funcs;
+
+	bmaster_c new_ops;
+	bmaster_c new_globals;
+	bmaster_c new_strings;
+
+	bool ok = false;
+
+	char magic[8];
+	int version, st_size, d_size, max_parms, total;
+
+	if (fread(magic, 1, 8, fp) != 8 || memcmp(magic, IMAGE_MAGIC, 8) != 0)
+		goto done;
+
+	if (! (ReadInt(fp, &version)   && version   == IMAGE_VERSION &&
+	       ReadInt(fp, &st_size)   && st_size   == (int)sizeof(statement_t) &&
+	       ReadInt(fp, &d_size)    && d_size    == (int)sizeof(double) &&
+	       ReadInt(fp, &max_parms) && max_parms == MAX_PARMS &&
+	       ReadInt(fp, &total)     && total >= 0))
+		goto done;
+
+	for (int i = 0; i < total; i++)
+	{
+		function_t *f = new function_t;
+		memset(f, 0, sizeof(function_t));
+
+		new_funcs.push_back(f);
+
+		f->name        = ReadStr(fp);
+		f->source_file = ReadStr(fp);
+
+		if (! f->name || ! f->source_file)
+			goto done;
+
+		int value;
+
+		if (! ReadInt(fp, &f->source_line) ||
+			! ReadInt(fp, &f->return_size) ||
+			! ReadInt(fp, &f->parm_num))
+			goto done;
+
+		for (int p = 0; p < MAX_PARMS; p++)
+		{
+			if (! ReadInt(fp, &value)) goto done;
+			f->parm_ofs[p] = value;
+
+			if (! ReadInt(fp, &value)) goto done;
+			f->parm_size[p] = value;
+		}
+
+		if (! ReadInt(fp, &f->locals_ofs) ||
+			! ReadInt(fp, &f->locals_size) ||
+			! ReadInt(fp, &f->locals_end) ||
+			! ReadInt(fp, &f->last_statement) ||
+			! ReadInt(fp, &f->first_statement))
+			goto done;
+
+		if (f->first_statement < 0)
+		{
+			char *native_name = ReadStr(fp);
+
+			if (! native_name)
+				goto done;
+
+			int native = GetNativeFunc(native_name, NULL);
+
+			if (native < 0)
+			{
+				printer("image %s needs unknown native function: %s\n",
+						filename, native_name);
+				free(native_name);
+				goto done;
+			}
+
+			free(native_name);
+
+			f->first_statement = -(native + 1);
+		}
+	}
+
+	if (! new_ops.read(fp) || ! new_globals.read(fp) || ! new_strings.read(fp))
+		goto done;
+
+	if (fread(magic, 1, 8, fp) != 8 || memcmp(magic, IMAGE_MAGIC, 8) != 0)
+		goto done;
+
+	ok = true;
+
+done:
+	fclose(fp);
+
+	if (! ok)
+	{
+		for (int i = 0; i < (int)new_funcs.size(); i++)
+		{
+			free((void *) new_funcs[i]->name);
+			free((void *) new_funcs[i]->source_file);
+			delete new_funcs[i];
+		}
+
+		return false;
+	}
+
+	// everything was valid, so install the new program
+
+	op_mem.swap(new_ops);
+	global_mem.swap(new_globals);
+	string_mem.swap(new_strings);
+
+	for (int i = 0; i < total; i++)
+	{
+		function_names[new_funcs[i]->name] = (int)functions.size();
+
+		functions.push_back(new_funcs[i]);
+	}
+
+	FAST_Flush();
+	promoted_strings.clear();
+	promoted_free.clear();
+	promoted_bytes = 0;
+
+	return true;
+}
+
+
+}  // namespace coal
+
+//--- editor settings ---
+// vi:ts=4:sw=4:noexpandtab
@@ -237,8 +237,12 @@ public:
 	bool CompileFile(char *buffer, const char *filename);
 	void ShowStats();
 
+	bool SaveImage(const char *filename);
+	bool LoadImage(const char *filename);
+
 	void SetAsmDump(bool enable);
 	void SetTrace  (bool enable);
+	void SetFastExec(bool enable);
 
 	int FindFunction(const char *name);
 	int FindVariable(const char *name);
@@ -263,9 +267,24 @@ private:
 	std::vector< function_t* > functions;
 	std::vector< reg_native_func_t* > native_funcs;
 
+	// name lookup tables.  A redefined function replaces the entry
+	// for the older one.  Native names include the module prefix.
+	std::unordered_map< std::string, int > function_names;
+	std::unordered_map< std::string, int > native_names;
+
 	compiling_c comp;
 	execution_c exec;
 
+	bool fast_exec;
+	std::vector< fast_func_c* > fast_funcs;
+
+	// temp strings which were stored into globals (see PromoteString),
+	// the space of collected ones (by size), and the number of bytes
+	// promoted since the last collection.
+	std::unordered_map< std::string, int > promoted_strings;
+	std::unordered_map< int, std::vector<int> > promoted_free;
+	int promoted_bytes;
+
 	// c_compile.cc
 private:
 	void GLOB_Globals();
@@ -339,6 +358,9 @@ private:
 
 	int GetNativeFunc(const char *name, const char *module);
 	int	InternaliseString(const char *new_s);
+	int PromoteString(int temp);
+	void CollectPromotedStrings();
+	int NewTempString(int len, char **buf);
 
 	int STR_Concat(const char * s1, const char * s2);
 	int STR_ConcatFloat (const char * s, double f);
@@ -353,6 +375,16 @@ private:
 	void ASM_DumpFunction(function_t *f);
 	void ASM_DumpAll();
 
+	// c_fastexec.cc
+private:
+	void FAST_Execute(int func_id);
+	void FAST_Flush();
+
+	fast_func_c * FAST_GetFunction(int func);
+	fast_func_c * FAST_Decode(function_t *f);
+	void FAST_Operand(int raw, intptr_t *ofs, byte *sel);
+	void FAST_Fuse(fast_func_c *ff);
+
 	static void default_printer(const char *msg, ...);
 	static void default_aborter(const char *msg, ...);
 };
@@ -19,9 +19,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
 #include <stdarg.h>
 #include <assert.h>
 
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "coal.h"
@@ -222,6 +225,164 @@ int bmaster_c::totalMemory() const
 }
 
 
+void bmaster_c::scanDoubles(void (* func)(double value, void *data), void *data) const
+{
+	for (int k = 0; k < 256; k++)
+	{
+		bgroup_c *grp = groups[k];
+
+		if (! grp)
+			continue;
+
+		for (int i = 0; i < 256; i++)
+		{
+			block_c *blk = grp->blocks[i];
+
+			if (! blk)
+				continue;
+
+			// big items are contiguous from the first block's data
+			for (int ofs = 0; ofs + (int)sizeof(double) <= blk->used; ofs += sizeof(double))
+			{
+				double value;
+				memcpy(&value, blk->data + ofs, sizeof(double));
+
+				func(value, data);
+			}
+		}
+	}
+}
+
+
+void bmaster_c::clear()
+{
+	for (int k = 0; k < 256; k++)
+		if (groups[k])
+		{
+			delete groups[k];
+			groups[k] = NULL;
+		}
+
+	pos = 0;
+}
+
+void bmaster_c::swap(bmaster_c& other)
+{
+	for (int k = 0; k < 256; k++)
+	{
+		bgroup_c *tmp = groups[k];
+		groups[k] = other.groups[k];
+		other.groups[k] = tmp;
+	}
+
+	int tmp_pos = pos;
+	pos = other.pos;
+	other.pos = tmp_pos;
+}
+
+//
+// Format: the master 'pos' value, then for each group: its number and
+// 'pos' value, followed by each non-empty block as (number, used,
+// data), ending with -1.  The list of groups also ends with -1.
+//
+void bmaster_c::write(FILE *fp) const
+{
+	fwrite(&pos, sizeof(int), 1, fp);
+
+	for (int k = 0; k < 256; k++)
+	{
+		const bgroup_c *grp = groups[k];
+
+		if (! grp)
+			continue;
+
+		fwrite(&k, sizeof(int), 1, fp);
+		fwrite(&grp->pos, sizeof(int), 1, fp);
+
+		for (int i = 0; i < 256; i++)
+		{
+			const block_c *blk = grp->blocks[i];
+
+			if (! blk || blk->used == 0)
+				continue;
+
+			fwrite(&i, sizeof(int), 1, fp);
+			fwrite(&blk->used, sizeof(int), 1, fp);
+
+			// "big" blocks continue into the following block_c
+			// structures, see bgroup_c::try_alloc().
+			fwrite(blk->data, 1, blk->used, fp);
+		}
+
+		int end = -1;
+		fwrite(&end, sizeof(int), 1, fp);
+	}
+
+	int end = -1;
+	fwrite(&end, sizeof(int), 1, fp);
+}
+
+bool bmaster_c::read(FILE *fp)
+{
+	clear();
+
+	if (fread(&pos, sizeof(int), 1, fp) != 1 || pos < 0 || pos >= 256)
+		return false;
+
+	for (;;)
+	{
+		int k;
+
+		if (fread(&k, sizeof(int), 1, fp) != 1)
+			return false;
+
+		if (k < 0)
+			break;
+
+		if (k >= 256 || groups[k])
+			return false;
+
+		bgroup_c *grp = new bgroup_c;
+		groups[k] = grp;
+
+		if (fread(&grp->pos, sizeof(int), 1, fp) != 1 || grp->pos < 0 || grp->pos > 256)
+			return false;
+
+		for (;;)
+		{
+			int i, used;
+
+			if (fread(&i, sizeof(int), 1, fp) != 1)
+				return false;
+
+			if (i < 0)
+				break;
+
+			if (i >= 256 || grp->blocks[i])
+				return false;
+
+			if (fread(&used, sizeof(int), 1, fp) != 1 || used <= 0 || used > (1 << 20))
+				return false;
+
+			int big_num = 1;
+			if (used > 4096)
+				big_num = 1 + (used >> 12);
+
+			grp->blocks[i] = new block_c[big_num];
+
+			if (fread(grp->blocks[i]->data, 1, used, fp) != (size_t)used)
+				return false;
+
+			// set afterwards, since a big block's data overlaps
+			// the following block_c structures.
+			grp->blocks[i]->used = used;
+		}
+	}
+
+	return true;
+}
+
+
 }  // namespace coal
 
 //--- editor settings ---
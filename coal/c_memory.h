@@ -80,6 +80,22 @@ public:
 	// includes all the extra/free/wasted space.
 	int usedMemory() const;
 	int totalMemory() const;
+
+	// calls func() for every double stored in the used part of each
+	// block.  Only sensible for memory which holds nothing but doubles
+	// (like the globals).
+	void scanDoubles(void (* func)(double value, void *data), void *data) const;
+
+	// save / restore the exact layout (so that existing indices
+	// remain valid).  read() replaces the current contents, and
+	// returns false if the file is truncated or invalid.
+	void write(FILE *fp) const;
+	bool read(FILE *fp);
+
+	void swap(bmaster_c& other);
+
+private:
+	void clear();
 };
 
 #endif /* __COAL_MEMORY_STUFF_H__ */
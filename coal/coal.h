@@ -53,11 +53,25 @@ public:
 	virtual bool CompileFile(char *buffer, const char *filename) = 0;
 	virtual void ShowStats() = 0;
 
+	// save the compiled program, or load a previously saved one
+	// instead of compiling.  Loading requires a fresh VM with all
+	// the native functions already added, and no more files can be
+	// compiled afterwards.  Both return false on failure.
+	virtual bool SaveImage(const char *filename) = 0;
+	virtual bool LoadImage(const char *filename) = 0;
+
 	virtual void SetAsmDump(bool enable) = 0;
 	virtual void SetTrace  (bool enable) = 0;
 
+	// use the fast (pre-decoded) execution engine.  On by default.
+	// Tracing always uses the original engine.
+	virtual void SetFastExec(bool enable) = 0;
+
 	enum { NOT_FOUND = 0 };
 
+	// the result is a handle which remains valid (and can be passed
+	// to Execute() any number of times) until the function is
+	// redefined by a later CompileFile().
 	virtual int FindFunction(const char *name) = 0;
 	virtual int FindVariable(const char *name) = 0;
 
@@ -472,6 +472,7 @@ static void DDF_AtkGetLabel(const char *info, void *storage)
 		DDF_Error("Bad State `%s'.\n", info);
 
 	lab->label.Set(info, i);
+	lab->label_id = DDF_StateLabelID(lab->label.c_str(), true);
 	lab->offset = div ? MAX(0, atoi(div + 1) - 1) : 0;
 }
 
@@ -573,7 +574,8 @@ void atkdef_c::Default()
 //
 // atkdef_container_c::atkdef_container_c()
 //
-atkdef_container_c::atkdef_container_c() : epi::array_c(sizeof(atkdef_c*))
+atkdef_container_c::atkdef_container_c() : epi::array_c(sizeof(atkdef_c*)),
+	name_index()
 {
 }
 
@@ -605,20 +607,10 @@ void atkdef_container_c::CleanupObject(void *obj)
 //
 atkdef_c* atkdef_container_c::Lookup(const char *refname)
 {
-	epi::array_iterator_c it;
-	atkdef_c *a;
-
 	if (!refname || !refname[0])
 		return NULL;
 
-	for (it = GetIterator(0); it.IsValid(); it++) //TODO: V803 https://www.viva64.com/en/w/v803/ Decreased performance. In case 'it' is iterator it's more effective to use prefix form of increment. Replace iterator++ with ++iterator.
-	{
-		a = ITERATOR_TO_TYPE(it, atkdef_c*);
-		if (DDF_CompareName(a->name.c_str(), refname) == 0)
-			return a;
-	}
-
-	return NULL;
+	return (atkdef_c *) name_index.Find(refname);
 }
 
 //--- editor settings ---
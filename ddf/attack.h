@@ -146,10 +146,19 @@ public:
 private:
 	void CleanupObject(void *obj);
 
+	// latest definition for each name
+	ddf_name_index_c name_index;
+
 public:
 	// List Management
 	int GetSize() {	return array_entries; } 
-	int Insert(atkdef_c *a) { return InsertObject((void*)&a); }
+	int Insert(atkdef_c *a)
+	{
+		name_index.Add(a->name.c_str(), a);
+		return InsertObject((void*)&a);
+	}
+
+	void Clear() { name_index.Clear(); epi::array_c::Clear(); }
 	atkdef_c* operator[](int idx) { return *(atkdef_c**)FetchObject(idx); } 
 
 	// Search Functions
@@ -232,11 +232,27 @@ state_starter_t;
 
 // DDF_MAIN Code (Reading all files, main init & generic functions).
 bool DDF_MainReadFile (readinfo_t * readinfo);
+void DDF_MainInitLexClasses(void);
+void DDF_MainResetLexer(void);
 
-extern int cur_ddf_line_num;
-extern std::string cur_ddf_filename;
-extern std::string cur_ddf_entryname;
-extern std::string cur_ddf_linedata;
+// DDF_SNAPSHOT Code
+bool DDF_SnapshotReplay(readinfo_t *readinfo, const char *data, int size);
+void DDF_SnapshotRecorded(readinfo_t *readinfo);
+void DDF_SnapshotStageTag(const char *tag);
+
+// thrown by DDF_Error and DDF_Warning while staging a file
+class ddf_stage_failure_c
+{
+public:
+	ddf_stage_failure_c() { }
+};
+
+extern thread_local int cur_ddf_line_num;
+extern thread_local std::string cur_ddf_filename;
+extern thread_local std::string cur_ddf_entryname;
+extern thread_local std::string cur_ddf_linedata;
+
+extern thread_local bool ddf_staging;
 
 void DDF_Error    (const char *err, ...) GCCATTR((format (printf,1,2)));
 void DDF_Warning  (const char *err, ...) GCCATTR((format (printf,1,2)));
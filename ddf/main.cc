@@ -47,19 +47,72 @@ bool no_warnings = false;
 //
 // -AJA- 1999/10/27: written.
 //
-int cur_ddf_line_num;
-std::string cur_ddf_filename;
-std::string cur_ddf_entryname;
-std::string cur_ddf_linedata;
+// The parse state is per thread, since files may be staged on
+// worker threads (see DDF_StageFile).
+thread_local int cur_ddf_line_num;
+thread_local std::string cur_ddf_filename;
+thread_local std::string cur_ddf_entryname;
+thread_local std::string cur_ddf_linedata;
+
+// true while a worker thread is staging a file
+thread_local bool ddf_staging = false;
+
+// the line contents are only copied into cur_ddf_linedata when an
+// error or warning needs them.
+static thread_local const char *cur_line_ptr = NULL;
+static thread_local const char *cur_line_end = NULL;
+
+// total amount of DDF text lexed, and replayed from snapshots or
+// staging instead
+static int ddf_parsed_bytes   = 0;
+static int ddf_replayed_bytes = 0;
+
+static void DDF_FetchLineData(void)
+{
+	if (!cur_line_ptr)
+		return;
+
+	const char *p = cur_line_ptr;
+
+	while (p < cur_line_end && *p && *p != '\n' && *p != '\r')
+		p++;
+
+	cur_ddf_linedata.assign(cur_line_ptr, p - cur_line_ptr);
+
+	cur_line_ptr = NULL;
+}
+
+static void DDF_ClearLineData(void)
+{
+	cur_line_ptr = NULL;
+	cur_ddf_linedata.clear();
+}
+
+int DDF_MainParsedBytes(void)
+{
+	return ddf_parsed_bytes;
+}
+
+int DDF_MainReplayedBytes(void)
+{
+	return ddf_replayed_bytes;
+}
 
 void DDF_Error(const char *err, ...)
 {
+	// a staged file is parsed again later, to report it properly.
+	// This must come first, since worker threads may get here.
+	if (ddf_staging)
+		throw ddf_stage_failure_c();
+
 	va_list argptr;
 	char buffer[2048];
 	char *pos;
 
 	buffer[2047] = 0;
 
+	DDF_FetchLineData();
+
 	// put actual error message on first line
 	va_start(argptr, err);
 	vsprintf(buffer, err, argptr);
@@ -103,12 +156,17 @@ void DDF_Error(const char *err, ...)
 
 void DDF_Warning(const char *err, ...)
 {
+	if (ddf_staging)
+		throw ddf_stage_failure_c();
+
 	va_list argptr;
 	char buffer[1024];
 
 	if (no_warnings)
 		return;
 
+	DDF_FetchLineData();
+
 	va_start(argptr, err);
 	vsprintf(buffer, err, argptr);
 	va_end(argptr);
@@ -155,6 +213,8 @@ void DDF_Init(int _engine_ver)
 {
 	engine_version = _engine_ver;
 
+	DDF_MainInitLexClasses();
+
 	DDF_StateInit();
 	DDF_LanguageInit();
 	DDF_SFXInit();
@@ -202,7 +262,7 @@ public:
 // -AJA- 1999/09/12: Made these static.  The variable `defines' was
 //       clashing with the one in rad_trig.c.  Ugh.
 
-static std::vector<define_c> defines;
+static thread_local std::vector<define_c> defines;
 
 static void DDF_MainAddDefine(char *name, char *value)
 {
@@ -452,6 +512,8 @@ static void DDF_ParseVersion(const char *bstr, int len)
 // The parser will read an ascii file, character by character an interpret each
 // depending in which mode it is in; Unless an error is encountered or a called
 // procedure stops the parser, it will read everything until EOF is encountered.
+// (Runs of characters that need no special handling, like whitespace or the
+// letters of a name, are taken in one go by DDF_MainLexRun).
 //
 // When the parser function is called, a pointer to a readinfo_t is passed and
 // contains all the info needed, it contains:
@@ -527,6 +589,9 @@ static void DDF_ParseVersion(const char *bstr, int len)
 // from the file.
 //
 
+// -ACB- 1998/08/11 Used for detecting formatting in a string
+static thread_local bool formatchar = false;
+
 //
 // DDF_MainProcessChar
 //
@@ -536,9 +601,6 @@ static readchar_t DDF_MainProcessChar(char character, std::string& token, int st
 {
 	//int len;
 
-	// -ACB- 1998/08/11 Used for detecting formatting in a string
-	static bool formatchar = false;
-
 	// With the exception of reading_string, whitespace is ignored.
 	if (status != reading_string)
 	{
@@ -725,6 +787,136 @@ static readchar_t DDF_MainProcessChar(char character, std::string& token, int st
 	return nothing;
 }
 
+//
+// DDF_MainResetLexer
+//
+// Forget the state of a file which was abandoned part way (a staged
+// file with an error, see DDF_StageFile).
+//
+void DDF_MainResetLexer(void)
+{
+	formatchar = false;
+	defines.clear();
+
+	DDF_ClearLineData();
+}
+
+//
+// Character classes for DDF_MainLexRun.  Each one is a set of
+// characters which DDF_MainProcessChar would handle the same way
+// (skip them, or add them to the token) in a certain state.
+// Characters which are special anywhere in the main loop ('\n', '#'
+// and '/') are never part of a run.
+//
+#define LEX_SPACE    (1 << 0)   // whitespace, ignored outside strings
+#define LEX_NEWDEF   (1 << 1)   // part of an entry name
+#define LEX_COMMAND  (1 << 2)   // part of a command name
+#define LEX_DATA     (1 << 3)   // part of a command's value
+#define LEX_STRING   (1 << 4)   // part of a quoted string
+#define LEX_REMARK   (1 << 5)   // ignored inside { } comments
+#define LEX_WAITING  (1 << 6)   // ignored while looking for an entry
+
+static byte lex_classes[256];
+
+void DDF_MainInitLexClasses(void)
+{
+	for (int c = 1; c < 256; c++)
+	{
+		byte cls = 0;
+
+		bool alnum = (c < 128) && isalnum(c);
+
+		if (c < 128 && isspace(c) && c != '\n')
+			cls |= LEX_SPACE;
+
+		if (alnum || strchr("_:+", c))
+			cls |= LEX_NEWDEF;
+
+		if (alnum || strchr("_().", c))
+			cls |= LEX_COMMAND;
+
+		if (alnum || strchr("_-:.[]\\!%+@?", c))
+			cls |= LEX_DATA;
+
+		if (! strchr("\\\"\n#", c))
+			cls |= LEX_STRING;
+
+		if (! strchr("{}\n#", c))
+			cls |= LEX_REMARK;
+
+		if (! strchr("[{}\n#/", c))
+			cls |= LEX_WAITING;
+
+		lex_classes[c] = cls;
+	}
+}
+
+//
+// DDF_MainLexRun
+//
+// Handles a run of characters which DDF_MainProcessChar would
+// merely skip or add to the token, in one go, working directly
+// on the file in memory.  Returns the position after the run, or
+// NULL when the next character needs the normal treatment.
+//
+static char *DDF_MainLexRun(char *pos, const char *end, int status,
+							std::string& token)
+{
+	int  cls;
+	bool upper = true;
+	bool keep  = true;
+
+	switch (status)
+	{
+		case reading_newdef:  cls = LEX_NEWDEF;  break;
+		case reading_command: cls = LEX_COMMAND; break;
+		case reading_data:    cls = LEX_DATA;    break;
+
+		case reading_string:
+			// escapes are handled by DDF_MainProcessChar
+			if (formatchar)
+				return NULL;
+
+			cls = LEX_STRING;
+			upper = false;
+			break;
+
+		case reading_remark:  cls = LEX_REMARK;  keep = false; break;
+		case waiting_newdef:  cls = LEX_WAITING; keep = false; break;
+
+		default:
+			return NULL;
+	}
+
+	char *start = pos;
+
+	if (status != reading_string)
+	{
+		while (pos < end && (lex_classes[(byte)*pos] & LEX_SPACE))
+			pos++;
+	}
+
+	char *run = pos;
+
+	while (pos < end && (lex_classes[(byte)*pos] & cls))
+		pos++;
+
+	if (keep && pos > run)
+	{
+		size_t old_len = token.size();
+
+		token.append(run, pos - run);
+
+		if (upper)
+		{
+			for (size_t i = old_len; i < token.size(); i++)
+				token[i] = toupper(token[i]);
+		}
+	}
+
+	return (pos > start) ? pos : NULL;
+}
+
 //
 // DDF_MainReadFile
 //
@@ -786,6 +978,22 @@ bool DDF_MainReadFile(readinfo_t * readinfo)
 	memfileptr = memfile = readinfo->memfile;
 	size = readinfo->memsize;
 
+	// unchanged since the last run?
+	if (DDF_SnapshotReplay(readinfo, memfile, size))
+	{
+		ddf_replayed_bytes += size;
+
+		cur_ddf_filename.clear();
+
+		if (readinfo->filename)
+			delete[] memfile;
+
+		return true;
+	}
+
+	if (! ddf_staging)
+		ddf_parsed_bytes += size;
+
 	// -ACB- 1998/09/12 Copy file to memory: Read until end. Speed optimisation.
 	while (memfileptr < &memfile[size])
 	{
@@ -847,25 +1055,42 @@ bool DDF_MainReadFile(readinfo_t * readinfo)
 				break;
 		}
 
+		// most characters are whitespace or parts of names and values,
+		// these are consumed a whole run at a time.
+		{
+			char *next = DDF_MainLexRun(memfileptr, &memfile[size], status, token);
+
+			if (next)
+			{
+				memfileptr = next;
+				continue;
+			}
+		}
+
 		character = *memfileptr++;
 
+		// -AJA- 2001/05/21: handle directives (lines beginning with #).
+		// This code is more hackitude -- to be fixed when the whole
+		// parsing code gets the overhaul it needs.
+
 		if (character == '\n')
 		{
-			int l_len;
-
 			cur_ddf_line_num++;
 
-			// -AJA- 2000/03/21: determine linedata.  Ouch.
-			for (l_len=0; &memfileptr[l_len] < &memfile[size] &&
-					 memfileptr[l_len] != '\n' && memfileptr[l_len] != '\r'; l_len++)
-			{ }
+			// -AJA- 2000/03/21: determine linedata (only copied when needed).
+			cur_ddf_linedata.clear();
 
+			cur_line_ptr = memfileptr;
+			cur_line_end = &memfile[size];
+		}
 
-			cur_ddf_linedata = std::string(memfileptr, l_len);
+		if (character == '\n' && memfileptr < &memfile[size] && *memfileptr == '#')
+		{
+			int l_len;
 
-			// -AJA- 2001/05/21: handle directives (lines beginning with #).
-			// This code is more hackitude -- to be fixed when the whole
-			// parsing code gets the overhaul it needs.
+			for (l_len=0; &memfileptr[l_len] < &memfile[size] &&
+					 memfileptr[l_len] != '\n' && memfileptr[l_len] != '\r'; l_len++)
+			{ }
 
 			if (strnicmp(memfileptr, "#CLEARALL", 9) == 0)
 			{
@@ -928,7 +1153,10 @@ bool DDF_MainReadFile(readinfo_t * readinfo)
 			break;
 
 		case tag_stop:
-			if (stricmp(token.c_str(), readinfo->tag) != 0)
+			// staged files can have any tag
+			if (! readinfo->tag)
+				DDF_SnapshotStageTag(token.c_str());
+			else if (stricmp(token.c_str(), readinfo->tag) != 0)
 				DDF_Error("Start tag <%s> expected, found <%s>!\n",
 					readinfo->tag, token.c_str());
 
@@ -949,7 +1177,7 @@ bool DDF_MainReadFile(readinfo_t * readinfo)
 			}
 			else
 			{
-				cur_ddf_linedata.clear();
+				DDF_ClearLineData();
 
 				// finish off previous entry
 				(*readinfo->finish_entry)();
@@ -1063,7 +1291,7 @@ bool DDF_MainReadFile(readinfo_t * readinfo)
 	}
 
 	current_cmd.clear();
-	cur_ddf_linedata.clear();
+	DDF_ClearLineData();
 
 	// -AJA- 1999/10/21: check for unclosed comments
 	if (comment_level > 0)
@@ -1085,6 +1313,8 @@ bool DDF_MainReadFile(readinfo_t * readinfo)
 	if (!firstgo)
 		(*readinfo->finish_entry)();
 
+	DDF_SnapshotRecorded(readinfo);
+
 	cur_ddf_entryname.clear();
 	cur_ddf_filename.clear();
 
@@ -2012,6 +2242,7 @@ damage_c& damage_c::operator=(damage_c &rhs)
 //
 label_offset_c::label_offset_c()
 {
+	label_id = SLAB_None;
 	offset = 0;
 }
 
@@ -2036,6 +2267,7 @@ label_offset_c::~label_offset_c()
 void label_offset_c::Copy(label_offset_c &src)
 {
 	label = src.label;
+	label_id = src.label_id;
 	offset = src.offset;
 }
 
@@ -2045,6 +2277,7 @@ void label_offset_c::Copy(label_offset_c &src)
 void label_offset_c::Default()
 {
 	label.clear();
+	label_id = SLAB_None;
 	offset = 0;
 }
 
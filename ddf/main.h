@@ -124,6 +124,23 @@ void DDF_SetWhere(const std::string& dir);
 
 void DDF_Load(epi::file_c *f);
 
+// total size of all the DDF text lexed so far, and of the files
+// replayed from a snapshot or staging instead
+int DDF_MainParsedBytes(void);
+int DDF_MainReplayedBytes(void);
+
+// snapshots of parsed DDF files (see snapshot.cc)
+bool DDF_SnapshotBegin(const char *filename, const char *version);
+bool DDF_SnapshotChanged(void);
+bool DDF_SnapshotEnd(const char *filename);
+void DDF_SnapshotStats(int *replayed, int *staged, int *parsed);
+
+// staging of DDF files on worker threads (see snapshot.cc)
+class snap_block_c;
+
+snap_block_c * DDF_StageFile(const char *data, int size);
+void DDF_AddStaged(snap_block_c *block);
+
 bool DDF_MainParseCondition(const char *str, condition_check_t *cond);
 void DDF_MainGetWhenAppear(const char *info, void *storage);
 void DDF_MainGetRGB(const char *info, void *storage);
@@ -132,6 +149,7 @@ const char *DDF_MainDecodeList(const char *info, char divider, bool simple);
 void DDF_GetLumpNameForFile(const char *filename, char *lumpname);
 
 int DDF_CompareName(const char *A, const char *B);
+void DDF_NameKey(const char *name, std::string& key);
 
 bool DDF_WeaponIsUpgrade(weapondef_c *weap, weapondef_c *old);
 
@@ -255,6 +255,52 @@ void sfxdef_container_c::CleanupObject(void *obj)
 	return;
 }
 
+//
+// sfxdef_container_c::Insert()
+//
+int sfxdef_container_c::Insert(sfxdef_c *s)
+{
+	int pos = InsertObject((void*)&s);
+
+	name_index.Add(s->name.c_str(), s);
+
+	std::string key;
+	MakeEffectKey(s->name.c_str(), key);
+
+	if (key.find('?') != std::string::npos)
+		wild_effects = true;
+
+	effect_index[key].push_back(pos);
+
+	return pos;
+}
+
+//
+// sfxdef_container_c::Clear()
+//
+void sfxdef_container_c::Clear()
+{
+	name_index.Clear();
+	effect_index.clear();
+	wild_effects = false;
+
+	epi::array_c::Clear();
+}
+
+//
+// sfxdef_container_c::MakeEffectKey()
+//
+// Sound names are matched on their first 8 letters only (see
+// strncasecmpwild below), ignoring case.
+//
+void sfxdef_container_c::MakeEffectKey(const char *name, std::string& key)
+{
+	key.clear();
+
+	for (int i = 0; i < 8 && name[i]; i++)
+		key += (char) toupper(name[i]);
+}
+
 static int strncasecmpwild(const char *s1, const char *s2, int n)
 {
 	int i = 0;
@@ -292,6 +338,46 @@ sfx_t* sfxdef_container_c::GetEffect(const char *name, bool error)
 	if (!name || !name[0] || DDF_CompareName(name, "NULL") == 0)
 		return NULL;
 
+	std::string key;
+	MakeEffectKey(name, key);
+
+	// without any wildcards, the index gives the matches directly
+	if (! wild_effects && key.find('?') == std::string::npos)
+	{
+		std::unordered_map<std::string, std::vector<int> >::const_iterator EI;
+
+		EI = effect_index.find(key);
+
+		if (EI == effect_index.end())
+		{
+			if (error)
+				DDF_WarnError("Unknown SFX: '%.8s'\n", name);
+
+			return NULL;
+		}
+
+		const std::vector<int>& matches = EI->second;
+
+		count = (int)matches.size();
+
+		if (count == 1)
+		{
+			r = &(*this)[matches[0]]->normal;
+
+			SYS_ASSERT(r->num == 1);
+
+			return r;
+		}
+
+		r = (sfx_t*) new byte[sizeof(sfx_t) + ((count - 1) * sizeof(int))];
+
+		// same order as below: latest definition first
+		for (r->num = 0; r->num < count; r->num++)
+			r->sounds[r->num] = matches[count - 1 - r->num];
+
+		return r;
+	}
+
 	// count them
 	for (count = 0, it = GetTailIterator();
 		it.IsValid() && it.GetPos() >= 0;
@@ -352,17 +438,7 @@ sfx_t* sfxdef_container_c::GetEffect(const char *name, bool error)
 //
 sfxdef_c* sfxdef_container_c::Lookup(const char *name)
 {
-	epi::array_iterator_c it;
-
-	for (it = GetIterator(0); it.IsValid(); it++)
-	{
-		sfxdef_c *s = ITERATOR_TO_TYPE(it, sfxdef_c*);
-
-		if (DDF_CompareName(s->name.c_str(), name) == 0)
-			return s;
-	}
-
-	return NULL;
+	return (sfxdef_c *) name_index.Find(name);
 }
 
 //--- editor settings ---
@@ -23,6 +23,8 @@
 
 #include "types.h"
 
+#include <vector>
+
 
 #define S_CLOSE_DIST     160.0f
 #define S_CLIPPING_DIST  4000.0f
@@ -101,18 +103,31 @@ private:
 class sfxdef_container_c : public epi::array_c 
 {
 public:
-	sfxdef_container_c() : epi::array_c(sizeof(sfxdef_c*))
+	sfxdef_container_c() : epi::array_c(sizeof(sfxdef_c*)),
+		name_index(), effect_index(), wild_effects(false)
 	{ }
 
 	~sfxdef_container_c() { Clear(); } 
 
 private:
 	void CleanupObject(void *obj);
-	
+
+	// latest definition for each name
+	ddf_name_index_c name_index;
+
+	// entries matching each 8-letter sound name (for GetEffect)
+	std::unordered_map<std::string, std::vector<int> > effect_index;
+
+	// some names contain '?' wildcards
+	bool wild_effects;
+
+	static void MakeEffectKey(const char *name, std::string& key);
+
 public:
 	// List management
 	int GetSize() { return array_entries; } 
-	int Insert(sfxdef_c *s) { return InsertObject((void*)&s); }
+	int Insert(sfxdef_c *s);
+	void Clear();
 	sfxdef_c* operator[](int idx) { return *(sfxdef_c**)FetchObject(idx); } 
 	
 	// Lookup functions
@@ -0,0 +1,687 @@
+//----------------------------------------------------------------------------
+//  EDGE Data Definition File Code (Snapshots)
+//----------------------------------------------------------------------------
+//
+//  Copyright (c) 2023  The EDGE Team.
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//----------------------------------------------------------------------------
+//
+// A snapshot remembers what the parser made of each DDF file: the
+// sequence of start_entry / parse_field / finish_entry / clear_all
+// calls (with the values after #DEFINE substitution).  It is keyed
+// by the MD5 hash of every file, so when a file has not changed the
+// calls are simply replayed and the text is never lexed again.
+//
+// The definitions themselves are still built by the normal parse
+// routines, since they are full of pointers to other definitions
+// and to engine code, which cannot be stored in a file.
+//
+// The same blocks are used to stage new files: the lexing is done
+// on worker threads (DDF_StageFile), producing blocks which are then
+// replayed in the usual order by the main thread.
+//
+//----------------------------------------------------------------------------
+
+#include "local.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "../epi/math_md5.h"
+#include "../epi/str_format.h"
+
+
+#define SNAPSHOT_MAGIC  "EdgeDDF1"
+
+typedef enum
+{
+	SNAP_Start = 1,
+	SNAP_Field,
+	SNAP_Finish,
+	SNAP_ClearAll
+}
+snap_event_e;
+
+
+class snap_block_c
+{
+public:
+	std::string tag;
+	std::string hash;  // MD5 (16 bytes) of the file contents
+	int size;
+
+	// the recorded calls, see SnapshotAdd*()
+	std::string events;
+
+	// for blocks made by DDF_StageFile: the file contents
+	const char *staged_data;
+
+	snap_block_c() : tag(), hash(), size(0), events(), staged_data(NULL) { }
+	~snap_block_c() { }
+
+	// the tag is not part of the key, since it is not known before
+	// a file is staged.  It is checked when replaying.
+	std::string Key() const
+	{
+		return hash + epi::STR_Format(":%d", size);
+	}
+};
+
+
+static bool snap_active = false;
+static bool snap_dirty  = false;
+
+// false when only staging files (no snapshot file)
+static bool snap_has_file = false;
+
+static std::string snap_version;
+
+// blocks from the snapshot file, waiting to be used
+static std::map<std::string, snap_block_c *> snap_loaded;
+
+// staged blocks, waiting to be used
+static std::map<const char *, snap_block_c *> snap_pending;
+
+// blocks used in this run, in order, for the next snapshot file
+static std::vector<snap_block_c *> snap_used;
+
+static int snap_replayed = 0;
+static int snap_staged   = 0;
+static int snap_parsed   = 0;
+
+
+// the block being recorded, and the real parse routines (none when
+// staging a file)
+static thread_local snap_block_c *snap_record = NULL;
+static thread_local readinfo_t    snap_real;
+
+
+static void SnapshotAddInt(std::string& buf, int value)
+{
+	buf.append((const char *)&value, sizeof(int));
+}
+
+// strings are stored with their terminating NUL, so that replay can
+// pass them straight from the buffer.
+static void SnapshotAddStr(std::string& buf, const char *str)
+{
+	int len = (int)strlen(str);
+
+	SnapshotAddInt(buf, len);
+	buf.append(str, len + 1);
+}
+
+static void SnapshotAddEvent(int type)
+{
+	snap_record->events += (char) type;
+
+	SnapshotAddInt(snap_record->events, cur_ddf_line_num);
+}
+
+static void SnapshotStartEntry(const char *name, bool extend)
+{
+	SnapshotAddEvent(SNAP_Start);
+
+	snap_record->events += (char) (extend ? 1 : 0);
+	SnapshotAddStr(snap_record->events, name);
+
+	if (! ddf_staging)
+		(*snap_real.start_entry)(name, extend);
+}
+
+static void SnapshotParseField(const char *field, const char *contents,
+							   int index, bool is_last)
+{
+	SnapshotAddEvent(SNAP_Field);
+
+	SnapshotAddStr(snap_record->events, field);
+	SnapshotAddStr(snap_record->events, contents);
+	SnapshotAddInt(snap_record->events, index);
+
+	snap_record->events += (char) (is_last ? 1 : 0);
+
+	if (! ddf_staging)
+		(*snap_real.parse_field)(field, contents, index, is_last);
+}
+
+static void SnapshotFinishEntry(void)
+{
+	SnapshotAddEvent(SNAP_Finish);
+
+	if (! ddf_staging)
+		(*snap_real.finish_entry)();
+}
+
+static void SnapshotClearAll(void)
+{
+	SnapshotAddEvent(SNAP_ClearAll);
+
+	if (! ddf_staging)
+		(*snap_real.clear_all)();
+}
+
+
+static snap_block_c * SnapshotNewBlock(const char *tag,
+									   const char *data, int size)
+{
+	epi::md5hash_c md5((const byte *)data, size);
+
+	snap_block_c *block = new snap_block_c;
+
+	block->tag  = tag ? tag : "";
+	block->hash = std::string((const char *)md5.hash, 16);
+	block->size = size;
+
+	return block;
+}
+
+// staged files are found by the address of their data, which stays
+// allocated until they have been read, so they are not hashed again.
+static snap_block_c * SnapshotFindStaged(readinfo_t *readinfo,
+										 const char *data, int size)
+{
+	std::map<const char *, snap_block_c *>::iterator SI;
+
+	SI = snap_pending.find(data);
+
+	if (SI == snap_pending.end())
+		return NULL;
+
+	snap_block_c *block = SI->second;
+
+	if (block->size != size || stricmp(block->tag.c_str(), readinfo->tag) != 0)
+		return NULL;
+
+	snap_pending.erase(SI);
+
+	return block;
+}
+
+
+//
+// DDF_SnapshotReplay
+//
+// Called by DDF_MainReadFile before parsing.  When the snapshot has
+// the calls for this exact file, they are replayed and true is
+// returned.  Otherwise the parse will be recorded.
+//
+bool DDF_SnapshotReplay(readinfo_t *readinfo, const char *data, int size)
+{
+	if (! snap_active || ddf_staging)
+		return false;
+
+	snap_block_c *block = SnapshotFindStaged(readinfo, data, size);
+
+	if (block)
+	{
+		// not in the snapshot file yet
+		snap_staged++;
+		snap_dirty = true;
+	}
+	else if (! snap_has_file)
+	{
+		// nothing to replay, and no point hashing or recording
+		return false;
+	}
+	else
+	{
+		block = SnapshotNewBlock(readinfo->tag, data, size);
+
+		std::map<std::string, snap_block_c *>::iterator SI;
+
+		SI = snap_loaded.find(block->Key());
+
+		if (SI == snap_loaded.end() ||
+			stricmp(SI->second->tag.c_str(), readinfo->tag) != 0)
+		{
+			// record the parse instead
+			snap_record = block;
+			snap_real   = *readinfo;
+
+			readinfo->start_entry  = SnapshotStartEntry;
+			readinfo->parse_field  = SnapshotParseField;
+			readinfo->finish_entry = SnapshotFinishEntry;
+			readinfo->clear_all    = SnapshotClearAll;
+
+			return false;
+		}
+
+		delete block;
+
+		block = SI->second;
+		snap_loaded.erase(SI);
+
+		snap_replayed++;
+	}
+
+	if (snap_has_file)
+		snap_used.push_back(block);
+
+	const char *pos = block->events.data();
+	const char *end = pos + block->events.size();
+
+	while (pos < end)
+	{
+		int type = *pos++;
+
+		memcpy(&cur_ddf_line_num, pos, sizeof(int));
+		pos += sizeof(int);
+
+		switch (type)
+		{
+			case SNAP_Start:
+			{
+				bool extend = (*pos++ != 0);
+
+				pos += sizeof(int);
+
+				const char *name = pos;
+				pos += strlen(name) + 1;
+
+				cur_ddf_entryname = epi::STR_Format("[%s%s]", extend ? "++" : "", name);
+
+				(*readinfo->start_entry)(name, extend);
+				break;
+			}
+
+			case SNAP_Field:
+			{
+				pos += sizeof(int);
+
+				const char *field = pos;
+				pos += strlen(field) + 1;
+
+				pos += sizeof(int);
+
+				const char *contents = pos;
+				pos += strlen(contents) + 1;
+
+				int index;
+				memcpy(&index, pos, sizeof(int));
+				pos += sizeof(int);
+
+				bool is_last = (*pos++ != 0);
+
+				(*readinfo->parse_field)(field, contents, index, is_last);
+				break;
+			}
+
+			case SNAP_Finish:
+				(*readinfo->finish_entry)();
+
+				cur_ddf_entryname.clear();
+				break;
+
+			case SNAP_ClearAll:
+				(*readinfo->clear_all)();
+				break;
+
+			default:
+				I_Error("DDF_SnapshotReplay: bad event %d\n", type);
+				break;
+		}
+	}
+
+	cur_ddf_entryname.clear();
+
+	// only kept for writing the snapshot file
+	if (! snap_has_file)
+		delete block;
+
+	return true;
+}
+
+//
+// DDF_SnapshotRecorded
+//
+// Called by DDF_MainReadFile once the file has been parsed.
+//
+void DDF_SnapshotRecorded(readinfo_t *readinfo)
+{
+	if (! snap_record || ddf_staging)
+		return;
+
+	readinfo->start_entry  = snap_real.start_entry;
+	readinfo->parse_field  = snap_real.parse_field;
+	readinfo->finish_entry = snap_real.finish_entry;
+	readinfo->clear_all    = snap_real.clear_all;
+
+	snap_used.push_back(snap_record);
+	snap_parsed++;
+
+	snap_record = NULL;
+	snap_dirty  = true;
+}
+
+
+//
+// DDF_SnapshotStageTag
+//
+// Called by DDF_MainReadFile with the <TAG> of a file being staged.
+//
+void DDF_SnapshotStageTag(const char *tag)
+{
+	if (snap_record)
+		snap_record->tag = tag;
+}
+
+//
+// DDF_StageFile
+//
+// Lex a DDF file (of any type) into a block of parse calls, without
+// building any definitions.  Safe to call from worker threads, as
+// long as nothing else touches the snapshot.  The data is not freed.
+//
+// Returns NULL when the file is already in the snapshot, or when it
+// caused any error or warning: the normal parse will handle those.
+//
+snap_block_c * DDF_StageFile(const char *data, int size)
+{
+	snap_block_c *block;
+
+	// the hash is only needed for the snapshot file
+	if (snap_has_file)
+	{
+		block = SnapshotNewBlock(NULL, data, size);
+
+		if (snap_loaded.find(block->Key()) != snap_loaded.end())
+		{
+			delete block;
+			return NULL;
+		}
+	}
+	else
+	{
+		block = new snap_block_c;
+		block->size = size;
+	}
+
+	// #DEFINE modifies the text, so work on a copy
+	char *memfile = new char[size + 1];
+
+	block->events.reserve(size);
+
+	memcpy(memfile, data, size);
+	memfile[size] = 0;
+
+	readinfo_t readinfo;
+
+	memset(&readinfo, 0, sizeof(readinfo));
+
+	readinfo.lumpname = "staged";
+	readinfo.memfile  = memfile;
+	readinfo.memsize  = size;
+
+	readinfo.start_entry  = SnapshotStartEntry;
+	readinfo.parse_field  = SnapshotParseField;
+	readinfo.finish_entry = SnapshotFinishEntry;
+	readinfo.clear_all    = SnapshotClearAll;
+
+	memset(&snap_real, 0, sizeof(snap_real));
+
+	snap_record = block;
+	ddf_staging = true;
+
+	bool ok = true;
+
+	try
+	{
+		DDF_MainReadFile(&readinfo);
+	}
+	catch (ddf_stage_failure_c&)
+	{
+		ok = false;
+	}
+
+	ddf_staging = false;
+	snap_record = NULL;
+
+	if (! ok)
+		DDF_MainResetLexer();
+
+	cur_ddf_entryname.clear();
+	cur_ddf_filename.clear();
+
+	delete[] memfile;
+
+	if (! ok || block->tag.empty())
+	{
+		delete block;
+		return NULL;
+	}
+
+	block->events.shrink_to_fit();
+	block->staged_data = data;
+
+	return block;
+}
+
+//
+// DDF_AddStaged
+//
+// Make a staged block available to DDF_MainReadFile, which replays
+// it when the same data is read.  Call from the main thread.
+//
+void DDF_AddStaged(snap_block_c *block)
+{
+	snap_pending[block->staged_data] = block;
+}
+
+
+static bool ReadInt(FILE *fp, int *value)
+{
+	return fread(value, sizeof(int), 1, fp) == 1;
+}
+
+static bool ReadStr(FILE *fp, std::string& str, int max_len)
+{
+	int len;
+
+	if (! ReadInt(fp, &len) || len < 0 || len > max_len)
+		return false;
+
+	str.resize(len);
+
+	return len == 0 || fread(&str[0], 1, len, fp) == (size_t)len;
+}
+
+static void WriteInt(FILE *fp, int value)
+{
+	fwrite(&value, sizeof(int), 1, fp);
+}
+
+static void WriteStr(FILE *fp, const std::string& str)
+{
+	WriteInt(fp, (int)str.size());
+	fwrite(str.data(), 1, str.size(), fp);
+}
+
+static void SnapshotFree(void)
+{
+	std::map<std::string, snap_block_c *>::iterator SI;
+
+	for (SI = snap_loaded.begin(); SI != snap_loaded.end(); SI++)
+		delete SI->second;
+
+	snap_loaded.clear();
+
+	std::map<const char *, snap_block_c *>::iterator PI;
+
+	for (PI = snap_pending.begin(); PI != snap_pending.end(); PI++)
+		delete PI->second;
+
+	snap_pending.clear();
+
+	for (int i = 0; i < (int)snap_used.size(); i++)
+		delete snap_used[i];
+
+	snap_used.clear();
+}
+
+static bool SnapshotRead(FILE *fp)
+{
+	char magic[8];
+	int total;
+
+	std::string version;
+
+	if (fread(magic, 1, 8, fp) != 8 || memcmp(magic, SNAPSHOT_MAGIC, 8) != 0)
+		return false;
+
+	if (! ReadStr(fp, version, 256) || version != snap_version)
+		return false;
+
+	if (! ReadInt(fp, &total) || total < 0)
+		return false;
+
+	for (int i = 0; i < total; i++)
+	{
+		snap_block_c *block = new snap_block_c;
+
+		if (! ReadStr(fp, block->tag, 64) ||
+			! ReadStr(fp, block->hash, 16) ||
+			! ReadInt(fp, &block->size) ||
+			! ReadStr(fp, block->events, 1 << 30))
+		{
+			delete block;
+			return false;
+		}
+
+		// the same file may be used twice
+		if (snap_loaded.find(block->Key()) != snap_loaded.end())
+		{
+			delete block;
+			continue;
+		}
+
+		snap_loaded[block->Key()] = block;
+	}
+
+	if (fread(magic, 1, 8, fp) != 8 || memcmp(magic, SNAPSHOT_MAGIC, 8) != 0)
+		return false;
+
+	return true;
+}
+
+//
+// DDF_SnapshotBegin
+//
+// Start using snapshots for the following DDF files.  The snapshot
+// file is loaded when it exists and was made by the same version.
+// The filename can be NULL, just for staging files.
+// Returns false if no (usable) snapshot was loaded.
+//
+bool DDF_SnapshotBegin(const char *filename, const char *version)
+{
+	SnapshotFree();
+
+	snap_active = true;
+	snap_dirty  = false;
+	snap_version = version;
+
+	snap_replayed = snap_staged = snap_parsed = 0;
+
+	snap_has_file = (filename != NULL);
+
+	if (! filename)
+		return false;
+
+	FILE *fp = fopen(filename, "rb");
+
+	if (! fp)
+		return false;
+
+	bool ok = SnapshotRead(fp);
+
+	fclose(fp);
+
+	if (! ok)
+	{
+		SnapshotFree();
+		return false;
+	}
+
+	return true;
+}
+
+//
+// DDF_SnapshotChanged
+//
+// True when the snapshot file is out of date: some file had to be
+// parsed, or some snapshot entries were not used.
+//
+bool DDF_SnapshotChanged(void)
+{
+	return snap_active && (snap_dirty || ! snap_loaded.empty());
+}
+
+//
+// DDF_SnapshotEnd
+//
+// Stop using snapshots.  When a filename is given, a new snapshot
+// file is written with everything used this time.  Returns false if
+// the file could not be written.
+//
+bool DDF_SnapshotEnd(const char *filename)
+{
+	bool ok = true;
+
+	if (snap_active && filename)
+	{
+		FILE *fp = fopen(filename, "wb");
+
+		if (fp)
+		{
+			fwrite(SNAPSHOT_MAGIC, 1, 8, fp);
+
+			WriteStr(fp, snap_version);
+			WriteInt(fp, (int)snap_used.size());
+
+			for (int i = 0; i < (int)snap_used.size(); i++)
+			{
+				snap_block_c *block = snap_used[i];
+
+				WriteStr(fp, block->tag);
+				WriteStr(fp, block->hash);
+				WriteInt(fp, block->size);
+				WriteStr(fp, block->events);
+			}
+
+			fwrite(SNAPSHOT_MAGIC, 1, 8, fp);
+
+			ok = (ferror(fp) == 0);
+
+			if (fclose(fp) != 0)
+				ok = false;
+		}
+		else
+			ok = false;
+	}
+
+	SnapshotFree();
+
+	snap_active = false;
+
+	return ok;
+}
+
+void DDF_SnapshotStats(int *replayed, int *staged, int *parsed)
+{
+	*replayed = snap_replayed;
+	*staged   = snap_staged;
+	*parsed   = snap_parsed;
+}
+
+//--- editor settings ---
+// vi:ts=4:sw=4:noexpandtab
@@ -41,6 +41,7 @@ static const state_t template_state =
 
 	NULL,		// model_frame
 	NULL,       // label
+	SLAB_None,  // label id
 	NULL,       // routine
 	NULL,       // parameter
 
@@ -271,6 +272,101 @@ static int StateGetRedirector(const char *redir)
 	return redirs.GetSize() - 1;
 }
 
+//
+// State label interning
+//
+// Labels are keyed by DDF_NameKey(), so names which DDF_CompareName()
+// treats as equal (e.g. WEAK_DEATH and WEAKDEATH) get the same id.
+//
+static std::unordered_map<std::string, int> label_ids;
+static std::vector<std::string> label_names;
+
+static const char *builtin_labels[SLAB_FIRST_DYNAMIC] =
+{
+	"",  // SLAB_None
+	"SPAWN", "IDLE", "SWIM", "FLY", "CLIMB", "JUMP",
+	"WEAKDEATH", "WEAKPAIN"
+};
+
+int DDF_StateLabelID(const char *label, bool create)
+{
+	if (label_names.empty())
+	{
+		for (int k = 0; k < SLAB_FIRST_DYNAMIC; k++)
+		{
+			label_names.push_back(builtin_labels[k]);
+
+			if (k != SLAB_None)
+				label_ids[builtin_labels[k]] = k;
+		}
+	}
+
+	if (! label)
+		return SLAB_None;
+
+	std::string key;
+	DDF_NameKey(label, key);
+
+	std::unordered_map<std::string, int>::iterator LI = label_ids.find(key);
+
+	if (LI != label_ids.end())
+		return LI->second;
+
+	if (key.empty() || ! create)
+		return SLAB_None;
+
+	int id = (int)label_names.size();
+
+	label_names.push_back(key);
+	label_ids[key] = id;
+
+	return id;
+}
+
+const char *DDF_StateLabelName(int label_id)
+{
+	if (label_id <= SLAB_None || label_id >= (int)label_names.size())
+		return NULL;
+
+	return label_names[label_id].c_str();
+}
+
+void state_labels_c::Build(const state_group_t& group)
+{
+	table.clear();
+
+	for (int g = 0; g < (int)group.size(); g++)
+	{
+		for (statenum_t i = group[g].first; i <= group[g].last; i++)
+		{
+			if (i > 0 && states[i].label_id != SLAB_None)
+				table[states[i].label_id] = i;
+		}
+	}
+
+	built = true;
+}
+
+statenum_t state_labels_c::Find(const state_group_t& group, int label_id)
+{
+	if (! built)
+		Build(group);
+
+	if (label_id == SLAB_None)
+		return S_NULL;
+
+	std::unordered_map<int, statenum_t>::const_iterator TI = table.find(label_id);
+
+	if (TI != table.end())
+		return TI->second;
+
+	// compatibility hack:
+	if (label_id == SLAB_IDLE)
+		return Find(group, SLAB_SPAWN);
+
+	return S_NULL;
+}
+
 //
 // DDF_StateFindLabel
 //
@@ -391,6 +487,7 @@ void DDF_StateReadState(const char *info, const char *label,
 
 		// ...therefore copy the label
 		cur->label = strdup(label);
+		cur->label_id = DDF_StateLabelID(label, true);
 	}
 
 	if (redir && cur->nextstate == 0)
@@ -875,6 +972,7 @@ void DDF_StateGetBecome(const char *arg, state_t * cur_state)
 	act_become_info_t *become = new act_become_info_t;
 
 	become->start.label.Set("IDLE");
+	become->start.label_id = SLAB_IDLE;
 
 	const char *s = strchr(arg, ',');
 
@@ -915,6 +1013,7 @@ void DDF_StateGetBecome(const char *arg, state_t * cur_state)
 		buffer[len] = 0;
 
 		become->start.label.Set(buffer);
+		become->start.label_id = DDF_StateLabelID(buffer, true);
 
 		if (*s == ':')
 			become->start.offset = MAX(0, atoi(s + 1) - 1);
@@ -20,6 +20,7 @@
 #define __DDF_STAT_H__
 
 #include <vector>
+#include <unordered_map>
 
 
 //-------------------------------------------------------------------------
@@ -68,6 +69,9 @@ typedef struct state_s
 	// label for state, or NULL
 	const char *label;
 
+	// interned id of the label (see DDF_StateLabelID), or SLAB_None
+	int label_id;
+
 	// routine to be performed
 	void (* action)(struct mobj_s * object);
 
@@ -92,6 +96,52 @@ state_range_t;
 typedef std::vector<state_range_t> state_group_t;
 
 
+// Labels are interned to small integers as the states are read,
+// so the engine can find a label without any string compares.
+// These ones are used by the engine itself, and always get the
+// same id.
+typedef enum
+{
+	SLAB_None = 0,
+
+	SLAB_SPAWN,
+	SLAB_IDLE,
+	SLAB_SWIM,
+	SLAB_FLY,
+	SLAB_CLIMB,
+	SLAB_JUMP,
+	SLAB_WEAKDEATH,
+	SLAB_WEAKPAIN,
+
+	SLAB_FIRST_DYNAMIC
+}
+state_label_e;
+
+
+// Maps label ids to the state which begins that label in a state
+// group.  The table is built on first use, and later definitions
+// of a label win (same as DDF_StateFindLabel).
+class state_labels_c
+{
+public:
+	state_labels_c() : built(false), table() { }
+	~state_labels_c() { }
+
+	void Clear() { built = false; table.clear(); }
+
+	void Build(const state_group_t& group);
+
+	// returns S_NULL when not found.  Like DDF_StateFindLabel, a
+	// missing IDLE label will fall back to SPAWN.
+	statenum_t Find(const state_group_t& group, int label_id);
+
+private:
+	bool built;
+
+	std::unordered_map<int, statenum_t> table;
+};
+
+
 // -------EXTERNALISATIONS-------
 
 extern state_t *states;
@@ -103,6 +153,13 @@ extern std::vector<std::string> ddf_model_names;
 statenum_t DDF_StateFindLabel(const state_group_t& group,
                               const char *label, bool quiet = false);
 
+// returns the id for the label (names match like DDF_CompareName).
+// When 'create' is false and the label has never been seen, returns
+// SLAB_None.
+int DDF_StateLabelID(const char *label, bool create = false);
+
+const char *DDF_StateLabelName(int label_id);
+
 bool DDF_StateGroupHasState(const state_group_t& group, statenum_t st);
 
 #endif // __DDF_STAT_H__
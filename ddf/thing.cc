@@ -34,7 +34,6 @@
 #undef  DF
 #define DF  DDF_FIELD
 
-#define DDF_MobjHashFunc(x)  (((x) + LOOKUP_CACHESIZE) % LOOKUP_CACHESIZE)
 
 mobjtype_container_c mobjtypes;
 
@@ -463,6 +462,31 @@ int DDF_CompareName(const char *A, const char *B)
 	}
 }
 
+//
+// DDF_NameKey
+//
+// Convert a name into a key which is equal for any two names that
+// DDF_CompareName() says are the same, for use in hash tables.
+//
+void DDF_NameKey(const char *name, std::string& key)
+{
+	key.clear();
+
+	// keep in sync with DDF_CompareName
+	for (; *name; name++)
+	{
+		if (*name == ' ' || *name == '_')
+			continue;
+
+		key += (char) toupper(*name);
+	}
+}
+
+void ddf_name_index_c::MakeKey(const char *name, std::string& key)
+{
+	DDF_NameKey(name, key);
+}
+
 //
 //  DDF PARSE ROUTINES
 //
@@ -495,7 +519,7 @@ static void ThingStartEntry(const char *buffer, bool extend)
 
 	dynamic_mobj = NULL;
 
-	int idx = mobjtypes.FindFirst(name.c_str(), 0);
+	int idx = mobjtypes.FindLast(name.c_str());
 
 	if (idx >= 0)
 	{
@@ -536,13 +560,10 @@ static void ThingStartEntry(const char *buffer, bool extend)
 
 static void ThingDoTemplate(const char *contents)
 {
-	int idx = mobjtypes.FindFirst(contents, 0);
-	if (idx < 0)
+	mobjtype_c *other = mobjtypes.Find(contents);
+	if (! other)
 		DDF_Error("Unknown thing template: '%s'\n", contents);
 
-	mobjtype_c *other = mobjtypes[idx];
-	SYS_ASSERT(other);
-
 	if (other == dynamic_mobj)
 		DDF_Error("Bad thing template: '%s'\n", contents);
 
@@ -587,6 +608,8 @@ static void ThingFinishEntry(void)
 {
 	DDF_StateFinishRange(dynamic_mobj->state_grp);
 
+	mobjtypes.NumbersChanged();
+
 	// count-as-kill things are automatically monsters
 	if (dynamic_mobj->flags & MF_COUNTKILL)
 		dynamic_mobj->extendedflags |= EF_MONSTER;
@@ -735,6 +758,8 @@ void DDF_MobjCleanUp(void)
 
 		m->spitspot = m->spitspot_ref ? mobjtypes.Lookup(m->spitspot_ref) : NULL;
 
+		m->state_labels.Build(m->state_grp);
+
 		cur_ddf_entryname.clear();
 	}
 
@@ -938,12 +963,12 @@ static bool BenefitTryAmmoLimit(const char *name, benefit_t *be,
 static bool BenefitTryWeapon(const char *name, benefit_t *be,
 	int num_vals)
 {
-	int idx = weapondefs.FindFirst(name, 0);
+	weapondef_c *weap = weapondefs.Lookup(name);
 
-	if (idx < 0)
+	if (! weap)
 		return false;
 
-	be->sub.weap = weapondefs[idx];
+	be->sub.weap = weap;
 
 	be->type = BENEFIT_Weapon;
 	be->limit = 1.0f;
@@ -1068,12 +1093,12 @@ static bool BenefitTryPowerup(const char *name, benefit_t *be, int num_vals)
 	if (be->sub.type == PW_Berserk &&
 		DDF_CompareName(name, "POWERUP_BERSERK") == 0)
 	{
-		int idx = weapondefs.FindFirst("FIST", 0);
+		weapondef_c *fist = weapondefs.Lookup("FIST");
 
-		if (idx >= 0)
+		if (fist)
 		{
 			AddPickupEffect(&dynamic_mobj->pickup_effects,
-				new pickup_effect_c(PUFX_SwitchWeapon, weapondefs[idx], 0, 0));
+				new pickup_effect_c(PUFX_SwitchWeapon, fist, 0, 0));
 
 			AddPickupEffect(&dynamic_mobj->pickup_effects,
 				new pickup_effect_c(PUFX_KeepPowerup, PW_Berserk, 0, 0));
@@ -1675,12 +1700,12 @@ static bool ConditionTryAmmo(const char *name, const char *sub,
 static bool ConditionTryWeapon(const char *name, const char *sub,
 	condition_check_t *cond)
 {
-	int idx = weapondefs.FindFirst(name, 0);
+	weapondef_c *weap = weapondefs.Lookup(name);
 
-	if (idx < 0)
+	if (! weap)
 		return false;
 
-	cond->sub.weap = weapondefs[idx];
+	cond->sub.weap = weap;
 
 	cond->cond_type = COND_Weapon;
 	return true;
@@ -1844,6 +1869,8 @@ void mobjtype_c::CopyDetail(mobjtype_c &src)
 	for (unsigned int i = 0; i < src.state_grp.size(); i++)
 		state_grp.push_back(src.state_grp[i]);
 
+	state_labels.Clear();
+
 	spawn_state = src.spawn_state;
 	idle_state = src.idle_state;
 	chase_state = src.chase_state;
@@ -1976,6 +2003,7 @@ void mobjtype_c::CopyDetail(mobjtype_c &src)
 void mobjtype_c::Default()
 {
 	state_grp.clear();
+	state_labels.Clear();
 
 	spawn_state = 0;
 	idle_state = 0;
@@ -2144,9 +2172,9 @@ void mobjtype_c::DLightCompatibility(void)
 
 // --> mobjtype_container_c class
 
-mobjtype_container_c::mobjtype_container_c() : epi::array_c(sizeof(mobjtype_c*))
+mobjtype_container_c::mobjtype_container_c() : epi::array_c(sizeof(mobjtype_c*)),
+	name_index(), number_index(), number_dirty(true)
 {
-	memset(lookup_cache, 0, sizeof(mobjtype_c*) * LOOKUP_CACHESIZE);
 }
 
 mobjtype_container_c::~mobjtype_container_c()
@@ -2164,6 +2192,23 @@ void mobjtype_container_c::CleanupObject(void *obj)
 	return;
 }
 
+int mobjtype_container_c::Insert(mobjtype_c *m)
+{
+	name_index.Add(m->name.c_str(), m);
+	number_dirty = true;
+
+	return InsertObject((void*)&m);
+}
+
+void mobjtype_container_c::Clear()
+{
+	name_index.Clear();
+	number_index.clear();
+	number_dirty = true;
+
+	epi::array_c::Clear();
+}
+
 int mobjtype_container_c::FindFirst(const char *name, int startpos)
 {
 	epi::array_iterator_c it;
@@ -2196,7 +2241,22 @@ int mobjtype_container_c::FindLast(const char *name, int startpos)
 	if (startpos >= 0 && startpos < array_entries)
 		it = GetIterator(startpos);
 	else
-		it = GetTailIterator();
+	{
+		// searching the whole list: the index knows the answer, only
+		// its position is needed (comparing pointers is cheap).
+		mobjtype_c *last = Find(name);
+
+		if (! last)
+			return -1;
+
+		for (it = GetTailIterator(); it.IsValid(); it--)
+		{
+			if (ITERATOR_TO_TYPE(it, mobjtype_c*) == last)
+				return it.GetPos();
+		}
+
+		return -1;
+	}
 
 	while (it.IsValid())
 	{
@@ -2232,18 +2292,30 @@ bool mobjtype_container_c::MoveToEnd(int idx)
 		(array_entries - (idx + 1))*array_objsize);
 
 	memcpy(&array[(array_entries - 1)*array_block_objsize], (void*)&m, sizeof(mobjtype_c*));
+
+	// it is now the latest definition
+	name_index.Add(m->name.c_str(), m);
+	number_dirty = true;
+
 	return true;
 }
 
+mobjtype_c *mobjtype_container_c::Find(const char *name)
+{
+	// Looks an mobjdef by name, returns NULL if it does not exist.
+
+	return (mobjtype_c *) name_index.Find(name);
+}
+
 const mobjtype_c *mobjtype_container_c::Lookup(const char *refname)
 {
 	// Looks an mobjdef by name.
 	// Fatal error if it does not exist.
 
-	int idx = FindLast(refname);
+	const mobjtype_c *m = Find(refname);
 
-	if (idx >= 0)
-		return (*this)[idx];
+	if (m)
+		return m;
 
 	if (lax_errors)
 		return default_mobjtype;
@@ -2258,32 +2330,35 @@ const mobjtype_c *mobjtype_container_c::Lookup(int id)
 		return default_mobjtype;
 
 	// Looks an mobjdef by number.
-	// Fatal error if it does not exist.
+	// Returns NULL if it does not exist.
 
-	int slot = DDF_MobjHashFunc(id);
+	if (number_dirty)
+		RebuildNumbers();
 
-	// check the cache
-	if (lookup_cache[slot] &&
-		lookup_cache[slot]->number == id)
-	{
-		return lookup_cache[slot];
-	}
+	std::unordered_map<int, mobjtype_c *>::const_iterator NI = number_index.find(id);
+
+	if (NI != number_index.end())
+		return NI->second;
+
+	return NULL;
+}
+
+void mobjtype_container_c::RebuildNumbers()
+{
+	number_index.clear();
 
 	epi::array_iterator_c it;
 
-	for (it = GetTailIterator(); it.IsValid(); it--)
+	// later entries replace earlier ones
+	for (it = GetBaseIterator(); it.IsValid(); it++)
 	{
 		mobjtype_c *m = ITERATOR_TO_TYPE(it, mobjtype_c*);
 
-		if (m->number == id)
-		{
-			// update the cache
-			lookup_cache[slot] = m;
-			return m;
-		}
+		if (m->number != 0)
+			number_index[m->number] = m;
 	}
 
-	return NULL;
+	number_dirty = false;
 }
 
 const mobjtype_c *mobjtype_container_c::LookupCastMember(int castpos)
@@ -599,6 +599,7 @@ public:
 	label_offset_c& operator=(label_offset_c &rhs);
 
 	epi::strent_c label;
+	int label_id;  // interned (DDF_StateLabelID)
 	int offset;
 };
 
@@ -756,6 +757,9 @@ public:
 
 	// range of states used
 	state_group_t state_grp;
+
+	// label id -> state lookup for state_grp (built on first use)
+	mutable state_labels_c state_labels;
   
 	int spawn_state;
 	int idle_state;
@@ -942,18 +946,30 @@ public:
 private:
 	void CleanupObject(void *obj);
 
-	mobjtype_c* lookup_cache[LOOKUP_CACHESIZE];
+	// latest definition for each name
+	ddf_name_index_c name_index;
+
+	// latest definition for each doomednum, rebuilt when needed
+	std::unordered_map<int, mobjtype_c *> number_index;
+	bool number_dirty;
+
+	void RebuildNumbers();
 
 public:
 	// List Management
 	int GetSize() {	return array_entries; } 
-	int Insert(mobjtype_c *m) { return InsertObject((void*)&m); }
+	int Insert(mobjtype_c *m);
 	mobjtype_c* operator[](int idx) { return *(mobjtype_c**)FetchObject(idx); } 
 	bool MoveToEnd(int idx);
+	void Clear();
+
+	// the doomednum of an entry was changed
+	void NumbersChanged() { number_dirty = true; }
 
 	// Search Functions
 	int FindFirst(const char *name, int startpos = -1);
 	int FindLast(const char *name, int startpos = -1);
+	mobjtype_c *Find(const char *name);
 	const mobjtype_c *Lookup(const char *refname);
 	const mobjtype_c *Lookup(int id);
 
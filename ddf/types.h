@@ -28,6 +28,9 @@
 
 #include "../epi/utility.h"
 
+#include <string>
+#include <unordered_map>
+
 class mobjtype_c;
 
 
@@ -175,6 +178,45 @@ public:
 };
 
 
+// Hash index of DDF entries by name, used by the containers to avoid
+// linear searches.  Names are compared the DDF_CompareName way (case,
+// spaces and underscores are ignored), and when the same name is
+// added again the later entry wins.
+class ddf_name_index_c
+{
+public:
+	ddf_name_index_c() : table() { }
+	~ddf_name_index_c() { }
+
+private:
+	std::unordered_map<std::string, void *> table;
+
+public:
+	// convert a name into the hashed form
+	static void MakeKey(const char *name, std::string& key);
+
+	void Clear() { table.clear(); }
+
+	void Add(const char *name, void *entry)
+	{
+		std::string key;
+		MakeKey(name, key);
+
+		table[key] = entry;
+	}
+
+	void *Find(const char *name) const
+	{
+		std::string key;
+		MakeKey(name, key);
+
+		std::unordered_map<std::string, void *>::const_iterator NI = table.find(key);
+
+		return (NI != table.end()) ? NI->second : NULL;
+	}
+};
+
+
 #endif /*__DDF_TYPE_H__*/
 
 //--- editor settings ---
@@ -434,6 +434,15 @@ void DDF_WeaponInit(void)
 
 void DDF_WeaponCleanUp(void)
 {
+	epi::array_iterator_c it;
+
+	for (it = weapondefs.GetIterator(0); it.IsValid(); it++)
+	{
+		weapondef_c *w = ITERATOR_TO_TYPE(it, weapondef_c*);
+
+		w->state_labels.Build(w->state_grp);
+	}
+
 	// Trim down the required to size
 	weapondefs.Trim();
 }
@@ -559,6 +568,8 @@ void weapondef_c::CopyDetail(weapondef_c &src)
 	for (unsigned int i = 0; i < src.state_grp.size(); i++)
 		state_grp.push_back(src.state_grp[i]);
 
+	state_labels.Clear();
+
 	for (int ATK = 0; ATK < 2; ATK++)
 	{
 		attack[ATK] = src.attack[ATK];
@@ -633,6 +644,7 @@ void weapondef_c::CopyDetail(weapondef_c &src)
 void weapondef_c::Default(void)
 {
 	state_grp.clear();
+	state_labels.Clear();
 
 	for (int ATK = 0; ATK < 2; ATK++)
 	{
@@ -707,7 +719,7 @@ void weapondef_c::Default(void)
 // weapondef_container_c Constructor
 //
 weapondef_container_c::weapondef_container_c()
-	: epi::array_c(sizeof(weapondef_c*))
+	: epi::array_c(sizeof(weapondef_c*)), name_index()
 {
 }
 
@@ -764,11 +776,10 @@ int weapondef_container_c::FindFirst(const char *name, int startpos)
 //
 weapondef_c* weapondef_container_c::Lookup(const char* refname)
 {
-	int idx = FindFirst(refname, 0);
-	if (idx >= 0)
-		return (*this)[idx];
+	if (!refname || !refname[0])
+		return NULL;
 
-	return NULL;
+	return (weapondef_c *) name_index.Find(refname);
 }
 
 //--- editor settings ---
@@ -75,6 +75,9 @@ public:
   
 	// range of states used
 	state_group_t state_grp;
+
+	// label id -> state lookup for state_grp (built on first use)
+	mutable state_labels_c state_labels;
   
 	int up_state;			// State to use when raising the weapon 
 	int down_state;			// State to use when lowering the weapon (if changing weapon)
@@ -188,10 +191,19 @@ public:
 private:
 	void CleanupObject(void *obj);
 
+	// latest definition for each name
+	ddf_name_index_c name_index;
+
 public:
 	// List Management
 	int GetSize() {	return array_entries; } 
-	int Insert(weapondef_c *w) { return InsertObject((void*)&w); }
+	int Insert(weapondef_c *w)
+	{
+		name_index.Add(w->name.c_str(), w);
+		return InsertObject((void*)&w);
+	}
+
+	void Clear() { name_index.Clear(); epi::array_c::Clear(); }
 	
 	weapondef_c* operator[](int idx) 
 	{ 
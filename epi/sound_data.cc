@@ -24,6 +24,8 @@
 namespace epi
 {
 
+int sound_data_c::mix_passes = 0;
+
 sound_data_c::sound_data_c() :
 	length(0), freq(0), mode(0),
 	data_L(NULL), data_R(NULL),
@@ -109,6 +111,8 @@ void sound_data_c::Mix_Submerged()
 {
 	if (current_mix != SFX_Submerged)
 	{
+		mix_passes++;
+
 		// Setup lowpass + reverb parameters
 		int out_L = 0;
 		int accum_L = 0;
@@ -207,6 +211,8 @@ void sound_data_c::Mix_Vacuum()
 {
 	if (current_mix != SFX_Vacuum)
 	{
+		mix_passes++;
+
 		// Setup lowpass parameters
 		int out_L = 0;
 		int accum_L = 0;
@@ -264,6 +270,8 @@ void sound_data_c::Mix_Reverb(bool dynamic_reverb, float room_area, bool outdoor
 	{
 		if (current_mix != SFX_Reverb || ddf_reverb_ratio != current_ddf_ratio || ddf_reverb_delay != current_ddf_delay || ddf_reverb_type != current_ddf_type)
 		{
+			mix_passes++;
+
 			// Setup reverb parameters
 			int *reverb_buffer_L;
 			int *reverb_buffer_R;
@@ -387,6 +395,8 @@ void sound_data_c::Mix_Reverb(bool dynamic_reverb, float room_area, bool outdoor
 
 		if (current_mix != SFX_Reverb || reverbed_room_size != current_room_size || reverb_is_outdoors != outdoor_reverb)
 		{
+			mix_passes++;
+
 			// Setup reverb parameters
 			int *reverb_buffer_L;
 			int *reverb_buffer_R;
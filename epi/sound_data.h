@@ -83,6 +83,10 @@ public:
 
 	bool reverb_is_outdoors;
 
+	// total number of times any buffer's fx_data has been recomputed
+	// (i.e. a Mix_XXX call which was not satisfied by the cached mix).
+	static int mix_passes;
+
 public:
 	sound_data_c();
 	~sound_data_c();
@@ -32,10 +32,14 @@
 #include "hu_style.h"
 #include "m_argv.h"
 #include "m_shift.h"
+#include "p_local.h"
 #include "r_draw.h"
 #include "r_image.h"
 #include "r_modes.h"
 #include "r_wipe.h"
+#include "rad_trig.h"
+#include "s_blit.h"
+#include "s_cache.h"
 
 #include "r_qbb.h"
 
@@ -44,6 +48,9 @@
 
 DEF_CVAR(debug_fps, int, "c", 0);
 DEF_CVAR(debug_pos, int, "c", 0);
+DEF_CVAR(debug_audio, int, "c", 0);
+DEF_CVAR(debug_rts, int, "c", 0);
+DEF_CVAR(debug_crush, int, "c", 0);
 DEF_CVAR(debug_ticrate, int, "c", 0);
 
 static visible_t con_visible;
@@ -1163,12 +1170,16 @@ void CON_ShowFPS(void)
 {
 	CON_SetupFont();
 
-	if (debug_fps <= 0 && debug_pos <= 0)
+	if (debug_fps <= 0 && debug_pos <= 0 && debug_audio <= 0 && debug_rts <= 0 &&
+		debug_crush <= 0)
 		return;
 
 	static int numframes = 0, lasttime = 0;
 	static float fps = 0, mspf = 0;
 
+	static mix_stats_t mix_st;
+	static float mix_avg = 0, mix_max = 0;
+
 	char textbuf[100];
 	int currtime, timediff;
 
@@ -1183,6 +1194,15 @@ void CON_ShowFPS(void)
 
 		lasttime = currtime;
 		numframes = 0;
+
+		// mixer timings are averaged over the same period as the fps
+		if (debug_audio > 0)
+		{
+			S_GetMixStats(&mix_st, true);
+
+			mix_avg = mix_st.mix_avg_us;
+			mix_max = mix_st.mix_max_us;
+		}
 	}
 
 	int lcount = 2;
@@ -1193,6 +1213,15 @@ void CON_ShowFPS(void)
 	if (debug_pos)
 		lcount += 8;
 
+	if (debug_audio > 0)
+		lcount += 7;
+
+	if (debug_rts > 0)
+		lcount += 3;
+
+	if (debug_crush > 0)
+		lcount += 3;
+
 	int x = SCREENWIDTH  - XMUL * 16;
 	int y = SCREENHEIGHT - YMUL * lcount;
 
@@ -1250,6 +1279,91 @@ void CON_ShowFPS(void)
 		DrawText(x, y, textbuf, T_GREY176);
 		y -= YMUL*2;
 	}
+
+	if (debug_audio > 0)
+	{
+		// voice counts are cheap, so keep them current
+		mix_stats_t cur;
+		S_GetMixStats(&cur, false);
+
+		int real_voices = 0;
+		int virt_voices = 0;
+
+		for (int c = 0; c < SNCAT_NUMTYPES; c++)
+		{
+			real_voices += cur.real_voices[c];
+			virt_voices += cur.virt_voices[c];
+		}
+
+		cache_stats_t cs;
+		S_CacheGetStats(&cs);
+
+		int lookups = cs.hits + cs.misses;
+
+		sprintf(textbuf, "voice: %d+%d", real_voices, virt_voices);
+		DrawText(x, y, textbuf, T_GREY176);
+		y -= YMUL;
+
+		sprintf(textbuf, "  mix: %1.0f us", mix_avg);
+		DrawText(x, y, textbuf, T_GREY176);
+		y -= YMUL;
+
+		sprintf(textbuf, "  max: %1.0f us", mix_max);
+		DrawText(x, y, textbuf, T_GREY176);
+		y -= YMUL;
+
+		sprintf(textbuf, "queue: %d", cur.queue_depth);
+		DrawText(x, y, textbuf, T_GREY176);
+		y -= YMUL;
+
+		sprintf(textbuf, "cache: %d KB", (cs.bytes + 1023) / 1024);
+		DrawText(x, y, textbuf, T_GREY176);
+		y -= YMUL;
+
+		sprintf(textbuf, "  hit: %1.1f%%", lookups ? cs.hits * 100.0f / lookups : 0.0f);
+		DrawText(x, y, textbuf, T_GREY176);
+		y -= YMUL;
+
+		sprintf(textbuf, "fxmix: %d", epi::sound_data_c::mix_passes);
+		DrawText(x, y, textbuf, T_GREY176);
+		y -= YMUL;
+	}
+
+	if (debug_rts > 0)
+	{
+		rad_stats_t rs;
+		RAD_GetTriggerStats(&rs);
+
+		sprintf(textbuf, "  rts: %d", rs.total);
+		DrawText(x, y, textbuf, T_GREY176);
+		y -= YMUL;
+
+		sprintf(textbuf, "check: %d", rs.checked);
+		DrawText(x, y, textbuf, T_GREY176);
+		y -= YMUL;
+
+		sprintf(textbuf, "  max: %d", rs.checked_max);
+		DrawText(x, y, textbuf, T_GREY176);
+		y -= YMUL;
+	}
+
+	if (debug_crush > 0)
+	{
+		crush_stats_t cs;
+		P_GetCrushStats(&cs);
+
+		sprintf(textbuf, "movrs: %d", cs.moves);
+		DrawText(x, y, textbuf, T_GREY176);
+		y -= YMUL;
+
+		sprintf(textbuf, "crush: %d", cs.checked);
+		DrawText(x, y, textbuf, T_GREY176);
+		y -= YMUL;
+
+		sprintf(textbuf, "  max: %d", cs.checked_max);
+		DrawText(x, y, textbuf, T_GREY176);
+		y -= YMUL;
+	}
 }
 
 
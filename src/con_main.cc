@@ -32,6 +32,8 @@
 #include "m_menu.h"
 #include "m_misc.h"
 #include "s_sound.h"
+#include "s_music.h"
+#include "vm_coal.h"
 #include "w_wad.h"
 #include "version.h"
 #include "z_zone.h"
@@ -39,9 +41,11 @@
 // [SP] Headers for cheat codes (need access to player and mobjs)
 #include "p_local.h"
 #include "p_mobj.h"
+#include "p_simd.h"
 #include "p_bot.h"
 #include "dm_state.h"
 #include "p_cheats.h"
+#include "p_tick.h"
 // [SP] Externals
 extern int debug_fps, debug_pos;
 
@@ -243,6 +247,56 @@ int CMD_PlaySound(char **argv, int argc)
 	return 0;
 }
 
+int CMD_AudioStats(char **argv, int argc)
+{
+	S_ShowAudioStats();
+	return 0;
+}
+
+int CMD_CoalStats(char **argv, int argc)
+{
+	VM_ShowStats();
+	return 0;
+}
+
+int CMD_MusicStats(char **argv, int argc)
+{
+	S_ShowMusicStats();
+	return 0;
+}
+
+int CMD_BlockBench(char **argv, int argc)
+{
+	P_BenchmarkBlockMap();
+	return 0;
+}
+
+int CMD_TickBench(char **argv, int argc)
+{
+	int count = 10000;
+	int tics  = 35;
+
+	const char *type_name = "IMP";
+
+	if (argc >= 2)
+		count = atoi(argv[1]);
+
+	if (argc >= 3)
+		tics = atoi(argv[2]);
+
+	if (argc >= 4)
+		type_name = argv[3];
+
+	P_BenchmarkTics(count, tics, type_name);
+	return 0;
+}
+
+int CMD_SimdTest(char **argv, int argc)
+{
+	P_SimdSelfTest();
+	return 0;
+}
+
 int CMD_ResetVars(char **argv, int argc)
 {
 	CON_ResetAllVars();
@@ -834,6 +888,9 @@ static void KillArgs(char **argv, int argc)
 const con_cmd_t builtin_commands[] =
 {
 	{ "args",           CMD_ArgList },
+	{ "audiostats",     CMD_AudioStats },
+	{ "blockbench",     CMD_BlockBench },
+	{ "coalstats",      CMD_CoalStats },
 	{ "crc",            CMD_Crc },
 	{ "dir",            CMD_Dir },
 	{ "exec",           CMD_Exec },
@@ -841,6 +898,7 @@ const con_cmd_t builtin_commands[] =
 	{ "map",            CMD_Map },
 	{ "warp",           CMD_Map },  // compatibility
 	{ "playsound",      CMD_PlaySound },
+	{ "musicstats",     CMD_MusicStats },
 //	{ "resetkeys",      CMD_ResetKeys },
 	{ "resetvars",      CMD_ResetVars },
 	{ "showfiles",      CMD_ShowFiles },
@@ -849,6 +907,8 @@ const con_cmd_t builtin_commands[] =
 	{ "showlumps",      CMD_ShowLumps },
 	{ "showcmds",       CMD_ShowCmds },
 	{ "showvars",       CMD_ShowVars },
+	{ "simdtest",       CMD_SimdTest },
+	{ "tickbench",      CMD_TickBench },
 	{ "screenshot",     CMD_ScreenShot },
 	{ "type",           CMD_Type },
 	{ "version",        CMD_Version },
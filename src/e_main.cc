@@ -2386,6 +2386,8 @@ void E_Tick(void)
 		S_SoundTicker();
 		S_MusicTicker(); // -ACB- 1999/11/13 Improved music update routines
 
+		I_SoundTicker();
+
 		N_NetUpdate(true);  // check for new console commands
 	}
 }
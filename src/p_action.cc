@@ -392,7 +392,7 @@ void P_ActMakeIntoCorpse(mobj_t * mo)
 	// object is on ground, it can be walked over
 	mo->flags &= ~MF_SOLID;
 
-	mo->tag = 0;
+	mo->cold->tag = 0;
 }
 
 
@@ -410,7 +410,7 @@ void P_BringCorpseToLife(mobj_t * corpse)
 	corpse->extendedflags = info->extendedflags;
 	corpse->hyperflags = info->hyperflags;
 	corpse->vis_target = PERCENT_2_FLOAT(info->translucency);
-	corpse->tag = corpse->spawnpoint.tag;
+	corpse->cold->tag = corpse->cold->spawnpoint.tag;
 
 	if (corpse->player)
 	{
@@ -563,12 +563,12 @@ void P_ActDLightSet(mobj_t * mo)
 
 	if (st && st->action_par)
 	{
-		mo->dlight.r = MAX(0.0f, ((int *)st->action_par)[0]);
+		mo->cold->dlight.r = MAX(0.0f, ((int *)st->action_par)[0]);
 
 		if (mo->info->hyperflags & HF_QUADRATIC_COMPAT)
-			mo->dlight.r = DLIT_COMPAT_RAD(mo->dlight.r);
+			mo->cold->dlight.r = DLIT_COMPAT_RAD(mo->cold->dlight.r);
 
-		mo->dlight.target = mo->dlight.r;
+		mo->cold->dlight.target = mo->cold->dlight.r;
 	}
 }
 
@@ -579,10 +579,10 @@ void P_ActDLightFade(mobj_t * mo)
 
 	if (st && st->action_par)
 	{
-		mo->dlight.target = MAX(0.0f, ((int *)st->action_par)[0]);
+		mo->cold->dlight.target = MAX(0.0f, ((int *)st->action_par)[0]);
 
 		if (mo->info->hyperflags & HF_QUADRATIC_COMPAT)
-			mo->dlight.target = DLIT_COMPAT_RAD(mo->dlight.target);
+			mo->cold->dlight.target = DLIT_COMPAT_RAD(mo->cold->dlight.target);
 	}
 }
 
@@ -602,8 +602,8 @@ void P_ActDLightRandom(mobj_t * mo)
 		if (mo->info->hyperflags & HF_QUADRATIC_COMPAT)
 			qty = DLIT_COMPAT_RAD(qty);
 
-		mo->dlight.r = MAX(0.0f, qty);
-		mo->dlight.target = mo->dlight.r;
+		mo->cold->dlight.r = MAX(0.0f, qty);
+		mo->cold->dlight.target = mo->cold->dlight.r;
 	}
 }
 
@@ -613,7 +613,7 @@ void P_ActDLightColour(struct mobj_s *mo)
 
 	if (st && st->action_par)
 	{
-		mo->dlight.color = ((rgbcol_t*) st->action_par)[0];
+		mo->cold->dlight.color = ((rgbcol_t*) st->action_par)[0];
 	}
 }
 
@@ -629,7 +629,7 @@ void P_ActSetSkin(mobj_t * mo)
 			I_Error("Thing [%s]: Bad skin number %d in SET_SKIN action.\n",
 					mo->info->name.c_str(), skin);
 
-		mo->model_skin = skin;
+		mo->cold->model_skin = skin;
 	}
 }
 
@@ -1372,11 +1372,11 @@ int P_MissileContact(mobj_t * object, mobj_t * target)
 		// this hash is very basic, but should work OK
 		u32_t hash = (u32_t)(intptr_t)target;
 
-		if (object->tunnel_hash[0] == hash || object->tunnel_hash[1] == hash)
+		if (object->cold->tunnel_hash[0] == hash || object->cold->tunnel_hash[1] == hash)
 			return -1;
 
-		object->tunnel_hash[0] = object->tunnel_hash[1];
-		object->tunnel_hash[1] = hash;
+		object->cold->tunnel_hash[0] = object->cold->tunnel_hash[1];
+		object->cold->tunnel_hash[1] = hash;
 	}
 
 	// Berserk handling
@@ -1795,6 +1795,10 @@ static void ShotAttack(mobj_t * mo)
 	objangle -= attack->angle_offset;
 	objslope += attack->slope_offset;
 
+	// pellets all come from the same spot, so trace them as a batch
+	if (attack->count > 1)
+		P_LineAttackBatchBegin(mo);
+
 	for (int i = 0; i < attack->count; i++)
 	{
 		angle_t angle = objangle;
@@ -1819,6 +1823,9 @@ static void ShotAttack(mobj_t * mo)
 		P_LineAttack(mo, angle, range, slope, damage,
 					 &attack->damage, attack->puff);
 	}
+
+	if (attack->count > 1)
+		P_LineAttackBatchEnd();
 }
 
 // -KM- 1998/11/25 BFG Spray attack.  Must be used from missiles.
@@ -2447,13 +2454,13 @@ void P_ActDropItem(mobj_t * mo)
 	item->angle = mo->angle;
 
 	// allow respawning
-	item->spawnpoint.x = item->x;
-	item->spawnpoint.y = item->y;
-	item->spawnpoint.z = item->z;
-	item->spawnpoint.angle = item->angle;
-	item->spawnpoint.vertangle = item->vertangle;
-	item->spawnpoint.info  = info;
-	item->spawnpoint.flags = 0;
+	item->cold->spawnpoint.x = item->x;
+	item->cold->spawnpoint.y = item->y;
+	item->cold->spawnpoint.z = item->z;
+	item->cold->spawnpoint.angle = item->angle;
+	item->cold->spawnpoint.vertangle = item->vertangle;
+	item->cold->spawnpoint.info  = info;
+	item->cold->spawnpoint.flags = 0;
 }
 
 void P_ActSpawn(mobj_t * mo)
@@ -2481,7 +2488,7 @@ void P_ActPathCheck(mobj_t * mo)
 	// Checks if the creature is a path follower, and if so enters the
 	// meander states.
 
-	if (! mo->path_trigger || ! mo->info->meander_state)
+	if (! mo->cold->path_trigger || ! mo->info->meander_state)
 		return;
 
 	P_SetMobjStateDeferred(mo, mo->info->meander_state, 0);
@@ -2496,13 +2503,13 @@ void P_ActPathFollow(mobj_t * mo)
 	// For path-following creatures (spawned via RTS), makes the creature
 	// follow the path by trying to get to the next node.
 
-	if (!mo->path_trigger)
+	if (!mo->cold->path_trigger)
 		return;
 
 	if (RAD_CheckReachedTrigger(mo))
 	{
 		// reached the very last one ?
-		if (!mo->path_trigger)
+		if (!mo->cold->path_trigger)
 		{
 			mo->movedir = DI_NODIR;
 			return;
@@ -2512,8 +2519,8 @@ void P_ActPathFollow(mobj_t * mo)
 		return;
 	}
 
-	float dx = mo->path_trigger->x - mo->x;
-	float dy = mo->path_trigger->y - mo->y;
+	float dx = mo->cold->path_trigger->x - mo->x;
+	float dy = mo->cold->path_trigger->y - mo->y;
 
 	angle_t diff = R_PointToAngle(0, 0, dx, dy) - mo->angle;
 
@@ -3410,7 +3417,7 @@ void P_ActCheckActivity(mobj_t *mo)
 	if (pl->swimming)
 	{
 		// enter the SWIM states (if present)
-		statenum_t swim_st = P_MobjFindLabel(pl->mo, "SWIM");
+		statenum_t swim_st = P_MobjFindLabelID(pl->mo, SLAB_SWIM);
 
 		if (swim_st == S_NULL)
 			swim_st = pl->mo->info->chase_state;
@@ -3424,7 +3431,7 @@ void P_ActCheckActivity(mobj_t *mo)
 	if (pl->powers[PW_Jetpack] > 0)
 	{
 		// enter the FLY states (if present)
-		statenum_t fly_st = P_MobjFindLabel(pl->mo, "FLY");
+		statenum_t fly_st = P_MobjFindLabelID(pl->mo, SLAB_FLY);
 
 		if (fly_st != S_NULL)
 			P_SetMobjStateDeferred(pl->mo, fly_st, 0);
@@ -3435,7 +3442,7 @@ void P_ActCheckActivity(mobj_t *mo)
 	if (mo->on_ladder >= 0)
 	{
 		// enter the CLIMB states (if present)
-		statenum_t climb_st = P_MobjFindLabel(pl->mo, "CLIMB");
+		statenum_t climb_st = P_MobjFindLabelID(pl->mo, SLAB_CLIMB);
 
 		if (climb_st != S_NULL)
 			P_SetMobjStateDeferred(pl->mo, climb_st, 0);
@@ -3518,6 +3525,9 @@ void P_ActBecome(struct mobj_s *mo)
 
 	// DO THE DEED !!
 
+	// an RTS ONDEATH check may be waiting for the old type
+	RAD_MonsterIsRemoved(mo);
+
 	P_UnsetThingPosition(mo);
 	{
 		mo->info = become->info;
@@ -3534,8 +3544,8 @@ void P_ActBecome(struct mobj_s *mo)
 
 		mo->vis_target    = PERCENT_2_FLOAT(mo->info->translucency);
 		mo->currentattack = NULL;
-		mo->model_skin    = mo->info->model_skin;
-		mo->model_last_frame = -1;
+		mo->cold->model_skin = mo->info->model_skin;
+		mo->cold->model_last_frame = -1;
 
 		// handle dynamic lights
 		{
@@ -3543,21 +3553,21 @@ void P_ActBecome(struct mobj_s *mo)
 
 			if (dinfo->type != DLITE_None)
 			{
-				mo->dlight.target = dinfo->radius;
-				mo->dlight.color  = dinfo->colour;
+				mo->cold->dlight.target = dinfo->radius;
+				mo->cold->dlight.color  = dinfo->colour;
 
 				// make renderer re-create shader info
-				if (mo->dlight.shader)
+				if (mo->cold->dlight.shader)
 				{
 					// FIXME: delete mo->dlight.shader;
-					mo->dlight.shader = NULL;
+					mo->cold->dlight.shader = NULL;
 				}
 			}
 		}
 	}
 	P_SetThingPosition(mo);
 
-	statenum_t state = P_MobjFindLabel(mo, become->start.label.c_str());
+	statenum_t state = P_MobjFindLabelID(mo, become->start.label_id);
 	if (state == S_NULL)
 		I_Error("BECOME action: frame '%s' in [%s] not found!\n",
 				become->start.label.c_str(), mo->info->name.c_str());
@@ -28,6 +28,7 @@
 
 #include <float.h>
 
+#include <list>
 #include <vector>
 #include <algorithm>
 
@@ -36,6 +37,7 @@
 #include "dm_state.h"
 #include "m_bbox.h"
 #include "p_local.h"
+#include "p_simd.h"
 #include "p_spec.h"
 #include "r_shader.h"
 #include "r_state.h"
@@ -66,13 +68,28 @@ int bmap_height;  // size in mapblocks
 float bmap_orgx;
 float bmap_orgy;
 
-typedef std::list<line_t *> linedef_set_t;
+// The lines in each block are stored in one array, block after
+// block: the lines of block N are entries bmap_offsets[N] up to
+// bmap_offsets[N+1]-1.  The bounding box of each entry is kept in
+// separate arrays, so that lines can be rejected without reading the
+// line_t at all.
+static int *bmap_offsets = NULL;
 
-static linedef_set_t **bmap_lines = NULL;
+static line_t **bmap_lines = NULL;
+
+static float *bmap_left   = NULL;
+static float *bmap_right  = NULL;
+static float *bmap_bottom = NULL;
+static float *bmap_top    = NULL;
+
+static int bmap_total_lines = 0;
 
 // for thing chains
 mobj_t **bmap_things = NULL;
 
+// largest radius of any thing linked into the blockmap this level
+float bmap_max_radius = 0;
+
 // for dynamic lights
 int dlmap_width;
 int dlmap_height;
@@ -80,10 +97,39 @@ int dlmap_height;
 mobj_t **dlmap_things = NULL;
 
 
+//
+// Besides the touch list, each sector keeps the things touching it in
+// a compact array, which P_SectorThingsIterator() walks.  Nodes which
+// get unlinked leave a hole, and the holes are squeezed out when a
+// node is added, unless the array is being walked at the time.
+//
+typedef struct
+{
+	mobj_t *mo;
+	touch_node_t *tn;
+}
+sector_thing_t;
+
+static std::vector< std::vector<sector_thing_t> > sector_things;
+static std::vector<int> sector_holes;
+
+// walks in progress on this thread.  Things are only linked and
+// unlinked on the main thread, while sector moves on the worker
+// threads may walk the arrays (see P_RunActivePlanes).
+static thread_local int sector_things_walking;
+
+
 void P_CreateThingBlockMap(void)
 {
+	sector_things.clear();
+	sector_things.resize(numsectors);
+
+	sector_holes.assign(numsectors, 0);
+
 	bmap_things  = new mobj_t* [bmap_width * bmap_height];
 
+	bmap_max_radius = 0;
+
 	Z_Clear(bmap_things,  mobj_t*, bmap_width * bmap_height);
 
 	// compute size of dynamic light blockmap
@@ -100,9 +146,20 @@ void P_CreateThingBlockMap(void)
 
 void P_DestroyBlockMap(void)
 {
-	delete[] bmap_lines;    bmap_lines  = NULL;
+	delete[] bmap_offsets;  bmap_offsets = NULL;
+	delete[] bmap_lines;    bmap_lines   = NULL;
+	delete[] bmap_left;     bmap_left    = NULL;
+	delete[] bmap_right;    bmap_right   = NULL;
+	delete[] bmap_bottom;   bmap_bottom  = NULL;
+	delete[] bmap_top;      bmap_top     = NULL;
+
+	bmap_total_lines = 0;
+
 	delete[] bmap_things;   bmap_things = NULL;
 
+	sector_things.clear();
+	sector_holes.clear();
+
 	delete[] dlmap_things;  dlmap_things = NULL;
 }
 
@@ -125,6 +182,9 @@ int touchstat_free;
 // FIXME: incorporate into FlushCaches
 touch_node_t *free_touch_nodes;
 
+// nodes are allocated this many at a time
+#define TOUCH_NODE_BLOCK  256
+
 static inline touch_node_t *TouchNodeAlloc(void)
 {
 	touch_node_t *tn;
@@ -140,7 +200,16 @@ static inline touch_node_t *TouchNodeAlloc(void)
 	}
 	else
 	{
-		tn = Z_New(touch_node_t, 1);
+		touch_node_t *block = Z_New(touch_node_t, TOUCH_NODE_BLOCK);
+
+		// keep the first one, the rest go into the quick-alloc list
+		for (int i = TOUCH_NODE_BLOCK - 1; i > 0; i--)
+		{
+			block[i].mo_next = free_touch_nodes;
+			free_touch_nodes = &block[i];
+		}
+
+		tn = &block[0];
 	}
 
 	return tn;
@@ -157,6 +226,28 @@ static inline void TouchNodeFree(touch_node_t *tn)
 	free_touch_nodes = tn;
 }
 
+static void CompactSectorThings(int secnum)
+{
+	std::vector<sector_thing_t>& list = sector_things[secnum];
+
+	int count = 0;
+
+	for (int i = 0; i < (int)list.size(); i++)
+	{
+		if (! list[i].mo)
+			continue;
+
+		list[count] = list[i];
+		list[count].tn->sec_index = count;
+
+		count++;
+	}
+
+	list.resize(count);
+
+	sector_holes[secnum] = 0;
+}
+
 static inline void TouchNodeLinkIntoSector(touch_node_t *tn, sector_t *sec)
 {
 	tn->sec = sec;
@@ -168,6 +259,25 @@ static inline void TouchNodeLinkIntoSector(touch_node_t *tn, sector_t *sec)
 		tn->sec_next->sec_prev = tn;
 
 	sec->touch_things = tn;
+
+	int secnum = sec - sectors;
+
+	std::vector<sector_thing_t>& list = sector_things[secnum];
+
+	if (sector_holes[secnum] > 4 && sector_holes[secnum] * 2 > (int)list.size() &&
+		sector_things_walking == 0)
+	{
+		CompactSectorThings(secnum);
+	}
+
+	sector_thing_t entry;
+
+	entry.mo = tn->mo;
+	entry.tn = tn;
+
+	tn->sec_index = (int)list.size();
+
+	list.push_back(entry);
 }
 
 static inline void TouchNodeLinkIntoThing(touch_node_t *tn, mobj_t *mo)
@@ -192,6 +302,21 @@ static inline void TouchNodeUnlinkFromSector(touch_node_t *tn)
 		tn->sec_prev->sec_next = tn->sec_next;
 	else
 		tn->sec->touch_things = tn->sec_next;
+
+	// nodes left over from a previous level are not in any array
+	int secnum = tn->sec - sectors;
+
+	if (secnum < 0 || secnum >= (int)sector_things.size())
+		return;
+
+	std::vector<sector_thing_t>& list = sector_things[secnum];
+
+	if (tn->sec_index < (int)list.size() && list[tn->sec_index].tn == tn &&
+		list[tn->sec_index].mo)
+	{
+		list[tn->sec_index].mo = NULL;
+		sector_holes[secnum]++;
+	}
 }
 
 static inline void TouchNodeUnlinkFromThing(touch_node_t *tn)
@@ -636,6 +761,8 @@ void P_SetThingPosition(mobj_t * mo)
 				(bmap_things[bnum])->bprev = mo;
 
 			bmap_things[bnum] = mo;
+
+			bmap_max_radius = MAX(bmap_max_radius, mo->radius);
 		}
 		else
 		{
@@ -712,6 +839,49 @@ void P_FreeSectorTouchNodes(sector_t *sec)
 
 	for (tn = sec->touch_things; tn; tn = tn->sec_next)
 		TouchNodeFree(tn);
+
+	if (! sector_things.empty())
+	{
+		sector_things[sec - sectors].clear();
+		sector_holes[sec - sectors] = 0;
+	}
+}
+
+//
+// P_SectorThingsIterator
+//
+// Calls the function for each thing touching the sector, in the same
+// order as the sector's touch list (newest first).  The function may
+// remove things or spawn new ones: removed things are skipped, and new
+// ones are not visited.  Returns false if the function did.
+//
+bool P_SectorThingsIterator(sector_t *sec,
+		                    bool (* func)(mobj_t *, void *), void *data)
+{
+	std::vector<sector_thing_t>& list = sector_things[sec - sectors];
+
+	bool result = true;
+
+	sector_things_walking++;
+
+	// the array may grow (and move) while walking it
+	for (int i = (int)list.size() - 1; i >= 0; i--)
+	{
+		mobj_t *mo = list[i].mo;
+
+		if (! mo)
+			continue;
+
+		if (! func(mo, data))
+		{
+			result = false;
+			break;
+		}
+	}
+
+	sector_things_walking--;
+
+	return result;
 }
 
 
@@ -726,19 +896,41 @@ void P_FreeSectorTouchNodes(sector_t *sec)
 // exit with false without checking anything else.
 //
 
+// lines already checked by the current query of each kind (a line
+// can be in several mapblocks).
+static thread_local line_visit_c blockline_visit;
+static thread_local line_visit_c path_visit;
+
+
+void line_visit_c::Begin()
+{
+	if ((int)marks.size() != numlines)
+	{
+		marks.assign(numlines, 0);
+		generation = 0;
+	}
+
+	generation++;
+
+	// wrapped around?  Old marks could match again.
+	if (generation == 0)
+	{
+		std::fill(marks.begin(), marks.end(), 0);
+		generation = 1;
+	}
+}
+
+
 //
 // P_BlockLinesIterator
 //
-// The validcount flags are used to avoid checking lines
-// that are marked in multiple mapblocks,
-// so increment validcount before the first call
-// to P_BlockLinesIterator, then make one or more calls
-// to it.
+// Calls the function for each line touching the given box, once per
+// line even when it lies in several mapblocks.
 //
 bool P_BlockLinesIterator(float x1, float y1, float x2, float y2,
 		                  bool(* func)(line_t *, void *), void *data)
 {
-	validcount++;
+	blockline_visit.Begin();
 
 	int lx = BLOCKMAP_GET_X(x1);
 	int ly = BLOCKMAP_GET_Y(y1);
@@ -751,23 +943,27 @@ bool P_BlockLinesIterator(float x1, float y1, float x2, float y2,
 	for (int by = ly; by <= hy; by++)
 	for (int bx = lx; bx <= hx; bx++)
 	{
-		linedef_set_t *lset = bmap_lines[by * bmap_width + bx];
+		int bnum = by * bmap_width + bx;
 
-		if (! lset)
-			continue;
+		int first = bmap_offsets[bnum];
+		int last  = bmap_offsets[bnum + 1];
 
-		linedef_set_t::iterator LI;
-		for (LI = lset->begin(); LI != lset->end(); LI++)
+		for (int i = first; i < last; i++)
 		{
-			line_t *ld = *LI;
+			// check whether line touches the given bbox
+			if (bmap_right[i] <= x1 || bmap_left[i]   >= x2 ||
+				bmap_top[i]   <= y1 || bmap_bottom[i] >= y2)
+			{
+				continue;
+			}
+
+			line_t *ld = bmap_lines[i];
 
 			// has line already been checked ?
-			if (ld->validcount == validcount)
+			if (! blockline_visit.Visit(ld))
 				continue;
 
-			ld->validcount = validcount;
-
-			// check whether line touches the given bbox
+			// lines of polyobjects can move (see P_BlockmapMovingLine)
 			if (ld->bbox[BOXRIGHT] <= x1 || ld->bbox[BOXLEFT]   >= x2 ||
 				ld->bbox[BOXTOP]   <= y1 || ld->bbox[BOXBOTTOM] >= y2)
 			{
@@ -784,6 +980,99 @@ bool P_BlockLinesIterator(float x1, float y1, float x2, float y2,
 }
 
 
+static thread_local std::vector<int>      box_touching;
+static thread_local std::vector<line_t *> box_lines;
+static thread_local std::vector<int>      box_sides;
+
+//
+// P_BoxCrossingLinesIterator
+//
+// Like P_BlockLinesIterator() for the given box, but the function is
+// only called for lines which actually cross it (where P_BoxOnLineSide
+// gives -1).  The candidate lines from all the mapblocks are gathered
+// first, then tested several at a time.
+//
+bool P_BoxCrossingLinesIterator(const float *bbox,
+		                        bool (* func)(line_t *, void *), void *data)
+{
+	blockline_visit.Begin();
+
+	box_lines.clear();
+
+	float x1 = bbox[BOXLEFT];
+	float y1 = bbox[BOXBOTTOM];
+	float x2 = bbox[BOXRIGHT];
+	float y2 = bbox[BOXTOP];
+
+	int lx = BLOCKMAP_GET_X(x1);
+	int ly = BLOCKMAP_GET_Y(y1);
+	int hx = BLOCKMAP_GET_X(x2);
+	int hy = BLOCKMAP_GET_Y(y2);
+
+	lx = MAX(0, lx);  hx = MIN(bmap_width-1,  hx);
+	ly = MAX(0, ly);  hy = MIN(bmap_height-1, hy);
+
+	for (int by = ly; by <= hy; by++)
+	for (int bx = lx; bx <= hx; bx++)
+	{
+		int bnum = by * bmap_width + bx;
+
+		int first = bmap_offsets[bnum];
+		int total = bmap_offsets[bnum + 1] - first;
+
+		if (total == 0)
+			continue;
+
+		if ((int)box_touching.size() < total)
+			box_touching.resize(total);
+
+		int num = P_LinesTouchingBox(bmap_left + first, bmap_right + first,
+					bmap_bottom + first, bmap_top + first, total,
+					x1, y1, x2, y2, &box_touching[0]);
+
+		for (int k = 0; k < num; k++)
+		{
+			line_t *ld = bmap_lines[first + box_touching[k]];
+
+			// has line already been checked ?
+			if (! blockline_visit.Visit(ld))
+				continue;
+
+			// lines of polyobjects can move (see P_BlockmapMovingLine)
+			if (ld->bbox[BOXRIGHT] <= x1 || ld->bbox[BOXLEFT]   >= x2 ||
+				ld->bbox[BOXTOP]   <= y1 || ld->bbox[BOXBOTTOM] >= y2)
+			{
+				continue;
+			}
+
+			box_lines.push_back(ld);
+		}
+	}
+
+	int count = (int)box_lines.size();
+
+	if (count == 0)
+		return true;
+
+	if ((int)box_sides.size() < count)
+		box_sides.resize(count);
+
+	P_BoxOnLinesSide(bbox, &box_lines[0], count, &box_sides[0]);
+
+	for (int k = 0; k < count; k++)
+	{
+		if (box_sides[k] != -1)
+			continue;
+
+		if (! func(box_lines[k], data))
+			return false;
+	}
+
+	// everything was checked
+	return true;
+}
+
+
 bool P_BlockThingsIterator(float x1, float y1, float x2, float y2,
 		                   bool (*func)(mobj_t *, void*), void *data)
 {
@@ -840,11 +1129,11 @@ void P_DynamicLightIterator(float x1, float y1, float z1,
 			SYS_ASSERT(mo->state);
 
 			// skip "off" lights
-			if (mo->state->bright <= 0 || mo->dlight.r <= 0)
+			if (mo->state->bright <= 0 || mo->cold->dlight.r <= 0)
 				continue;
 
 			// check whether radius touches the given bbox
-			float r = mo->dlight.r;
+			float r = mo->cold->dlight.r;
 
 			if (mo->x + r <= x1 || mo->x - r >= x2 ||
 			    mo->y + r <= y1 || mo->y - r >= y2 ||
@@ -852,8 +1141,8 @@ void P_DynamicLightIterator(float x1, float y1, float z1,
 				continue;
 			
 			// create shader if necessary
-			if (! mo->dlight.shader)
-				  mo->dlight.shader = MakeDLightShader(mo);
+			if (! mo->cold->dlight.shader)
+				  mo->cold->dlight.shader = MakeDLightShader(mo);
 
 //			mo->dlight.shader->CheckReset();
 
@@ -873,11 +1162,11 @@ void P_SectorGlowIterator(sector_t *sec,
 		SYS_ASSERT(mo->state);
 
 		// skip "off" lights
-		if (mo->state->bright <= 0 || mo->dlight.r <= 0)
+		if (mo->state->bright <= 0 || mo->cold->dlight.r <= 0)
 			continue;
 
 		// check whether radius touches the given bbox
-		float r = mo->dlight.r;
+		float r = mo->cold->dlight.r;
 
 		if (mo->info->glow_type == GLOW_Floor && sec->f_h + r <= z1)
 			continue;
@@ -886,8 +1175,8 @@ void P_SectorGlowIterator(sector_t *sec,
 			continue;
 		
 		// create shader if necessary
-		if (! mo->dlight.shader)
-			  mo->dlight.shader = MakePlaneGlow(mo);
+		if (! mo->cold->dlight.shader)
+			  mo->cold->dlight.shader = MakePlaneGlow(mo);
 
 //		mo->dlight.shader->CheckReset();
 
@@ -901,9 +1190,10 @@ void P_SectorGlowIterator(sector_t *sec,
 // INTERCEPT ROUTINES
 //
 
-static std::vector<intercept_t> intercepts;
+static thread_local std::vector<intercept_t> intercepts;
+static thread_local std::vector<intercept_t> merge_buf;
 
-divline_t trace;
+thread_local divline_t trace;
 
 
 float P_InterceptVector(divline_t * v2, divline_t * v1)
@@ -922,37 +1212,41 @@ float P_InterceptVector(divline_t * v2, divline_t * v1)
 }
 
 
-static inline void PIT_AddLineIntercept(line_t * ld)
+// Intercepts with equal fracs keep the order they were found in (the
+// sorting is stable), which only depends on the blockmap, so the order
+// is the same in every run.  Note this is not the order of older
+// versions, which used an unstable sort: exact ties may come out
+// differently, so old demos with such hitscans or uses can desync.
+struct Compare_Intercept_pred
 {
-	// Looks for lines in the given block
-	// that intercept the given trace
-	// to add to the intercepts list.
-	//
-	// A line is crossed if its endpoints
-	// are on opposite sides of the trace.
-	// Returns true if earlyout and a solid line hit.
+	inline bool operator() (const intercept_t& A, const intercept_t& B) const
+	{
+		return A.frac < B.frac;
+	}
+};
 
-	// has line already been checked ?
-	if (ld->validcount == validcount)
-		return;
 
-	ld->validcount = validcount;
+static inline void AddLineIntercept(line_t *ld, float lx1, float ly1,
+									float lx2, float ly2, float ldx, float ldy)
+{
+	// A line is crossed if its endpoints
+	// are on opposite sides of the trace.
 
 	int s1;
 	int s2;
 	float frac;
 	divline_t div;
 
-	div.x = ld->v1->x;
-	div.y = ld->v1->y;
-	div.dx = ld->dx;
-	div.dy = ld->dy;
+	div.x = lx1;
+	div.y = ly1;
+	div.dx = ldx;
+	div.dy = ldy;
 
 	// avoid precision problems with two routines
 	if (trace.dx > 16 || trace.dy > 16 || trace.dx < -16 || trace.dy < -16)
 	{
-		s1 = P_PointOnDivlineSide(ld->v1->x, ld->v1->y, &trace);
-		s2 = P_PointOnDivlineSide(ld->v2->x, ld->v2->y, &trace);
+		s1 = P_PointOnDivlineSide(lx1, ly1, &trace);
+		s2 = P_PointOnDivlineSide(lx2, ly2, &trace);
 	}
 	else
 	{
@@ -983,6 +1277,20 @@ static inline void PIT_AddLineIntercept(line_t * ld)
 	intercepts.push_back(in);
 }
 
+static inline void PIT_AddLineIntercept(line_t * ld)
+{
+	// Looks for lines in the given block
+	// that intercept the given trace
+	// to add to the intercepts list.
+
+	// has line already been checked ?
+	if (! path_visit.Visit(ld))
+		return;
+
+	AddLineIntercept(ld, ld->v1->x, ld->v1->y, ld->v2->x, ld->v2->y,
+					 ld->dx, ld->dy);
+}
+
 static inline void PIT_AddThingIntercept(mobj_t * thing)
 {
 	float x1;
@@ -1049,46 +1357,26 @@ static inline void PIT_AddThingIntercept(mobj_t * thing)
 }
 
 
-struct Compare_Intercept_pred
-{
-	inline bool operator() (const intercept_t& A, const intercept_t& B) const
-	{
-		return A.frac < B.frac;
-	}
-};
+// traces never visit more blocks than this
+#define MAX_PATH_BLOCKS  64
 
-//
-// P_PathTraverse
-//
-// Traces a line from x1,y1 to x2,y2,
-// calling the traverser function for each.
-// Returns true if the traverser function returns true
-// for all lines.
-//
-bool P_PathTraverse(float x1, float y1, float x2, float y2, int flags,
-		            bool (* func)(intercept_t *, void *), void *data)
+typedef struct path_block_s
 {
-	validcount++;
-
-	intercepts.clear();
-
-	// don't side exactly on a line
-	if (fmod(x1 - bmap_orgx, BLOCKMAP_UNIT) == 0)
-		x1 += 0.1f;
-
-	if (fmod(y1 - bmap_orgy, BLOCKMAP_UNIT) == 0)
-		y1 += 0.1f;
+	int bnum;
 
-	trace.x = x1;
-	trace.y = y1;
-	trace.dx = x2 - x1;
-	trace.dy = y2 - y1;
+	// lowest frac of any intercept found in this block or a later one
+	float bound;
+}
+path_block_t;
 
-	x1 -= bmap_orgx;
-	y1 -= bmap_orgy;
-	x2 -= bmap_orgx;
-	y2 -= bmap_orgy;
 
+//
+// Finds the mapblocks which the trace passes through, in the order
+// they are reached.  Coordinates are relative to the blockmap origin.
+// Blocks outside of the map are skipped.  Returns the number of blocks.
+//
+static int PathBlocks(float x1, float y1, float x2, float y2, path_block_t *blocks)
+{
 	int bx1 = (int)(x1 / BLOCKMAP_UNIT);
 	int by1 = (int)(y1 / BLOCKMAP_UNIT);
 	int bx2 = (int)(x2 / BLOCKMAP_UNIT);
@@ -1151,38 +1439,20 @@ bool P_PathTraverse(float x1, float y1, float x2, float y2, int flags,
 
 	float xintercept = x1 / BLOCKMAP_UNIT + partial * xstep;
 
+	int total = 0;
+
 	// Step through map blocks.
 	// Count is present to prevent a round off error
 	// from skipping the break.
 	int bx = bx1;
 	int by = by1;
 
-	for (int count = 0; count < 64; count++)
+	for (int count = 0; count < MAX_PATH_BLOCKS; count++)
 	{
 		if (0 <= bx && bx < bmap_width &&
 			0 <= by && by < bmap_height)
 		{
-			if (flags & PT_ADDLINES)
-			{
-				linedef_set_t *lset = bmap_lines[by * bmap_width + bx];
-				
-				if (lset)
-				{
-					linedef_set_t::iterator LI;
-					for (LI = lset->begin(); LI != lset->end(); LI++)
-					{
-						PIT_AddLineIntercept(*LI);
-					}
-				}
-			}
-
-			if (flags & PT_ADDTHINGS)
-			{
-				for (mobj_t *mo = bmap_things[by * bmap_width + bx]; mo; mo = mo->bnext)
-				{
-					PIT_AddThingIntercept(mo);
-				}
-			}
+			blocks[total++].bnum = by * bmap_width + bx;
 		}
 
 		if (bx == bx2 && by == by2)
@@ -1200,43 +1470,533 @@ bool P_PathTraverse(float x1, float y1, float x2, float y2, int flags,
 		}
 	}
 
-	// go through the sorted list
+	return total;
+}
 
-	if (intercepts.size() == 0)
-		return true;
+static inline float SlabEnter(float pos, float delta, float lo, float hi)
+{
+	if (fabs(delta) < 0.0001f)
+		return (lo <= pos && pos <= hi) ? -FLT_MAX : FLT_MAX;
+
+	float t1 = (lo - pos) / delta;
+	float t2 = (hi - pos) / delta;
+
+	return MIN(t1, t2);
+}
+
+//
+// Computes the bound of each block: where the trace first comes
+// within 'margin' of that block or any later one.  Lines cross the
+// trace inside a block containing them, but things can stick out of
+// their block by their radius.
+//
+static void PathBlockBounds(path_block_t *blocks, int count,
+							float x1, float y1, float dx, float dy, float margin)
+{
+	float bound = FLT_MAX;
+
+	for (int k = count - 1; k >= 0; k--)
+	{
+		float lx = (blocks[k].bnum % bmap_width) * BLOCKMAP_UNIT - margin;
+		float ly = (blocks[k].bnum / bmap_width) * BLOCKMAP_UNIT - margin;
+
+		float hx = lx + BLOCKMAP_UNIT + margin * 2;
+		float hy = ly + BLOCKMAP_UNIT + margin * 2;
+
+		float enter = MAX(SlabEnter(x1, dx, lx, hx), SlabEnter(y1, dy, ly, hy));
+
+		bound = MIN(bound, enter);
+
+		blocks[k].bound = bound;
+	}
+}
+
+//
+// Sets up the trace and finds the blocks it passes through.
+//
+static int PathSetup(float x1, float y1, float x2, float y2, int flags,
+					 path_block_t *blocks)
+{
+	// don't side exactly on a line
+	if (fmod(x1 - bmap_orgx, BLOCKMAP_UNIT) == 0)
+		x1 += 0.1f;
+
+	if (fmod(y1 - bmap_orgy, BLOCKMAP_UNIT) == 0)
+		y1 += 0.1f;
+
+	trace.x = x1;
+	trace.y = y1;
+	trace.dx = x2 - x1;
+	trace.dy = y2 - y1;
+
+	x1 -= bmap_orgx;
+	y1 -= bmap_orgy;
+	x2 -= bmap_orgx;
+	y2 -= bmap_orgy;
+
+	int count = PathBlocks(x1, y1, x2, y2, blocks);
+
+	// a thing is linked into the block of its centre, so is crossed
+	// within its radius of that block.  The margin stays at least a
+	// block, as before, for levels without any huge things.
+	float margin = 1.0f;
+
+	if (flags & PT_ADDTHINGS)
+		margin = MAX((float)BLOCKMAP_UNIT, bmap_max_radius + 1.0f);
+
+	PathBlockBounds(blocks, count, x1, y1, x2 - x1, y2 - y1, margin);
 
-	std::sort(intercepts.begin(), intercepts.end(),
-			  Compare_Intercept_pred());
+	return count;
+}
+
+//
+// Called after the intercepts in a block have been added (from
+// 'first' onwards).  They are sorted and merged with the ones still
+// pending, then the ones which nothing found later can come before
+// are passed to the traverser function.
+//
+static bool PathDeliver(size_t& head, size_t first, float bound,
+						bool (* func)(intercept_t *, void *), void *data)
+{
+	Compare_Intercept_pred CMP;
+
+	if (first < intercepts.size())
+	{
+		std::stable_sort(intercepts.begin() + first, intercepts.end(), CMP);
+
+		// usually nothing is pending, or the new ones all come after
+		if (head < first && CMP(intercepts[first], intercepts[first - 1]))
+		{
+			// merge from the end, taking the new ones out of the way.
+			// On ties the pending ones stay first, like a stable sort.
+			merge_buf.assign(intercepts.begin() + first, intercepts.end());
+
+			int i = (int)first - 1;
+			int j = (int)merge_buf.size() - 1;
+			int w = (int)intercepts.size() - 1;
 
-	std::vector<intercept_t>::iterator I;
+			while (j >= 0)
+			{
+				if (i >= (int)head && CMP(merge_buf[j], intercepts[i]))
+					intercepts[w--] = intercepts[i--];
+				else
+					intercepts[w--] = merge_buf[j--];
+			}
+		}
+	}
 
-	for (I = intercepts.begin(); I != intercepts.end(); I++)
+	while (head < intercepts.size() && intercepts[head].frac < bound)
 	{
-		if (! func(& *I, data))
+		intercept_t in = intercepts[head++];
+
+		if (! func(&in, data))
 		{
 			// don't bother going further
 			return false;
 		}
 	}
 
+	return true;
+}
+
+//
+// P_PathTraverse
+//
+// Traces a line from x1,y1 to x2,y2,
+// calling the traverser function for each.
+// Returns true if the traverser function returns true
+// for all lines.
+//
+// The blocks are visited in order along the trace, so when the
+// traverser function stops early the rest of the trace is never
+// looked at.
+//
+bool P_PathTraverse(float x1, float y1, float x2, float y2, int flags,
+		            bool (* func)(intercept_t *, void *), void *data)
+{
+	path_visit.Begin();
+
+	intercepts.clear();
+
+	path_block_t blocks[MAX_PATH_BLOCKS];
+
+	int count = PathSetup(x1, y1, x2, y2, flags, blocks);
+
+	size_t head = 0;
+
+	for (int k = 0; k < count; k++)
+	{
+		int bnum = blocks[k].bnum;
+
+		size_t first = intercepts.size();
+
+		if (flags & PT_ADDLINES)
+		{
+			for (int i = bmap_offsets[bnum]; i < bmap_offsets[bnum + 1]; i++)
+			{
+				PIT_AddLineIntercept(bmap_lines[i]);
+			}
+		}
+
+		if (flags & PT_ADDTHINGS)
+		{
+			for (mobj_t *mo = bmap_things[bnum]; mo; mo = mo->bnext)
+			{
+				PIT_AddThingIntercept(mo);
+			}
+		}
+
+		float bound = (k + 1 < count) ? blocks[k + 1].bound : FLT_MAX;
+
+		if (! PathDeliver(head, first, bound, func, data))
+			return false;
+	}
+
 	// everything was traversed
 	return true;
 }
 
 
+//
+// BATCHED TRACES
+//
+// For a group of traces from the same spot (e.g. the pellets of a
+// shotgun blast), most of the blocks are shared.  The first trace
+// through a block copies the end points of its lines into compact
+// arrays, which the other traces of the batch then use, testing
+// several lines at once (P_LinesCrossingDivline).
+//
+// P_PathBatchTraverse() gives exactly the same results as a
+// P_PathTraverse() call from the batch's start point.  Things are
+// still taken from the blockmap for each trace, since earlier traces
+// may have killed or moved them.
+//
+
+static thread_local std::vector<line_t *> batch_ld;
+static thread_local std::vector<float> batch_lx1, batch_ly1;
+static thread_local std::vector<float> batch_lx2, batch_ly2;
+
+static thread_local std::vector<int> batch_crossing;
+
+// where the lines of each block were copied to, only valid when
+// batch_block_stamp matches batch_stamp.
+static thread_local std::vector<int> batch_block_first;
+static thread_local std::vector<u32_t> batch_block_stamp;
+static thread_local u32_t batch_stamp;
+
+static thread_local int   batch_flags;
+static thread_local float batch_x1, batch_y1;
+
+
+void P_PathBatchBegin(float x1, float y1, int flags)
+{
+	batch_flags = flags;
+
+	batch_x1 = x1;
+	batch_y1 = y1;
+
+	batch_ld.clear();
+	batch_lx1.clear();  batch_ly1.clear();
+	batch_lx2.clear();  batch_ly2.clear();
+
+	int btotal = bmap_width * bmap_height;
+
+	if ((int)batch_block_stamp.size() != btotal)
+	{
+		batch_block_first.assign(btotal, 0);
+		batch_block_stamp.assign(btotal, 0);
+		batch_stamp = 0;
+	}
+
+	batch_stamp++;
+
+	if (batch_stamp == 0)
+	{
+		std::fill(batch_block_stamp.begin(), batch_block_stamp.end(), 0);
+		batch_stamp = 1;
+	}
+}
+
+//
+// Returns the number of lines in a block, and where they are in the
+// batch arrays, copying them there the first time.
+//
+static inline int BatchBlockLines(int bnum, int *first)
+{
+	int total = bmap_offsets[bnum + 1] - bmap_offsets[bnum];
+
+	if (batch_block_stamp[bnum] != batch_stamp)
+	{
+		batch_block_stamp[bnum] = batch_stamp;
+		batch_block_first[bnum] = (int)batch_ld.size();
+
+		for (int i = bmap_offsets[bnum]; i < bmap_offsets[bnum + 1]; i++)
+		{
+			line_t *ld = bmap_lines[i];
+
+			batch_ld.push_back(ld);
+
+			batch_lx1.push_back(ld->v1->x);  batch_ly1.push_back(ld->v1->y);
+			batch_lx2.push_back(ld->v2->x);  batch_ly2.push_back(ld->v2->y);
+		}
+	}
+
+	*first = batch_block_first[bnum];
+
+	return total;
+}
+
+static inline void BatchAddLineIntercepts(int first, int total)
+{
+	// short traces use the lines as the divline, see AddLineIntercept
+	if (! (trace.dx > 16 || trace.dy > 16 || trace.dx < -16 || trace.dy < -16))
+	{
+		for (int i = first; i < first + total; i++)
+		{
+			line_t *ld = batch_ld[i];
+
+			if (path_visit.Visit(ld))
+				AddLineIntercept(ld, batch_lx1[i], batch_ly1[i],
+								 batch_lx2[i], batch_ly2[i], ld->dx, ld->dy);
+		}
+		return;
+	}
+
+	if ((int)batch_crossing.size() < total)
+		batch_crossing.resize(total);
+
+	int num = P_LinesCrossingDivline(&trace,
+				&batch_lx1[first], &batch_ly1[first],
+				&batch_lx2[first], &batch_ly2[first], total, &batch_crossing[0]);
+
+	// lines which don't cross never will, so only the crossing ones
+	// need to be marked as visited.
+	for (int k = 0; k < num; k++)
+	{
+		int i = first + batch_crossing[k];
+
+		line_t *ld = batch_ld[i];
+
+		if (! path_visit.Visit(ld))
+			continue;
+
+		divline_t div;
+
+		div.x  = batch_lx1[i];
+		div.y  = batch_ly1[i];
+		div.dx = ld->dx;
+		div.dy = ld->dy;
+
+		float frac = P_InterceptVector(&trace, &div);
+
+		// out of range?
+		if (frac < 0 || frac > 1)
+			continue;
+
+		intercept_t in;
+
+		in.frac  = frac;
+		in.thing = NULL;
+		in.line  = ld;
+
+		intercepts.push_back(in);
+	}
+}
+
+
+bool P_PathBatchTraverse(float x2, float y2,
+						 bool (* func)(intercept_t *, void *), void *data)
+{
+	path_visit.Begin();
+
+	intercepts.clear();
+
+	path_block_t blocks[MAX_PATH_BLOCKS];
+
+	int count = PathSetup(batch_x1, batch_y1, x2, y2, batch_flags, blocks);
+
+	size_t head = 0;
+
+	for (int k = 0; k < count; k++)
+	{
+		int bnum = blocks[k].bnum;
+
+		size_t first = intercepts.size();
+
+		if (batch_flags & PT_ADDLINES)
+		{
+			int start;
+			int total = BatchBlockLines(bnum, &start);
+
+			if (total > 0)
+				BatchAddLineIntercepts(start, total);
+		}
+
+		if (batch_flags & PT_ADDTHINGS)
+		{
+			for (mobj_t *mo = bmap_things[bnum]; mo; mo = mo->bnext)
+			{
+				PIT_AddThingIntercept(mo);
+			}
+		}
+
+		float bound = (k + 1 < count) ? blocks[k + 1].bound : FLT_MAX;
+
+		if (! PathDeliver(head, first, bound, func, data))
+			return false;
+	}
+
+	return true;
+}
+
+
+//--------------------------------------------------------------------------
+//
+//  BLOCKMAP BENCHMARK
+//
+
+static int bench_hits;
+
+static bool PIT_BenchCountLine(line_t *ld, void *data)
+{
+	bench_hits++;
+	return true;
+}
+
+// the way P_BlockLinesIterator used to work, with a std::list of
+// lines in each block.
+static void BenchListIterator(std::list<line_t *> *blocks,
+							  float x1, float y1, float x2, float y2)
+{
+	blockline_visit.Begin();
+
+	int lx = MAX(0, BLOCKMAP_GET_X(x1));
+	int ly = MAX(0, BLOCKMAP_GET_Y(y1));
+	int hx = MIN(bmap_width-1,  BLOCKMAP_GET_X(x2));
+	int hy = MIN(bmap_height-1, BLOCKMAP_GET_Y(y2));
+
+	for (int by = ly; by <= hy; by++)
+	for (int bx = lx; bx <= hx; bx++)
+	{
+		std::list<line_t *>& lset = blocks[by * bmap_width + bx];
+
+		std::list<line_t *>::iterator LI;
+		for (LI = lset.begin(); LI != lset.end(); LI++)
+		{
+			line_t *ld = *LI;
+
+			if (! blockline_visit.Visit(ld))
+				continue;
+
+			if (ld->bbox[BOXRIGHT] <= x1 || ld->bbox[BOXLEFT]   >= x2 ||
+				ld->bbox[BOXTOP]   <= y1 || ld->bbox[BOXBOTTOM] >= y2)
+			{
+				continue;
+			}
+
+			PIT_BenchCountLine(ld, NULL);
+		}
+	}
+}
+
+//
+// P_BenchmarkBlockMap
+//
+// Times P_BlockLinesIterator against the old blockmap layout, using
+// boxes the size of a player and of a large monster around the middle
+// of every line in the current map (which is where collision checks
+// find most of their work).
+//
+void P_BenchmarkBlockMap(void)
+{
+	if (! bmap_offsets || numlines == 0)
+	{
+		I_Printf("No level loaded.\n");
+		return;
+	}
+
+	const int REPEAT = 10;
+
+	int btotal = bmap_width * bmap_height;
+
+	// rebuild the lists, adding the lines in the original order so the
+	// nodes are spread through memory like they used to be.
+	std::vector< std::list<line_t *> > blocks(btotal);
+	std::vector< std::pair<int, int> > pairs;
+
+	for (int b = 0; b < btotal; b++)
+		for (int i = bmap_offsets[b]; i < bmap_offsets[b + 1]; i++)
+			pairs.push_back(std::make_pair((int)(bmap_lines[i] - lines), b));
+
+	std::stable_sort(pairs.begin(), pairs.end());
+
+	for (int k = 0; k < (int)pairs.size(); k++)
+		blocks[pairs[k].second].push_back(lines + pairs[k].first);
+
+	I_Printf("Blockmap: %dx%d blocks, %d lines, %d entries\n",
+		bmap_width, bmap_height, numlines, bmap_total_lines);
+
+	for (int pass = 0; pass < 2; pass++)
+	{
+		float r = (pass == 0) ? 16.0f : 64.0f;
+
+		u32_t times[2];
+		int   hits[2];
+
+		for (int method = 0; method < 2; method++)
+		{
+			bench_hits = 0;
+
+			u32_t start = I_ReadMicroSeconds();
+
+			for (int rep = 0; rep < REPEAT; rep++)
+			for (int i = 0; i < numlines; i++)
+			{
+				float mx = (lines[i].v1->x + lines[i].v2->x) / 2.0f;
+				float my = (lines[i].v1->y + lines[i].v2->y) / 2.0f;
+
+				if (method == 0)
+					BenchListIterator(&blocks[0], mx - r, my - r, mx + r, my + r);
+				else
+					P_BlockLinesIterator(mx - r, my - r, mx + r, my + r, PIT_BenchCountLine);
+			}
+
+			times[method] = I_ReadMicroSeconds() - start;
+			hits[method]  = bench_hits;
+		}
+
+		I_Printf("  radius %2.0f: list %7.2f ms, flat %7.2f ms (%1.2fx), %d queries, hits %d / %d\n",
+			r, times[0] / 1000.0, times[1] / 1000.0,
+			times[1] ? times[0] / (double)times[1] : 0.0,
+			numlines * REPEAT, hits[0], hits[1]);
+	}
+}
+
+
 //--------------------------------------------------------------------------
 //
 //  BLOCKMAP GENERATION
 //
 
+// next free entry of each block, or NULL while counting the lines
+static int *blk_fill_pos = NULL;
+
 static void BlockAdd(int bnum, line_t *ld)
 {
-	if (! bmap_lines[bnum])
-		bmap_lines[bnum] = new linedef_set_t;
+	if (! blk_fill_pos)
+	{
+		bmap_offsets[bnum + 1] += 1;
+		return;
+	}
 
-	bmap_lines[bnum]->push_back(ld);
+	int i = blk_fill_pos[bnum]++;
 
-	// blk_total_lines++;
+	bmap_lines[i] = ld;
+
+	bmap_left[i]   = ld->bbox[BOXLEFT];
+	bmap_right[i]  = ld->bbox[BOXRIGHT];
+	bmap_bottom[i] = ld->bbox[BOXBOTTOM];
+	bmap_top[i]    = ld->bbox[BOXTOP];
 }
 
 static void BlockAddLine(int line_num)
@@ -1344,18 +2104,59 @@ void P_GenerateBlockMap(int min_x, int min_y, int max_x, int max_y)
 	L_WriteDebug("GenerateBlockmap: BLOCKS %d x %d  TOTAL %d\n",
 		bmap_width, bmap_height, btotal);
 
-	// setup blk_cur_lines array.  Initially all pointers are NULL, when
-	// any lines get added then the dynamic array is created.
+	// first pass: count the lines in each block
 
-	bmap_lines = new linedef_set_t* [btotal];
+	bmap_offsets = new int[btotal + 1];
 
-	Z_Clear(bmap_lines, linedef_set_t *, btotal);
+	Z_Clear(bmap_offsets, int, btotal + 1);
 
-	// process each linedef of the map
 	for (int i=0; i < numlines; i++)
 		BlockAddLine(i);
 
-	// L_WriteDebug("GenerateBlockmap: TOTAL DATA=%d\n", blk_total_lines);
+	for (int b=0; b < btotal; b++)
+		bmap_offsets[b + 1] += bmap_offsets[b];
+
+	bmap_total_lines = bmap_offsets[btotal];
+
+	// second pass: store them
+
+	bmap_lines  = new line_t* [MAX(1, bmap_total_lines)];
+	bmap_left   = new float [MAX(1, bmap_total_lines)];
+	bmap_right  = new float [MAX(1, bmap_total_lines)];
+	bmap_bottom = new float [MAX(1, bmap_total_lines)];
+	bmap_top    = new float [MAX(1, bmap_total_lines)];
+
+	blk_fill_pos = new int[btotal];
+
+	memcpy(blk_fill_pos, bmap_offsets, btotal * sizeof(int));
+
+	for (int i=0; i < numlines; i++)
+		BlockAddLine(i);
+
+	delete[] blk_fill_pos;
+	blk_fill_pos = NULL;
+
+	L_WriteDebug("GenerateBlockmap: TOTAL DATA=%d\n", bmap_total_lines);
+}
+
+//
+// P_BlockmapMovingLine
+//
+// Called for lines which can move (polyobjects).  Their entries get
+// a box covering everything, so the real box in the line is checked.
+//
+void P_BlockmapMovingLine(line_t *ld)
+{
+	for (int i = 0; i < bmap_total_lines; i++)
+	{
+		if (bmap_lines[i] == ld)
+		{
+			bmap_left[i]   = -FLT_MAX;
+			bmap_right[i]  =  FLT_MAX;
+			bmap_bottom[i] = -FLT_MAX;
+			bmap_top[i]    =  FLT_MAX;
+		}
+	}
 }
 
 //--- editor settings ---
@@ -26,6 +26,8 @@
 #ifndef __P_BLOCKMAP_H__
 #define __P_BLOCKMAP_H__
 
+#include <vector>
+
 // #include "../epi/arrays.h"
 
 // mapblocks are used to check movement
@@ -41,6 +43,8 @@ extern int bmap_height;
 extern float bmap_orgx;  // origin of block map
 extern float bmap_orgy;
 
+extern float bmap_max_radius;  // of the things in it
+
 #define BLOCKMAP_GET_X(x)  ((int) ((x) - bmap_orgx) / BLOCKMAP_UNIT)
 #define BLOCKMAP_GET_Y(y)  ((int) ((y) - bmap_orgy) / BLOCKMAP_UNIT)
 
@@ -61,7 +65,40 @@ typedef struct intercept_s
 }
 intercept_t;
 
-extern divline_t trace;
+extern thread_local divline_t trace;
+
+
+// The set of lines already visited by a spatial query.  The marks are
+// indexed by line number and live here rather than in the lines, so
+// queries running on different threads don't write into the map or
+// disturb each other.  Each query starts a new generation instead of
+// clearing the marks.
+class line_visit_c
+{
+private:
+	std::vector<u32_t> marks;
+
+	u32_t generation;
+
+public:
+	line_visit_c() : marks(), generation(0) { }
+	~line_visit_c() { }
+
+	// start a new query (must be called once the level is loaded).
+	void Begin();
+
+	// returns true the first time the line is seen in this query.
+	inline bool Visit(const line_t *ld)
+	{
+		u32_t& m = marks[ld - lines];
+
+		if (m == generation)
+			return false;
+
+		m = generation;
+		return true;
+	}
+};
 
 
 /* FUNCTIONS */
@@ -76,10 +113,19 @@ void P_ChangeThingPosition(mobj_t * mo, float x, float y, float z);
 void P_FreeSectorTouchNodes(sector_t *sec);
 
 void P_GenerateBlockMap(int min_x, int min_y, int max_x, int max_y);
+void P_BlockmapMovingLine(line_t *ld);
+void P_BenchmarkBlockMap(void);
 
 bool P_BlockLinesIterator(float x1, float y1, float x2, float y2,
 		                  bool (* func)(line_t *, void *),
 						  void *data = NULL);
+bool P_BoxCrossingLinesIterator(const float *bbox,
+		                        bool (* func)(line_t *, void *),
+						        void *data = NULL);
+
+bool P_SectorThingsIterator(sector_t *sec,
+		                    bool (* func)(mobj_t *, void *),
+						    void *data = NULL);
 
 bool P_BlockThingsIterator(float x1, float y1, float x2, float y2,
 		                   bool (* func)(mobj_t *, void *),
@@ -102,6 +148,11 @@ bool P_PathTraverse(float x1, float y1, float x2, float y2, int flags,
 		            bool (* func)(intercept_t *, void *),
 					void *data = NULL);
 
+void P_PathBatchBegin(float x1, float y1, int flags);
+bool P_PathBatchTraverse(float x2, float y2,
+		                 bool (* func)(intercept_t *, void *),
+						 void *data = NULL);
+
 
 #endif // __P_BLOCKMAP_H__
 
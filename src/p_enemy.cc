@@ -231,10 +231,10 @@ bool P_Move(mobj_t * actor, bool path)
 	if ((actor->state->flags & SFF_Model) ||
 		(actor->flags & MF_FLOAT))
 	{
-		actor->lerp_num = CLAMP(2, actor->state->tics, 10);
-		actor->lerp_pos = 1;
+		actor->cold->lerp_num = CLAMP(2, actor->state->tics, 10);
+		actor->cold->lerp_pos = 1;
 
-		actor->lerp_from = orig_pos;
+		actor->cold->lerp_from = orig_pos;
 	}
 
 	return true;
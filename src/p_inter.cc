@@ -885,14 +885,14 @@ void P_KillMobj(mobj_t * source, mobj_t * target, const damage_c *damtype,
 
 	if (weak_spot)
 	{
-		state = P_MobjFindLabel(target, "WEAKDEATH");
+		state = P_MobjFindLabelID(target, SLAB_WEAKDEATH);
 		if (state == S_NULL)
 			overkill = true;
 	}
 
 	if (state == S_NULL && overkill && damtype && damtype->overkill.label)
 	{
-		state = P_MobjFindLabel(target, damtype->overkill.label);
+		state = P_MobjFindLabelID(target, damtype->overkill.label_id);
 		if (state != S_NULL)
 			state += damtype->overkill.offset;
 	}
@@ -902,7 +902,7 @@ void P_KillMobj(mobj_t * source, mobj_t * target, const damage_c *damtype,
 
 	if (state == S_NULL && damtype && damtype->death.label)
 	{
-		state = P_MobjFindLabel(target, damtype->death.label);
+		state = P_MobjFindLabelID(target, damtype->death.label_id);
 		if (state != S_NULL)
 			state += damtype->death.offset;
 	}
@@ -1236,11 +1236,11 @@ void P_DamageMobj(mobj_t * target, mobj_t * inflictor, mobj_t * source,
 		statenum_t state = S_NULL;
 
 		if (weak_spot)
-			state = P_MobjFindLabel(target, "WEAKPAIN");
+			state = P_MobjFindLabelID(target, SLAB_WEAKPAIN);
 
 		if (state == S_NULL && damtype && damtype->pain.label)
 		{
-			state = P_MobjFindLabel(target, damtype->pain.label);
+			state = P_MobjFindLabelID(target, damtype->pain.label_id);
 			if (state != S_NULL)
 				state += damtype->pain.offset;
 		}
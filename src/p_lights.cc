@@ -31,22 +31,54 @@
 #include <list>
 #include <vector>
 
+#include "con_var.h"
 #include "dm_defs.h"
 #include "dm_state.h"
 #include "m_random.h"
 #include "p_local.h"
+#include "p_workers.h"
 #include "r_state.h"
 #include "s_sound.h"
 #include "z_zone.h"
 
+// check the threaded light effects, planes and sliders against the
+// serial code (see also P_RunActivePlanes)
+DEF_CVAR(debug_threads, int, "", 0);
+
 std::vector<light_t *> active_lights;
 
+//
+// Returns the random number which DoLight() will need for this light
+// in the current tic, or 0 when it needs none.  Calling this for each
+// light in list order draws the same numbers as the old code did.
+//
+static int LightRandom(const light_t * light)
+{
+	const lightdef_c *type = light->type;
+
+	// only changes when the count runs out
+	if (light->count != 1)
+		return 0;
+
+	switch (type->type)
+	{
+		case LITE_Flash:
+			return M_RandomTest(type->chance) ? 1 : 0;
+
+		case LITE_FireFlicker:
+			return M_Random();
+
+		default:
+			return 0;
+	}
+}
+
 //
 // GENERALISED LIGHT
 //
 // -AJA- 2000/09/20: added FADE type.
 //
-static void DoLight(light_t * light)
+static void DoLight(light_t * light, int rnd)
 {
 	const lightdef_c *type = light->type;
 
@@ -93,7 +125,7 @@ static void DoLight(light_t * light)
 		case LITE_Flash:
 		{
 			// Dark
-			if (M_RandomTest(type->chance))
+			if (rnd)
 			{
 				light->sector->props.lightlevel = light->minlight;
 				light->count = type->darktime;
@@ -157,7 +189,7 @@ static void DoLight(light_t * light)
 		case LITE_FireFlicker:
 		{
 			// -ES- 2000/02/13 Changed this to original DOOM style flicker
-			int amount = (M_Random() & 7) * type->step;
+			int amount = (rnd & 7) * type->step;
 
 			if (light->sector->props.lightlevel - amount < light->minlight)
 			{
@@ -181,49 +213,44 @@ void EV_LightTurnOn(int tag, int bright)
 {
 	/* TURN LINE'S TAG LIGHTS ON */
 
-	for (int i = 0; i < numsectors; i++)
+	for (sector_t *sector = P_FindSectorFromTag(tag); sector; sector = sector->tag_next)
 	{
-		sector_t *sector = sectors + i;
-
-		if (sector->tag == tag)
+		// bright == 0 means to search for highest light level
+		// surrounding sector
+		if (!bright)
 		{
-			// bright == 0 means to search for highest light level
-			// surrounding sector
-			if (!bright)
+			for (int j = 0; j < sector->linecount; j++)
 			{
-				for (int j = 0; j < sector->linecount; j++)
-				{
-					line_t *templine = sector->lines[j];
+				line_t *templine = sector->lines[j];
 
-					sector_t *temp = P_GetNextSector(templine, sector);
+				sector_t *temp = P_GetNextSector(templine, sector);
 
-					if (!temp)
-						continue;
+				if (!temp)
+					continue;
 
-					if (temp->props.lightlevel > bright)
-						bright = temp->props.lightlevel;
-				}
+				if (temp->props.lightlevel > bright)
+					bright = temp->props.lightlevel;
 			}
-			// bright == 1 means to search for lowest light level
-			// surrounding sector
-			if (bright == 1)
+		}
+		// bright == 1 means to search for lowest light level
+		// surrounding sector
+		if (bright == 1)
+		{
+			bright = 255;
+			for (int j = 0; j < sector->linecount; j++)
 			{
-				bright = 255;
-				for (int j = 0; j < sector->linecount; j++)
-				{
-					line_t* templine = sector->lines[j];
+				line_t* templine = sector->lines[j];
 
-					sector_t* temp = P_GetNextSector(templine, sector);
+				sector_t* temp = P_GetNextSector(templine, sector);
 
-					if (!temp)
-						continue;
+				if (!temp)
+					continue;
 
-					if (temp->props.lightlevel < bright)
-						bright = temp->props.lightlevel;
-				}
+				if (temp->props.lightlevel < bright)
+					bright = temp->props.lightlevel;
 			}
-			sector->props.lightlevel = bright;
 		}
+		sector->props.lightlevel = bright;
 	}
 }
 
@@ -307,6 +334,128 @@ bool EV_Lights(sector_t * sec, const lightdef_c * type)
 	return true;
 }
 
+//
+// Threaded lights
+//
+// DoLight() only changes the light itself and the light level of its
+// sector, hence lights in different sectors can run at the same time.
+// The lights are put into groups by sector number (lights sharing a
+// sector always land in the same group, in list order), and the random
+// numbers are drawn beforehand in list order, so the result is exactly
+// the same as running them one by one.
+//
+#define MIN_THREADED_LIGHTS  256
+
+static std::vector<int> light_rnd;
+
+static std::vector< std::vector<light_t *> > light_groups;
+static std::vector< std::vector<int> >       light_group_rnd;
+
+static void RunLightGroup(int group, void *data)
+{
+	std::vector<light_t *>& lights = light_groups[group];
+	std::vector<int>& rnds = light_group_rnd[group];
+
+	for (int i = 0; i < (int)lights.size(); i++)
+		DoLight(lights[i], rnds[i]);
+}
+
+static void CheckLightsThreaded(void)
+{
+	int total = (int)active_lights.size();
+
+	// remember the starting state, so the serial code can run again
+	// from there, and its result (the one which is kept) compared with
+	// what the threads did.
+	std::vector<light_t> before(total);
+	std::vector<int> before_level(total);
+
+	for (int i = 0; i < total; i++)
+	{
+		before[i] = *active_lights[i];
+		before_level[i] = active_lights[i]->sector->props.lightlevel;
+	}
+
+	P_RunJobs((int)light_groups.size(), RunLightGroup, NULL);
+
+	std::vector<light_t> threaded(total);
+	std::vector<int> threaded_level(total);
+
+	for (int i = 0; i < total; i++)
+	{
+		threaded[i] = *active_lights[i];
+		threaded_level[i] = active_lights[i]->sector->props.lightlevel;
+	}
+
+	for (int i = 0; i < total; i++)
+	{
+		*active_lights[i] = before[i];
+		active_lights[i]->sector->props.lightlevel = before_level[i];
+	}
+
+	for (int i = 0; i < total; i++)
+		DoLight(active_lights[i], light_rnd[i]);
+
+	int diffs = 0;
+
+	for (int i = 0; i < total; i++)
+	{
+		light_t *light = active_lights[i];
+
+		if (light->count     != threaded[i].count    ||
+			light->minlight  != threaded[i].minlight ||
+			light->maxlight  != threaded[i].maxlight ||
+			light->direction != threaded[i].direction ||
+			light->sector->props.lightlevel != threaded_level[i])
+		{
+			diffs++;
+		}
+	}
+
+	if (diffs > 0)
+		I_Warning("P_RunLights: %d of %d lights differ from the serial code\n",
+				  diffs, total);
+}
+
+static void RunLightsThreaded(void)
+{
+	int total = (int)active_lights.size();
+
+	// a few groups per thread, to even out the work
+	int groups = P_WorkerThreads() * 4;
+
+	light_groups.resize(groups);
+	light_group_rnd.resize(groups);
+
+	for (int g = 0; g < groups; g++)
+	{
+		light_groups[g].clear();
+		light_group_rnd[g].clear();
+	}
+
+	light_rnd.resize(total);
+
+	for (int i = 0; i < total; i++)
+	{
+		light_t *light = active_lights[i];
+
+		int g = (int)(light->sector - sectors) % groups;
+
+		light_rnd[i] = LightRandom(light);
+
+		light_groups[g].push_back(light);
+		light_group_rnd[g].push_back(light_rnd[i]);
+	}
+
+	if (debug_threads)
+	{
+		CheckLightsThreaded();
+		return;
+	}
+
+	P_RunJobs(groups, RunLightGroup, NULL);
+}
+
 //
 // P_RunLights
 //
@@ -317,11 +466,19 @@ bool EV_Lights(sector_t * sec, const lightdef_c * type)
 //
 void P_RunLights(void)
 {
-	std::vector<light_t *>::iterator LI;
+	int total = (int)active_lights.size();
 
-	for (LI = active_lights.begin(); LI != active_lights.end(); LI++)
+	if (total >= MIN_THREADED_LIGHTS && P_WorkerThreads() >= 2)
 	{
-		DoLight(*LI);
+		RunLightsThreaded();
+		return;
+	}
+
+	for (int i = 0; i < total; i++)
+	{
+		light_t *light = active_lights[i];
+
+		DoLight(light, LightRandom(light));
 	}
 }
 
@@ -138,6 +138,7 @@ extern mobj_t *mobjlisthead;
 
 void P_RemoveMobj(mobj_t * th);
 statenum_t P_MobjFindLabel(mobj_t * mobj, const char *label);
+statenum_t P_MobjFindLabelID(mobj_t * mobj, int label_id);
 bool P_SetMobjState(mobj_t * mobj, statenum_t state);
 bool P_SetMobjStateDeferred(mobj_t * mobj, statenum_t state, int tic_skip);
 void P_SetMobjDirAndSpeed(mobj_t * mobj, angle_t angle, float slope, float speed);
@@ -161,6 +162,8 @@ mobj_t *P_MobjCreateObject(float x, float y, float z, const mobjtype_c * type);
 int P_MobjGetSfxCategory(const mobj_t *mo);
 
 // Needed by savegame code.
+mobj_t *P_MobjAlloc(void);
+void P_AddMobjToList(mobj_t *mo);
 void P_RemoveAllMobjs(void);
 void P_RemoveItemsInQue(void);
 void P_ClearAllStaleRefs(void);
@@ -271,10 +274,10 @@ public:
 extern bool floatok;
 extern float float_destz;
 
-extern bool mobj_hit_sky;
-extern line_t *blockline;
+extern thread_local bool mobj_hit_sky;
+extern thread_local line_t *blockline;
 
-extern linelist_c spechit;
+extern thread_local linelist_c spechit;
 
 extern bool disable_bob;
 
@@ -289,6 +292,20 @@ void P_UpdateMultipleFloors(sector_t * sector);
 bool P_CheckSolidSectorMove(sector_t *sec, bool is_ceiling, float dh);
 bool P_SolidSectorMove(sector_t *sec, bool is_ceiling, float dh, int crush = 10, bool nocarething = false);
 void P_ChangeThingSize(mobj_t *mo);
+
+typedef struct
+{
+	// sector changes which checked their things (by P_SolidSectorMove)
+	// and things checked, in the last tic.  Also the most things
+	// checked in any tic.
+	int moves;
+	int checked;
+	int checked_max;
+}
+crush_stats_t;
+
+void P_CrushStatsTic(void);
+void P_GetCrushStats(crush_stats_t *st);
 bool P_CheckAbsPosition(mobj_t * thing, float x, float y, float z);
 bool P_CheckSight(mobj_t * src, mobj_t * dest);
 bool P_CheckSightToPoint(mobj_t * src, float x, float y, float z);
@@ -300,6 +317,8 @@ bool P_TryMove(mobj_t * thing, float x, float y);
 bool P_SlideMove(mobj_t * mo, float x, float y);
 void P_UseLines(player_t * player);
 void P_LineAttack(mobj_t * t1, angle_t angle, float distance, float slope, float damage, const damage_c * damtype, const mobjtype_c *puff);
+void P_LineAttackBatchBegin(mobj_t * t1);
+void P_LineAttackBatchEnd(void);
 
 
 //
@@ -37,6 +37,7 @@
 //
 
 #include "system/i_defs.h"
+#include "system/i_sdlinc.h"
 
 #include <float.h>
 
@@ -88,15 +89,17 @@ typedef struct try_move_info_s
 }
 try_move_info_t;
 
-static try_move_info_t tm_I;
+// these are per thread, since sector moves (and the things they clip)
+// may run on the playsim worker threads, see P_RunActivePlanes.
+static thread_local try_move_info_t tm_I;
 
 // set to stop weapon bobbing
 bool disable_bob = false;
 float bob_z_scale = 0.5f;
 float bob_r_scale = 0.2f;
 
-bool mobj_hit_sky;
-line_t *blockline;
+thread_local bool mobj_hit_sky;
+thread_local line_t *blockline;
 
 // If "floatok" true, move would be ok if at float_destz.
 bool floatok;
@@ -105,7 +108,7 @@ float float_destz;
 // keep track of special lines as they are hit,
 // but don't process them until the move is proven valid
 
-linelist_c spechit;		// List of special lines that have been hit
+thread_local linelist_c spechit;		// List of special lines that have been hit
 
 typedef struct shoot_trav_info_s
 {
@@ -277,8 +280,7 @@ bool P_TeleportMove(mobj_t * thing, float x, float y, float z)
 
 static bool PIT_CheckAbsLine(line_t * ld, void *data)
 {
-	if (P_BoxOnLineSide(tm_I.bbox, ld) != -1)
-		return true;
+	// only lines crossing tm_I.bbox get here (P_BoxCrossingLinesIterator)
 
 	// The spawning thing's position touches the given line.
 	// If this should not be allowed, return false.
@@ -437,7 +439,7 @@ bool P_CheckAbsPosition(mobj_t * thing, float x, float y, float z)
 
 	// check lines
 
-	if (! P_BlockLinesIterator(x-r, y-r, x+r, y+r, PIT_CheckAbsLine))
+	if (! P_BoxCrossingLinesIterator(tm_I.bbox, PIT_CheckAbsLine))
 		return false;
 
 	return true;
@@ -451,8 +453,7 @@ static bool PIT_CheckRelLine(line_t * ld, void *data)
 {
 	// Adjusts tm_I.floorz & tm_I.ceilnz as lines are contacted
 
-	if (P_BoxOnLineSide(tm_I.bbox, ld) != -1)
-		return true;
+	// only lines crossing tm_I.bbox get here (P_BoxCrossingLinesIterator)
 
 	// A line has been hit
 	//I_Printf("Hit line: %d special %p\n", ld - lines, ld->special);
@@ -636,7 +637,8 @@ static bool PIT_CheckRelThing(mobj_t * thing, void *data)
 		polyobj_t *po = P_GetPolyobject(thing->po_ix);
 		if (po)
 			for (int i=0; i<po->count; i++)
-				if (!PIT_CheckRelLine(po->lines[i], data))
+				if (P_BoxOnLineSide(tm_I.bbox, po->lines[i]) == -1 &&
+					!PIT_CheckRelLine(po->lines[i], data))
 					return false;
 
 		return true;
@@ -838,7 +840,7 @@ static bool P_CheckRelPosition(mobj_t * thing, float x, float y)
 
 	thing->on_ladder = -1;
 
-	if (! P_BlockLinesIterator(x-r, y-r, x+r, y+r, PIT_CheckRelLine))
+	if (! P_BoxCrossingLinesIterator(tm_I.bbox, PIT_CheckRelLine))
 		return false;
 
 	return true;
@@ -1697,6 +1699,30 @@ mobj_t * P_AimLineAttack(mobj_t * t1, angle_t angle, float distance, float *slop
 }
 
 
+//
+// Attacks which fire several pellets at once (shotguns) can bracket
+// their P_LineAttack() calls with these, so that the traces share the
+// work of looking up the lines.  The results are exactly the same.
+//
+static mobj_t *batch_source;
+static float batch_x, batch_y;
+
+void P_LineAttackBatchBegin(mobj_t * t1)
+{
+	batch_source = t1;
+
+	batch_x = t1->x;
+	batch_y = t1->y;
+
+	P_PathBatchBegin(batch_x, batch_y, PT_ADDLINES | PT_ADDTHINGS);
+}
+
+void P_LineAttackBatchEnd(void)
+{
+	batch_source = NULL;
+}
+
+
 void P_LineAttack(mobj_t * t1, angle_t angle, float distance,
 				  float slope, float damage, const damage_c * damtype,
 				  const mobjtype_c *puff)
@@ -1722,8 +1748,12 @@ void P_LineAttack(mobj_t * t1, angle_t angle, float distance,
 	shoot_I.prev_z = shoot_I.start_z;
 	shoot_I.puff = puff;
 
-	P_PathTraverse(t1->x, t1->y, x2, y2, PT_ADDLINES | PT_ADDTHINGS,
-		PTR_ShootTraverse);
+	// the batch is only any good if the shooter hasn't moved
+	if (t1 == batch_source && t1->x == batch_x && t1->y == batch_y)
+		P_PathBatchTraverse(x2, y2, PTR_ShootTraverse);
+	else
+		P_PathTraverse(t1->x, t1->y, x2, y2, PT_ADDLINES | PT_ADDTHINGS,
+			PTR_ShootTraverse);
 }
 
 //
@@ -2095,8 +2125,14 @@ void P_RadiusAttack(mobj_t * spot, mobj_t * source, float radius,
 //  SECTOR HEIGHT CHANGING
 //
 
-static bool nofit;
-static int crush_damage;
+static thread_local bool nofit;
+static thread_local int crush_damage;
+
+static crush_stats_t crush_stats;
+
+// counts for the tic in progress (atomic, see tm_I)
+static SDL_atomic_t crush_moves;
+static SDL_atomic_t crush_checked;
 
 
 static bool PIT_ChangeSector(mobj_t * thing, bool widening)
@@ -2183,35 +2219,57 @@ static bool PIT_ChangeSector(mobj_t * thing, bool widening)
 //
 // NOTE: the heights (f_h, c_h) currently broken.
 //
+static bool PIT_ChangeSectorThing(mobj_t * mo, void *data)
+{
+	bool widening = *(bool *)data;
+
+	SDL_AtomicIncRef(&crush_checked);
+
+#if 0
+	bz = mo->z;
+	tz = mo->z + mo->height;
+
+	// ignore things that are not in the space (e.g. in another
+	// extrafloor).
+	//
+	if (tz < f_h-1 || bz > c_h+1)
+		return true;
+#endif
+
+	PIT_ChangeSector(mo, widening);
+
+	return true;
+}
+
 static void ChangeSectorHeights(sector_t *sec, float f_h,
 								float c_h, float f_dh, float c_dh)
 {
-	touch_node_t *tn, *next;
-	mobj_t *mo;
-
 	bool widening = (f_dh <= 0) && (c_dh >= 0);
 
-	for (tn=sec->touch_things; tn; tn=next)
-	{
-		// allow for thing removal
-		next = tn->sec_next;
+	SDL_AtomicIncRef(&crush_moves);
 
-		mo = tn->mo;
-		SYS_ASSERT(mo);
+	// this allows for thing removal
+	P_SectorThingsIterator(sec, PIT_ChangeSectorThing, &widening);
+}
 
-#if 0
-		bz = mo->z;
-		tz = mo->z + mo->height;
 
-		// ignore things that are not in the space (e.g. in another
-		// extrafloor).
-		//
-		if (tz < f_h-1 || bz > c_h+1)
-			continue;
-#endif
+//
+// P_CrushStatsTic
+//
+// Called at the end of each tic, to make the sector change counts of
+// that tic available to P_GetCrushStats().
+//
+void P_CrushStatsTic(void)
+{
+	crush_stats.moves   = SDL_AtomicSet(&crush_moves,   0);
+	crush_stats.checked = SDL_AtomicSet(&crush_checked, 0);
 
-		PIT_ChangeSector(mo, widening);
-	}
+	crush_stats.checked_max = MAX(crush_stats.checked_max, crush_stats.checked);
+}
+
+void P_GetCrushStats(crush_stats_t *st)
+{
+	*st = crush_stats;
 }
 
 
@@ -2435,23 +2493,18 @@ bool P_SolidSectorMove(sector_t *sec, bool is_ceiling,
 }
 
 
+static bool PIT_ThingHeightClip(mobj_t * mo, void *data)
+{
+	P_ThingHeightClip(mo);
+	return true;
+}
+
 void P_ChangeThingSize(mobj_t *mo)
 {
 	// Re-adjust things in the sector when something changes size.  The
 	// object must be currently linked into the map.
 
-	touch_node_t *tn, *next;
-
-	sector_t *sec = mo->subsector->sector;
-
-	for (tn=sec->touch_things; tn; tn=next)
-	{
-		next = tn->sec_next;
-
-		SYS_ASSERT(tn->mo);
-
-		P_ThingHeightClip(tn->mo);
-	}
+	P_SectorThingsIterator(mo->subsector->sector, PIT_ThingHeightClip);
 }
 
 
@@ -1038,8 +1038,8 @@ bool P_SubsecThingIterator(float *bbox,
 	return TraverseSubsec(root_node, bbox, func);
 }
 
-static float checkempty_bbox[4];
-static line_t *checkempty_line;
+static thread_local float checkempty_bbox[4];
+static thread_local line_t *checkempty_line;
 
 static bool PST_CheckThingArea(mobj_t *mo)
 {
@@ -75,12 +75,14 @@
 #include "r_image.h" //W_ImageGetName
 #include "r_misc.h"
 #include "r_shader.h"
+#include "rad_trig.h"
 #include "s_sound.h"
 #include "z_zone.h"
 
 #include "../epi/arrays.h"
 
 #include <list>
+#include <vector>
 
 #define LADDER_FRICTION  0.5f
 
@@ -118,6 +120,22 @@ mobj_t *mobjlisthead;
 // Where objects go to die...
 static std::list<mobj_t *> remove_queue;
 
+// All the mobjs in the list above, oldest first (i.e. the reverse of
+// the list order), for the loops which visit every mobj each tic.
+// Removed mobjs leave a NULL behind until the array is compacted.
+static std::vector<mobj_t *> live_mobjs;
+static int live_holes = 0;
+
+// Mobjs are allocated in blocks, each mobj starting on a new cache
+// line, and deleted ones are kept for re-use (linked via 'next').
+// The cold part of each mobj is in a separate array of the block.
+#define MOBJ_POOL_BLOCK  256
+#define MOBJ_ALIGN       64
+
+static std::vector<byte *> mobj_pool_blocks;
+static std::vector<mobj_cold_t *> mobj_cold_blocks;
+static mobj_t *mobj_free_list = NULL;
+
 iteminque_t *itemquehead;
 
 
@@ -262,16 +280,16 @@ static bool CorpseShouldSlide(mobj_t * mo)
 static void TeleportRespawn(mobj_t * mobj)
 {
 	float x, y, z, oldradius, oldheight;
-	const mobjtype_c *info = mobj->spawnpoint.info;
+	const mobjtype_c *info = mobj->cold->spawnpoint.info;
 	mobj_t *new_mo;
 	int oldflags;
 
 	if (!info)
 		return;
 
-	x = mobj->spawnpoint.x;
-	y = mobj->spawnpoint.y;
-	z = mobj->spawnpoint.z;
+	x = mobj->cold->spawnpoint.x;
+	y = mobj->cold->spawnpoint.y;
+	z = mobj->cold->spawnpoint.z;
 
 	// something is occupying it's position?
 
@@ -283,8 +301,8 @@ static void TeleportRespawn(mobj_t * mobj)
 	oldheight = mobj->height;
 	oldflags = mobj->flags;
 
-	mobj->radius = mobj->spawnpoint.info->radius;
-	mobj->height = mobj->spawnpoint.info->height;
+	mobj->radius = mobj->cold->spawnpoint.info->radius;
+	mobj->height = mobj->cold->spawnpoint.info->height;
 
 	if (info->flags & MF_SOLID)						// Should it be solid?
 		mobj->flags |= MF_SOLID;
@@ -314,12 +332,12 @@ static void TeleportRespawn(mobj_t * mobj)
 	// -ACB- 1998/08/06 Create Object
 	new_mo = P_MobjCreateObject(x, y, z, info);
 
-	new_mo->spawnpoint = mobj->spawnpoint;
-	new_mo->angle = mobj->spawnpoint.angle;
-	new_mo->vertangle = mobj->spawnpoint.vertangle;
-	new_mo->tag = mobj->spawnpoint.tag;
+	new_mo->cold->spawnpoint = mobj->cold->spawnpoint;
+	new_mo->angle = mobj->cold->spawnpoint.angle;
+	new_mo->vertangle = mobj->cold->spawnpoint.vertangle;
+	new_mo->cold->tag = mobj->cold->spawnpoint.tag;
 
-	if (mobj->spawnpoint.flags & MF_AMBUSH)
+	if (mobj->cold->spawnpoint.flags & MF_AMBUSH)
 		new_mo->flags |= MF_AMBUSH;
 
 	new_mo->reactiontime = RESPAWN_DELAY;
@@ -397,9 +415,9 @@ static void ResurrectRespawn(mobj_t * mobj)
 	mobj->SetSource(NULL);
 	mobj->SetTarget(NULL);
 
-	mobj->tag = mobj->spawnpoint.tag;
+	mobj->cold->tag = mobj->cold->spawnpoint.tag;
 
-	if (mobj->spawnpoint.flags & MF_AMBUSH)
+	if (mobj->cold->spawnpoint.flags & MF_AMBUSH)
 		mobj->flags |= MF_AMBUSH;
 
 	mobj->reactiontime = RESPAWN_DELAY;
@@ -412,15 +430,15 @@ epi::vec3_c mobj_t::GetInterpolatedPosition(void)
 {
 
 	float interp = N_GetInterpolater();
-	epi::vec3_c lastpos(lastticrender.x,lastticrender.y,lastticrender.z);
+	epi::vec3_c lastpos(cold->lastticrender.x,cold->lastticrender.y,cold->lastticrender.z);
 	epi::vec3_c curpos(x,y,z);
 
-	if (lerp_num > 0) {
+	if (cold->lerp_num > 0) {
 		//using interpolated position
-		float along = lerp_pos / (float)lerp_num;
-		curpos.x = lerp_from.x + (x - lerp_from.x) * along;
-		curpos.y = lerp_from.y + (y - lerp_from.y) * along;
-		curpos.z = lerp_from.z + (z - lerp_from.z) * along;
+		float along = cold->lerp_pos / (float)cold->lerp_num;
+		curpos.x = cold->lerp_from.x + (x - cold->lerp_from.x) * along;
+		curpos.y = cold->lerp_from.y + (y - cold->lerp_from.y) * along;
+		curpos.z = cold->lerp_from.z + (z - cold->lerp_from.z) * along;
 	}
 
 	if (interp != 1) {
@@ -466,7 +484,7 @@ float mobj_t::GetInterpolatedAngle(void)
 	//XXX
 	/// Coraline - reverted this as it made player movement more jerky
 	//return angle;
-	return CircularLerp(lastticrender.angle, angle, interp);
+	return CircularLerp(cold->lastticrender.angle, angle, interp);
 }
 
 float mobj_t::GetInterpolatedVertAngle(void)
@@ -474,7 +492,7 @@ float mobj_t::GetInterpolatedVertAngle(void)
 	float interp = N_GetInterpolater();
 	//XXX
 	//return vertangle;
-	return CircularLerp(lastticrender.vertangle, vertangle, interp);
+	return CircularLerp(cold->lastticrender.vertangle, vertangle, interp);
 }
 
 #undef _fma
@@ -483,23 +501,23 @@ float mobj_t::GetInterpolatedVertAngle(void)
 
 void mobj_t::UpdateLastTicRender(void)
 {
-	if (lerp_num <= 0) {
+	if (cold->lerp_num <= 0) {
 		//using absolute position
-		lastticrender.x = x;
-		lastticrender.y = y;
-		lastticrender.z = z;
+		cold->lastticrender.x = x;
+		cold->lastticrender.y = y;
+		cold->lastticrender.z = z;
 	} else {
 		//using interpolated position
-		float along = lerp_pos / (float)lerp_num;
-		lastticrender.x = lerp_from.x + (x - lerp_from.x) * along;
-		lastticrender.y = lerp_from.y + (y - lerp_from.y) * along;
-		lastticrender.z = lerp_from.z + (z - lerp_from.z) * along;
-	}
-	lastticrender.angle = angle;
-	lastticrender.vertangle = vertangle;
-	lastticrender.model_skin = model_skin;
-	lastticrender.model_last_frame = model_last_frame;
-	lastticrender.model_animfile = state->animfile;
+		float along = cold->lerp_pos / (float)cold->lerp_num;
+		cold->lastticrender.x = cold->lerp_from.x + (x - cold->lerp_from.x) * along;
+		cold->lastticrender.y = cold->lerp_from.y + (y - cold->lerp_from.y) * along;
+		cold->lastticrender.z = cold->lerp_from.z + (z - cold->lerp_from.z) * along;
+	}
+	cold->lastticrender.angle = angle;
+	cold->lastticrender.vertangle = vertangle;
+	cold->lastticrender.model_skin = cold->model_skin;
+	cold->lastticrender.model_last_frame = cold->model_last_frame;
+	cold->lastticrender.model_animfile = state->animfile;
 }
 
 void mobj_t::ClearStaleRefs()
@@ -534,9 +552,85 @@ static void DeleteMobj(mobj_t * mo)
 		return;
 	}
 
-	delete mo->dlight.shader;
+	delete mo->cold->dlight.shader;
 
-	Z_Free(mo);
+	mo->next = mobj_free_list;
+	mobj_free_list = mo;
+}
+
+//
+// P_MobjAlloc
+//
+// Returns a cleared mobj from the pool.
+//
+mobj_t *P_MobjAlloc(void)
+{
+	if (! mobj_free_list)
+	{
+		size_t stride = (sizeof(mobj_t) + MOBJ_ALIGN - 1) & ~(size_t)(MOBJ_ALIGN - 1);
+
+		// an even number of cache lines (e.g. 512 bytes) would put the
+		// hot fields of every mobj into the same few cache sets.
+		if ((stride / MOBJ_ALIGN) % 2 == 0)
+			stride += MOBJ_ALIGN;
+
+		byte *block = new byte[stride * MOBJ_POOL_BLOCK + MOBJ_ALIGN];
+		mobj_cold_t *colds = new mobj_cold_t[MOBJ_POOL_BLOCK];
+
+		mobj_pool_blocks.push_back(block);
+		mobj_cold_blocks.push_back(colds);
+
+		byte *base = (byte *)(((uintptr_t)block + MOBJ_ALIGN - 1) & ~(uintptr_t)(MOBJ_ALIGN - 1));
+
+		// link in reverse, so they get used in address order
+		for (int i = MOBJ_POOL_BLOCK - 1; i >= 0; i--)
+		{
+			mobj_t *mo = (mobj_t *)(base + i * stride);
+
+			mo->cold = colds + i;
+
+			mo->next = mobj_free_list;
+			mobj_free_list = mo;
+		}
+	}
+
+	mobj_t *mo = mobj_free_list;
+	mobj_free_list = mo->next;
+
+	mobj_cold_t *cold = mo->cold;
+
+	Z_Clear(mo, mobj_t, 1);
+	Z_Clear(cold, mobj_cold_t, 1);
+
+	mo->cold = cold;
+
+	return mo;
+}
+
+//
+// Removes the NULL entries left in the live array by removed mobjs.
+// Must not be called while the array is being traversed.
+//
+static void CompactLiveMobjs(void)
+{
+	if (live_holes == 0)
+		return;
+
+	int dest = 0;
+
+	for (int i = 0; i < (int)live_mobjs.size(); i++)
+	{
+		mobj_t *mo = live_mobjs[i];
+
+		if (mo)
+		{
+			mo->live_index = dest;
+			live_mobjs[dest++] = mo;
+		}
+	}
+
+	live_mobjs.resize(dest);
+	live_holes = 0;
 }
 
 
@@ -600,11 +694,11 @@ bool P_SetMobjState(mobj_t * mobj, statenum_t state)
 	if ((st->flags & SFF_Model) && (mobj->state->flags & SFF_Model) &&
 		(st->sprite == mobj->state->sprite) && st->tics > 1)
 	{
-		mobj->model_last_frame = mobj->state->frame;
-		mobj->model_last_animfile = mobj->state->animfile;
+		mobj->cold->model_last_frame = mobj->state->frame;
+		mobj->cold->model_last_animfile = mobj->state->animfile;
 	}
 	else
-		mobj->model_last_frame = -1;
+		mobj->cold->model_last_frame = -1;
 
 	mobj->state  = st;
 	mobj->tics   = st->tics;
@@ -635,9 +729,9 @@ bool P_SetMobjState2(mobj_t * mobj, statenum_t state)
 	{
 		state_t *st = &states[state];
 
-		if (st->label)
+		if (st->label_id != SLAB_None)
 		{
-			statenum_t new_state = P_MobjFindLabel(mobj, st->label);
+			statenum_t new_state = P_MobjFindLabelID(mobj, st->label_id);
 
 			if (new_state != S_NULL)
 				state = new_state;
@@ -688,7 +782,19 @@ bool P_SetMobjStateDeferred(mobj_t * mo, statenum_t stnum, int tic_skip)
 //
 statenum_t P_MobjFindLabel(mobj_t * mobj, const char *label)
 {
-	return DDF_StateFindLabel(mobj->info->state_grp, label, true /* quiet */);
+	return P_MobjFindLabelID(mobj, DDF_StateLabelID(label));
+}
+
+//
+// P_MobjFindLabelID
+//
+// Same as above, but the label has already been interned.
+//
+statenum_t P_MobjFindLabelID(mobj_t * mobj, int label_id)
+{
+	const mobjtype_c *info = mobj->info;
+
+	return info->state_labels.Find(info->state_grp, label_id);
 }
 
 //
@@ -1508,7 +1614,7 @@ static void P_MobjThinker(mobj_t * mobj)
 	region_properties_t player_props;
 
 	SYS_ASSERT_MSG(mobj->next != (mobj_t *)-1,
-		("P_MobjThinker INTERNAL ERROR: mobj has been Z_Freed"));
+		("P_MobjThinker INTERNAL ERROR: mobj has been removed"));
 
 	if ((mobj->typenum & ~3) == 9300)
 	{
@@ -1523,16 +1629,16 @@ static void P_MobjThinker(mobj_t * mobj)
 	mobj->ClearStaleRefs();
 
 	mobj->visibility = (15 * mobj->visibility + mobj->vis_target)  / 16;
-	mobj->dlight.r   = (15 * mobj->dlight.r + mobj->dlight.target) / 16;
+	mobj->cold->dlight.r = (15 * mobj->cold->dlight.r + mobj->cold->dlight.target) / 16;
 
 	// position interpolation
-	if (mobj->lerp_num > 1)
+	if (mobj->cold->lerp_num > 1)
 	{
-		mobj->lerp_pos++;
+		mobj->cold->lerp_pos++;
 
-		if (mobj->lerp_pos >= mobj->lerp_num)
+		if (mobj->cold->lerp_pos >= mobj->cold->lerp_num)
 		{
-			mobj->lerp_pos = mobj->lerp_num = 0;
+			mobj->cold->lerp_pos = mobj->cold->lerp_num = 0;
 		}
 	}
 
@@ -1682,25 +1788,28 @@ static void P_MobjThinker(mobj_t * mobj)
 //
 void P_RunMobjThinkers(void)
 {
-	mobj_t *mo;
-	mobj_t *next;
-
-	for (mo = mobjlisthead; mo; mo = next)
+	// same order as the mobj list (newest first).  Mobjs spawned here
+	// are added to the end, and won't think until the next tic.
+	for (int i = (int)live_mobjs.size() - 1; i >= 0; i--)
 	{
-		next = mo->next;
+		mobj_t *mo = live_mobjs[i];
 
-		P_MobjThinker(mo);
+		if (mo)
+			P_MobjThinker(mo);
 	}
 
+	CompactLiveMobjs();
+
 	P_RemoveQueuedMobjs(false);
 }
 
 
 void P_ClearAllStaleRefs(void)
 {
-	for (mobj_t * mo = mobjlisthead; mo; mo = mo->next)
+	for (int i = (int)live_mobjs.size() - 1; i >= 0; i--)
 	{
-		mo->ClearStaleRefs();
+		if (live_mobjs[i])
+			live_mobjs[i]->ClearStaleRefs();
 	}
 
 	for (int pnum = 0; pnum < MAXPLAYERS; pnum++)
@@ -1715,9 +1824,10 @@ void P_ClearAllStaleRefs(void)
 void P_UpdateInterpolationHistory(void)
 {
 	//Update object interpolation
-	for (mobj_t * mo = mobjlisthead; mo; mo = mo->next)
+	for (int i = (int)live_mobjs.size() - 1; i >= 0; i--)
 	{
-		mo->UpdateLastTicRender();
+		if (live_mobjs[i])
+			live_mobjs[i]->UpdateLastTicRender();
 	}
 
 	//update floor/ceiling interpolation
@@ -1777,8 +1887,11 @@ void P_RemoveQueuedMobjs(bool force_all)
 		remove_queue.remove(NULL);
 }
 
-static void AddMobjToList(mobj_t *mo)
+void P_AddMobjToList(mobj_t *mo)
 {
+	mo->live_index = (int)live_mobjs.size();
+	live_mobjs.push_back(mo);
+
 	mo->prev = NULL;
 	mo->next = mobjlisthead;
 
@@ -1817,6 +1930,13 @@ static void RemoveMobjFromList(mobj_t *mo)
 
 	mo->next = (mobj_t *) -1;
 	mo->prev = (mobj_t *) -1;
+
+	SYS_ASSERT(live_mobjs[mo->live_index] == mo);
+
+	live_mobjs[mo->live_index] = NULL;
+	live_holes++;
+
+	mo->live_index = -1;
 }
 
 //
@@ -1842,6 +1962,8 @@ void P_RemoveMobj(mobj_t *mo)
 		return;
 	}
 
+	RAD_MonsterIsRemoved(mo);
+
 	if ((mo->info->flags & MF_SPECIAL) &&
 	    ! (mo->flags & MF_MISSILE) &&
 		(deathmatch >= 2 || level_flags.itemrespawn) &&
@@ -1850,7 +1972,7 @@ void P_RemoveMobj(mobj_t *mo)
 	{
 		iteminque_t *newbie = Z_New(iteminque_t, 1);
 
-		newbie->spawnpoint = mo->spawnpoint;
+		newbie->spawnpoint = mo->cold->spawnpoint;
 		newbie->time = mo->info->respawntime;
 
 		if (itemquehead == NULL)
@@ -1910,6 +2032,9 @@ void P_RemoveAllMobjs(void)
 		mo->refcount = 0;
 		DeleteMobj(mo);
 	}
+
+	live_mobjs.clear();
+	live_holes = 0;
 }
 
 //
@@ -2054,7 +2179,7 @@ void P_MobjItemRespawn(void)
 
 		mo->angle = cur->spawnpoint.angle;
 		mo->vertangle = cur->spawnpoint.vertangle;
-		mo->spawnpoint = cur->spawnpoint;
+		mo->cold->spawnpoint = cur->spawnpoint;
 
 		// Taking this item-in-que out of the que, remove
 		// any references by the previous and next items to
@@ -2108,9 +2233,7 @@ void P_MobjRemoveMissile(mobj_t * missile)
 //
 mobj_t *P_MobjCreateObject(float x, float y, float z, const mobjtype_c *info)
 {
-	mobj_t *mobj = Z_New(mobj_t, 1);
-
-	Z_Clear(mobj, mobj_t, 1);
+	mobj_t *mobj = P_MobjAlloc();
 
 #if (DEBUG_MOBJ > 0)
 	L_WriteDebug("tics=%05d  CREATE %p [%s]  AT %1.0f,%1.0f,%1.0f\n",
@@ -2127,8 +2250,8 @@ mobj_t *P_MobjCreateObject(float x, float y, float z, const mobjtype_c *info)
 	mobj->speed = info->speed;
 	mobj->fuse = info->fuse;
 	mobj->side = info->side;
-	mobj->model_skin = info->model_skin;
-	mobj->model_last_frame = -1;
+	mobj->cold->model_skin = info->model_skin;
+	mobj->cold->model_last_frame = -1;
 
 	if (level_flags.fastparm)
 		mobj->speed *= info->fast;
@@ -2181,8 +2304,8 @@ mobj_t *P_MobjCreateObject(float x, float y, float z, const mobjtype_c *info)
 
 		if (dinfo->type != DLITE_None)
 		{
-			mobj->dlight.r = mobj->dlight.target = dinfo->radius;
-			mobj->dlight.color = dinfo->colour;
+			mobj->cold->dlight.r = mobj->cold->dlight.target = dinfo->radius;
+			mobj->cold->dlight.color = dinfo->colour;
 
 			// leave 'shader' field as NULL : renderer will create it
 		}
@@ -2198,7 +2321,7 @@ mobj_t *P_MobjCreateObject(float x, float y, float z, const mobjtype_c *info)
 	mobj->z = P_ComputeThingGap(mobj, sec, z, &mobj->floorz, &mobj->ceilingz);
 
 	// Find the real players height (TELEPORT WEAPONS).
-	mobj->origheight = z;
+	mobj->cold->origheight = z;
 
 	// update totals for countable items.  Doing it here means that
 	// things spawned dynamically can be counted as well.  Whilst this
@@ -2220,7 +2343,7 @@ mobj_t *P_MobjCreateObject(float x, float y, float z, const mobjtype_c *info)
 	//
 	// -AJA- 1999/09/15: now adds to _head_ of list (for speed).
 	//
-	AddMobjToList(mobj);
+	P_AddMobjToList(mobj);
 
 	mobj->UpdateLastTicRender();
 
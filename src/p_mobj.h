@@ -192,103 +192,123 @@ typedef struct dlight_state_s
 dlight_state_t;
 
 
-// Map Object definition.
-typedef struct mobj_s mobj_t;
-
-struct mobj_s : public position_c
+// Map object data which the playsim rarely looks at.  It lives apart
+// from the mobj (see mobj_t::cold), so that the loops which scan many
+// mobjs only pull the busy fields into the cache.
+typedef struct mobj_cold_s
 {
-	const mobjtype_c *info;
+	// hash values for TUNNEL missiles
+	u32_t tunnel_hash[2];
 
-	angle_t angle;      // orientation
-	angle_t vertangle;  // looking up or down
+	// -AJA- 1999/09/25: Path support.
+	struct rad_script_s *path_trigger;
 
-	// For movement checking.
-	float radius;
-	float height;
+	dlight_state_t dlight;
 
-	// Momentum, used to update position.
-	vec3_t mom;
+	// tag ID (for special operations)
+	int tag;
 
-	// current subsector
-	struct subsector_s *subsector;
+	int model_skin;
+	int model_last_frame;
+	short model_last_animfile;
 
-	// properties from extrafloor the thing is in
-	struct region_properties_s *props;
+	// position interpolation (disabled when lerp_num <= 1)
+	short lerp_num;
+	short lerp_pos;
 
-	// The closest interval over all contacted Sectors.
-	float floorz;
-	float ceilingz;
-	float dropoffz;
+	vec3_t lerp_from; /// previous position for interpolation
 
-	// This is the current speed of the object.
-	// if fastparm, it is already calculated.
-	float speed;
-	int fuse;
+	last_tic_render_t lastticrender;
 
-	// Thing's health level
-	float health;
+	// For respawning.
+	spawnpoint_t spawnpoint;
 
-	// state tic counter
-	int tics;
-	int tic_skip;
+	float origheight;
+}
+mobj_cold_t;
 
-	const struct state_s *state;
-	const struct state_s *next_state;
+
+// Map Object definition.
+typedef struct mobj_s mobj_t;
+
+struct mobj_s : public position_c
+{
+	// The fields are grouped by how often they are used.  The first
+	// group is what the blockmap iterators, collision checks and the
+	// movement code read for nearly every thing they look at, and fits
+	// in the first two cache lines (mobjs are allocated on a cache line
+	// boundary, see P_MobjAlloc).  The rest of the thinker state
+	// follows, and the data which is rarely touched is in 'cold'.
+
+	// For movement checking.
+	float radius;
+	float height;
 
 	// flags (Old and New)
 	int flags;
 	int extendedflags;
 	int hyperflags;
 
-	int model_skin;
-	int model_last_frame;
-	short model_last_animfile;
-
 	// type (for special types)
 	int typenum;
 	// index if polyobject
 	int po_ix;
 
-	// tag ID (for special operations)
-	int tag;
+	// Interaction info, by BLOCKMAP.
+	// Links in blocks (if needed).
+	mobj_t *bnext, *bprev;
 
-	// Movement direction, movement generation (zig-zagging).
-	dirtype_e movedir;  // 0-7
+	// Momentum, used to update position.
+	vec3_t mom;
 
-	// when 0, select a new dir
-	int movecount;
+	// The closest interval over all contacted Sectors.
+	float floorz;
+	float ceilingz;
+	float dropoffz;
 
-	// Reaction time: if non 0, don't attack yet.
-	// Used by player to freeze a bit after teleporting.
-	int reactiontime;
+	// current subsector
+	struct subsector_s *subsector;
 
-	// If >0, the target will be chased
-	// no matter what (even if shot)
-	int threshold;
+	const mobjtype_c *info;
 
-	// Additional info record for player avatars only.
-	struct player_s *player;
+	const struct state_s *state;
+	const struct state_s *next_state;
 
-	// Player number last looked for.
-	int lastlook;
+	// state tic counter
+	int tics;
+	int tic_skip;
 
-	// For respawning.
-	spawnpoint_t spawnpoint;
+	// Thing's health level
+	float health;
 
-	float origheight;
+	angle_t angle;      // orientation
+	angle_t vertangle;  // looking up or down
 
-	// current visibility and target visibility
-	float visibility;
-	float vis_target;
+	// This is the current speed of the object.
+	// if fastparm, it is already calculated.
+	float speed;
+	int fuse;
 
-	// current attack to be made
-	const atkdef_c *currentattack;
+	// properties from extrafloor the thing is in
+	struct region_properties_s *props;
 
-	// spread count for Ordered spreaders
-	int spreadcount;
+	// Additional info record for player avatars only.
+	struct player_s *player;
 
-	// If == validcount, already checked.
-	int validcount;
+	// objects that is above and below this one.  If there were several,
+	// then the closest one (in Z) is chosen.  We are riding the below
+	// object if the head height == our foot height.  We are being
+	// ridden if our head == the above object's foot height.
+	//
+	mobj_t * above_mo;
+	mobj_t * below_mo;
+
+	// these delta values give what position from the ride_em thing's
+	// center that we are sitting on.
+	float ride_dx, ride_dy;
+
+	// if we're on a ladder, this is the linedef #, otherwise -1.
+	int on_ladder;
 
 	// -ES- 1999/10/25 Reference Count. DO NOT TOUCH.
 	// All the following mobj references should be set only
@@ -310,39 +330,35 @@ struct mobj_s : public position_c
 	mobj_t * supportobj;
 	int side;
 
-	// objects that is above and below this one.  If there were several,
-	// then the closest one (in Z) is chosen.  We are riding the below
-	// object if the head height == our foot height.  We are being
-	// ridden if our head == the above object's foot height.
-	//
-	mobj_t * above_mo;
-	mobj_t * below_mo;
-
-	// these delta values give what position from the ride_em thing's
-	// center that we are sitting on.
-	float ride_dx, ride_dy;
+	// Movement direction, movement generation (zig-zagging).
+	dirtype_e movedir;  // 0-7
 
-	// -AJA- 1999/09/25: Path support.
-	struct rad_script_s *path_trigger;
+	// when 0, select a new dir
+	int movecount;
 
-	// if we're on a ladder, this is the linedef #, otherwise -1.
-	int on_ladder;
+	// Reaction time: if non 0, don't attack yet.
+	// Used by player to freeze a bit after teleporting.
+	int reactiontime;
 
-	dlight_state_t dlight;
+	// If >0, the target will be chased
+	// no matter what (even if shot)
+	int threshold;
 
-	// monster reload support: count the number of shots
-	int shot_count;
+	// Player number last looked for.
+	int lastlook;
 
-	// hash values for TUNNEL missiles
-	u32_t tunnel_hash[2];
+	// current attack to be made
+	const atkdef_c *currentattack;
 
-	// position interpolation (disabled when lerp_num <= 1)
-	short lerp_num;
-	short lerp_pos;
+	// spread count for Ordered spreaders
+	int spreadcount;
 
-	vec3_t lerp_from; /// previous position for interpolation
+	// monster reload support: count the number of shots
+	int shot_count;
 
-	last_tic_render_t lastticrender;
+	// current visibility and target visibility
+	float visibility;
+	float vis_target;
 
 	// touch list: sectors this thing is in or touches
 	struct touch_node_s *touch_sectors;
@@ -350,9 +366,8 @@ struct mobj_s : public position_c
 	// linked list (mobjlisthead)
 	mobj_t *next, *prev;
 
-	// Interaction info, by BLOCKMAP.
-	// Links in blocks (if needed).
-	mobj_t *bnext, *bprev;
+	// position in the array of live mobjs, -1 once removed
+	int live_index;
 
 	// More list: links in subsector (if needed)
 	mobj_t *snext, *sprev;
@@ -360,6 +375,10 @@ struct mobj_s : public position_c
 	// One more: link in dynamic light blockmap
 	mobj_t *dlnext, *dlprev;
 
+	// the rarely used data.  Each mobj in the pool keeps the same one,
+	// and it is cleared along with the mobj (see P_MobjAlloc).
+	mobj_cold_t *cold;
+
 	// counters - these were known as special1/2/3 in Heretic and Hexen
    ///int counters[NUMMOBJCOUNTERS];
 
@@ -30,11 +30,13 @@
 #include "dm_state.h"
 #include "m_random.h"
 #include "p_local.h"
+#include "p_workers.h"
 #include "r_sky.h"
 #include "r_state.h"
 #include "s_sound.h"
 
 #include <algorithm>
+#include <vector>
 
 typedef enum
 {
@@ -128,6 +130,36 @@ static float GetSecHeightReference(heightref_e ref,
     return 0;
 }
 
+//
+// Sounds started by the movers.  While the movers run on the worker
+// threads, the sounds of each mover are queued instead, and started
+// afterwards in list order (see P_RunActivePlanes).
+//
+typedef struct
+{
+	sfx_t *sfx;
+	position_c *pos;
+}
+mover_sound_t;
+
+static thread_local std::vector<mover_sound_t> *mover_sound_queue;
+
+static void MoverSound(sfx_t *sfx, position_c *pos)
+{
+	if (mover_sound_queue)
+	{
+		mover_sound_t snd;
+
+		snd.sfx = sfx;
+		snd.pos = pos;
+
+		mover_sound_queue->push_back(snd);
+		return;
+	}
+
+	S_StartFX(sfx, SNCAT_Level, pos);
+}
+
 #define RELOOP_TICKS  6
 
 static void MakeMovingSound(bool *started_var, sfx_t *sfx, position_c *pos)
@@ -143,7 +175,7 @@ static void MakeMovingSound(bool *started_var, sfx_t *sfx, position_c *pos)
 
 	if (! *started_var || (def->looping && (leveltime % RELOOP_TICKS)==0))
 	{
-		S_StartFX(sfx, SNCAT_Level, pos);
+		MoverSound(sfx, pos);
 
 		*started_var = true;
 	}
@@ -332,8 +364,7 @@ static bool MovePlane(plane_move_t *plane)
 
             if (res == RES_PastDest)
             {
-                S_StartFX(plane->type->sfxstop, 
-                               SNCAT_Level,
+                MoverSound(plane->type->sfxstop,
                                &plane->sector->sfx_origin);
 
                 plane->speed = plane->type->speed_up;
@@ -420,8 +451,7 @@ static bool MovePlane(plane_move_t *plane)
 
                 if (dir)
                 {
-                    S_StartFX(plane->type->sfxstart, 
-                                   SNCAT_Level,
+                    MoverSound(plane->type->sfxstart,
                                    &plane->sector->sfx_origin);
                 }
 
@@ -440,8 +470,7 @@ static bool MovePlane(plane_move_t *plane)
 
             if (res == RES_PastDest)
             {
-                S_StartFX(plane->type->sfxstop, 
-                               SNCAT_Level,
+                MoverSound(plane->type->sfxstop,
                                &plane->sector->sfx_origin);
 
                 if (plane->newspecial != -1)
@@ -1087,8 +1116,7 @@ static bool MoveSlider(slider_move_t *smov)
             {
                 if (SliderCanClose(smov->line))
                 {
-                    S_StartFX(smov->info->sfx_start, 
-                                   SNCAT_Level,
+                    MoverSound(smov->info->sfx_start,
                                    &sec->sfx_origin);
 
                     smov->sfxstarted = false;
@@ -1114,8 +1142,7 @@ static bool MoveSlider(slider_move_t *smov)
 
             if (smov->opening >= smov->target)
             {
-                S_StartFX(smov->info->sfx_stop, 
-                               SNCAT_Level,
+                MoverSound(smov->info->sfx_stop,
                                &sec->sfx_origin);
 
                 smov->opening = smov->target;
@@ -1151,8 +1178,7 @@ static bool MoveSlider(slider_move_t *smov)
 
             if (smov->opening <= 0.0f)
             {
-                S_StartFX(smov->info->sfx_stop, 
-                               SNCAT_Level,
+                MoverSound(smov->info->sfx_stop,
                                &sec->sfx_origin);
 
                 return true; // REMOVE ME
@@ -1224,23 +1250,804 @@ bool EV_DoSlider(line_t * door, line_t *act_line, mobj_t * thing,
 	return true;
 }
 
+//
+// Threaded planes and sliders
+//
+// A plane only changes its sector (and the extrafloors the sector
+// controls), the gaps of the lines around them, and the things in
+// them.  Each mover claims the sectors it moves and the sectors
+// across their lines, plus the blockmap cells which clipping the
+// things in them looks at.  Movers with a claim in common are joined
+// into one group which runs in list order, and the groups run in
+// parallel.
+//
+// A group stays on the main thread when one of its movers may crush
+// something (crush damage, or a corpse or dropped item in the way),
+// may use P_Random (clipping a missile, a charging skull, a thing
+// picking up items, or a touchy thing or polyobj anchor nearby), or
+// changes some global state (a new sector type, or a sky flat).
+// Those groups run afterwards in list order, so the random numbers
+// and the spawned things are the same as before.  Sounds are queued
+// and started at the end in list order, hence the result is exactly
+// the same as running the movers one by one.
+//
+#define MIN_THREADED_MOVERS  32
+
+// check the threaded movers against the serial code (see p_lights.cc)
+extern int debug_threads;
+
+extern mobj_t ** bmap_things;
+
+typedef bool (* mover_run_f)(int m);
+
+static mover_run_f mover_run;
+
+// for each mover of the current batch
+static std::vector<int> mover_parent;
+static std::vector<int> mover_serial;
+static std::vector<int> mover_done;
+static std::vector<int> mover_group;
+
+static std::vector< std::vector<mover_sound_t> > mover_sounds;
+
+// mover which claimed each sector and blockmap cell (-1 for none)
+static std::vector<int> sector_mover;
+static std::vector<int> sector_claims;
+
+static std::vector<int> cell_mover;
+static std::vector<int> cell_claims;
+
+// blockmap cells with a touchy thing or a polyobject anchor in them
+static std::vector<char> cell_touchy;
+
+static std::vector< std::vector<int> > mover_groups;
+static std::vector<int> mover_serial_list;
+
+static int FindMoverGroup(int m)
+{
+	while (mover_parent[m] != m)
+	{
+		mover_parent[m] = mover_parent[mover_parent[m]];
+		m = mover_parent[m];
+	}
+
+	return m;
+}
+
+static void JoinMovers(int a, int b)
+{
+	a = FindMoverGroup(a);
+	b = FindMoverGroup(b);
+
+	if (a < b)
+		mover_parent[b] = a;
+	else if (b < a)
+		mover_parent[a] = b;
+}
+
+static void ClaimSector(int m, sector_t *sec)
+{
+	int secnum = (int)(sec - sectors);
+
+	if (sector_mover[secnum] < 0)
+	{
+		sector_mover[secnum] = m;
+		sector_claims.push_back(secnum);
+	}
+	else
+		JoinMovers(m, sector_mover[secnum]);
+}
+
+static bool CellIsTouchy(int cell)
+{
+	for (mobj_t *mo = bmap_things[cell]; mo; mo = mo->bnext)
+	{
+		// touchy things go off when a solid thing is clipped against
+		// them, and polyobject anchors may print a warning.
+		if ((mo->flags & MF_TOUCHY) || (mo->typenum & ~3) == 9300)
+			return true;
+	}
+
+	return false;
+}
+
+static void ClaimCells(int m, float x1, float y1, float x2, float y2)
+{
+	int bx1 = BLOCKMAP_GET_X(x1);
+	int by1 = BLOCKMAP_GET_Y(y1);
+	int bx2 = BLOCKMAP_GET_X(x2);
+	int by2 = BLOCKMAP_GET_Y(y2);
+
+	bx1 = MAX(bx1, 0);
+	by1 = MAX(by1, 0);
+	bx2 = MIN(bx2, bmap_width  - 1);
+	by2 = MIN(by2, bmap_height - 1);
+
+	for (int by = by1; by <= by2; by++)
+	for (int bx = bx1; bx <= bx2; bx++)
+	{
+		int cell = by * bmap_width + bx;
+
+		if (cell_mover[cell] < 0)
+		{
+			cell_mover[cell] = m;
+			cell_claims.push_back(cell);
+
+			cell_touchy[cell] = CellIsTouchy(cell) ? 1 : 0;
+		}
+		else
+			JoinMovers(m, cell_mover[cell]);
+
+		if (cell_touchy[cell])
+			mover_serial[m] = 1;
+	}
+}
+
+static void ClaimThing(int m, mobj_t *mo)
+{
+	if (mo)
+		ClaimCells(m, mo->x, mo->y, mo->x, mo->y);
+}
+
+//
+// Clipping a thing looks at the things overlapping it, which are all
+// within its radius plus the largest radius, and changes the things
+// it stands on and under.  Two movers which look at the same thing
+// (whichever way) hence claim the blockmap cell it is in.
+//
+static bool PIT_ClaimPlaneThing(mobj_t *mo, void *data)
+{
+	int m = *(int *)data;
+
+	// see PIT_ChangeSector and PIT_CheckRelThing
+	if (mo->health <= 0 ||
+		(mo->flags & (MF_DROPPED | MF_PICKUP | MF_SKULLFLY | MF_MISSILE)))
+	{
+		mover_serial[m] = 1;
+	}
+
+	float r = mo->radius + bmap_max_radius;
+
+	ClaimCells(m, mo->x - r, mo->y - r, mo->x + r, mo->y + r);
+
+	ClaimThing(m, mo->above_mo);
+	ClaimThing(m, mo->below_mo);
+
+	return true;
+}
+
+static void ClaimMovedSector(int m, sector_t *sec)
+{
+	ClaimSector(m, sec);
+
+	// the gaps of its lines depend on the sectors across them
+	for (int i = 0; i < sec->linecount; i++)
+	{
+		line_t *ld = sec->lines[i];
+
+		if (ld->frontsector)
+			ClaimSector(m, ld->frontsector);
+
+		if (ld->backsector)
+			ClaimSector(m, ld->backsector);
+	}
+
+	// a thing touching the sector reads its heights (and the gaps of
+	// its lines), so two movers reaching a sector this way also
+	// share the cells of that thing.
+	P_SectorThingsIterator(sec, PIT_ClaimPlaneThing, &m);
+}
+
+static void ClaimPlane(int m, plane_move_t *pmov)
+{
+	sector_t *sec = pmov->sector;
+
+	if (pmov->crush || pmov->newspecial != -1 ||
+		(pmov->new_image && pmov->new_image == skyflatimage))
+	{
+		mover_serial[m] = 1;
+	}
+
+	// a waiting plane only looks at its own sector
+	if (pmov->direction != DIRECTION_UP && pmov->direction != DIRECTION_DOWN)
+	{
+		ClaimSector(m, sec);
+		return;
+	}
+
+	ClaimMovedSector(m, sec);
+
+	for (extrafloor_t *ef = sec->control_floors; ef; ef = ef->ctrl_next)
+		ClaimMovedSector(m, ef->sector);
+}
+
+static void ClaimSlider(int m, slider_move_t *smov)
+{
+	// sliders only change their own line, and only read the things
+	// near it (which nothing moves while the sliders run).
+	ClaimSector(m, smov->line->frontsector);
+
+	if (smov->line->backsector)
+		ClaimSector(m, smov->line->backsector);
+}
+
+static void BeginMoverBatch(int total)
+{
+	mover_parent.resize(total);
+	mover_serial.assign(total, 0);
+	mover_done.assign(total, 0);
+	mover_group.assign(total, -1);
+
+	// keep the old queues, to keep their memory
+	if ((int)mover_sounds.size() < total)
+		mover_sounds.resize(total);
+
+	for (int m = 0; m < total; m++)
+	{
+		mover_parent[m] = m;
+		mover_sounds[m].clear();
+	}
+
+	if ((int)sector_mover.size() != numsectors)
+		sector_mover.assign(numsectors, -1);
+
+	if ((int)cell_mover.size() != bmap_width * bmap_height)
+	{
+		cell_mover.assign(bmap_width * bmap_height, -1);
+		cell_touchy.assign(bmap_width * bmap_height, 0);
+	}
+}
+
+static void EndMoverBatch(void)
+{
+	for (int i = 0; i < (int)sector_claims.size(); i++)
+		sector_mover[sector_claims[i]] = -1;
+
+	for (int i = 0; i < (int)cell_claims.size(); i++)
+		cell_mover[cell_claims[i]] = -1;
+
+	sector_claims.clear();
+	cell_claims.clear();
+}
+
+static inline bool MoverIsSerial(int m)
+{
+	return mover_serial[FindMoverGroup(m)] != 0;
+}
+
+//
+// Puts the movers into groups for the worker threads, and the
+// serial ones into mover_serial_list.  Returns the number of groups.
+//
+static int BuildMoverGroups(int total)
+{
+	// a few groups per thread, to even out the work
+	int groups = P_WorkerThreads() * 4;
+
+	mover_groups.resize(groups);
+
+	for (int g = 0; g < groups; g++)
+		mover_groups[g].clear();
+
+	mover_serial_list.clear();
+
+	for (int m = 0; m < total; m++)
+		if (mover_serial[m])
+			mover_serial[FindMoverGroup(m)] = 1;
+
+	int next = 0;
+
+	for (int m = 0; m < total; m++)
+	{
+		int root = FindMoverGroup(m);
+
+		if (mover_serial[root])
+		{
+			mover_serial_list.push_back(m);
+			continue;
+		}
+
+		if (mover_group[root] < 0)
+			mover_group[root] = (next++) % groups;
+
+		mover_groups[mover_group[root]].push_back(m);
+	}
+
+	return groups;
+}
+
+static void RunMover(int m)
+{
+	mover_sound_queue = &mover_sounds[m];
+
+	mover_done[m] = mover_run(m) ? 1 : 0;
+
+	mover_sound_queue = NULL;
+}
+
+static void RunMoverGroup(int group, void *data)
+{
+	std::vector<int>& list = mover_groups[group];
+
+	for (int i = 0; i < (int)list.size(); i++)
+		RunMover(list[i]);
+}
+
+static void RunSerialMovers(void)
+{
+	for (int i = 0; i < (int)mover_serial_list.size(); i++)
+		RunMover(mover_serial_list[i]);
+}
+
+static void StartMoverSounds(int total)
+{
+	for (int m = 0; m < total; m++)
+	{
+		std::vector<mover_sound_t>& list = mover_sounds[m];
+
+		for (int i = 0; i < (int)list.size(); i++)
+			S_StartFX(list[i].sfx, SNCAT_Level, list[i].pos);
+	}
+}
+
+static bool SameMoverSounds(const std::vector<mover_sound_t>& A,
+                            const std::vector<mover_sound_t>& B)
+{
+	if (A.size() != B.size())
+		return false;
+
+	for (int i = 0; i < (int)A.size(); i++)
+		if (A[i].sfx != B[i].sfx || A[i].pos != B[i].pos)
+			return false;
+
+	return true;
+}
+
+static bool RunPlane(int m)
+{
+	return MovePlane(active_planes[m]);
+}
+
+static bool RunSlider(int m)
+{
+	return MoveSlider(active_sliders[m]);
+}
+
+//
+// The state which the threaded planes may change, for debug_threads.
+//
+typedef struct
+{
+	sector_t *sec;
+
+	float f_h, c_h;
+
+	const image_c *floor_image;
+	const image_c *ceil_image;
+}
+plane_sector_state_t;
+
+typedef struct
+{
+	extrafloor_t *ef;
+
+	float top_h, bottom_h;
+}
+plane_ef_state_t;
+
+typedef struct
+{
+	mobj_t *mo;
+
+	float z, floorz, ceilingz, dropoffz;
+
+	mobj_t *above_mo;
+	mobj_t *below_mo;
+
+	int on_ladder;
+}
+plane_thing_state_t;
+
+typedef struct
+{
+	std::vector<plane_sector_state_t> sectors;
+	std::vector<plane_ef_state_t>     efs;
+	std::vector<plane_thing_state_t>  things;
+}
+plane_state_t;
+
+static bool PIT_SaveThing(mobj_t *mo, void *data)
+{
+	((std::vector<mobj_t *> *)data)->push_back(mo);
+	return true;
+}
+
+static void SavePlaneState(plane_state_t& st)
+{
+	st.sectors.clear();
+	st.efs.clear();
+	st.things.clear();
+
+	for (int i = 0; i < (int)sector_claims.size(); i++)
+	{
+		int secnum = sector_claims[i];
+
+		if (MoverIsSerial(sector_mover[secnum]))
+			continue;
+
+		plane_sector_state_t ss;
+
+		ss.sec = sectors + secnum;
+		ss.f_h = ss.sec->f_h;
+		ss.c_h = ss.sec->c_h;
+		ss.floor_image = ss.sec->floor.image;
+		ss.ceil_image  = ss.sec->ceil.image;
+
+		st.sectors.push_back(ss);
+
+		for (extrafloor_t *ef = ss.sec->control_floors; ef; ef = ef->ctrl_next)
+		{
+			plane_ef_state_t es;
+
+			es.ef = ef;
+			es.top_h = ef->top_h;
+			es.bottom_h = ef->bottom_h;
+
+			st.efs.push_back(es);
+		}
+	}
+
+	// every thing a mover may change touches a sector it claimed
+	std::vector<mobj_t *> things;
+
+	for (int i = 0; i < (int)st.sectors.size(); i++)
+		P_SectorThingsIterator(st.sectors[i].sec, PIT_SaveThing, &things);
+
+	std::sort(things.begin(), things.end());
+	things.erase(std::unique(things.begin(), things.end()), things.end());
+
+	for (int k = 0; k < (int)things.size(); k++)
+	{
+		mobj_t *mo = things[k];
+
+		plane_thing_state_t ts;
+
+		ts.mo = mo;
+		ts.z = mo->z;
+		ts.floorz = mo->floorz;
+		ts.ceilingz = mo->ceilingz;
+		ts.dropoffz = mo->dropoffz;
+		ts.above_mo = mo->above_mo;
+		ts.below_mo = mo->below_mo;
+		ts.on_ladder = mo->on_ladder;
+
+		st.things.push_back(ts);
+	}
+}
+
+static void RestorePlaneState(const plane_state_t& st)
+{
+	int i;
+
+	for (i = 0; i < (int)st.sectors.size(); i++)
+	{
+		const plane_sector_state_t& ss = st.sectors[i];
+
+		ss.sec->f_h = ss.f_h;
+		ss.sec->c_h = ss.c_h;
+		ss.sec->floor.image = ss.floor_image;
+		ss.sec->ceil.image  = ss.ceil_image;
+	}
+
+	for (i = 0; i < (int)st.efs.size(); i++)
+	{
+		st.efs[i].ef->top_h    = st.efs[i].top_h;
+		st.efs[i].ef->bottom_h = st.efs[i].bottom_h;
+	}
+
+	// the gaps follow from the heights
+	for (i = 0; i < (int)st.sectors.size(); i++)
+	{
+		P_RecomputeGapsAroundSector(st.sectors[i].sec);
+		P_FloodExtraFloors(st.sectors[i].sec);
+	}
+
+	for (i = 0; i < (int)st.things.size(); i++)
+	{
+		const plane_thing_state_t& ts = st.things[i];
+
+		mobj_t *mo = ts.mo;
+
+		mo->z = ts.z;
+		mo->floorz = ts.floorz;
+		mo->ceilingz = ts.ceilingz;
+		mo->dropoffz = ts.dropoffz;
+		mo->on_ladder = ts.on_ladder;
+
+		mo->SetAboveMo(ts.above_mo);
+		mo->SetBelowMo(ts.below_mo);
+	}
+}
+
+static int ComparePlaneState(const plane_state_t& A, const plane_state_t& B)
+{
+	int diffs = 0;
+	int i;
+
+	for (i = 0; i < (int)A.sectors.size(); i++)
+	{
+		const plane_sector_state_t& a = A.sectors[i];
+		const plane_sector_state_t& b = B.sectors[i];
+
+		if (a.f_h != b.f_h || a.c_h != b.c_h ||
+			a.floor_image != b.floor_image || a.ceil_image != b.ceil_image)
+		{
+			diffs++;
+		}
+	}
+
+	for (i = 0; i < (int)A.efs.size(); i++)
+	{
+		if (A.efs[i].top_h    != B.efs[i].top_h ||
+			A.efs[i].bottom_h != B.efs[i].bottom_h)
+		{
+			diffs++;
+		}
+	}
+
+	for (i = 0; i < (int)A.things.size(); i++)
+	{
+		const plane_thing_state_t& a = A.things[i];
+		const plane_thing_state_t& b = B.things[i];
+
+		if (a.z != b.z || a.floorz != b.floorz ||
+			a.ceilingz != b.ceilingz || a.dropoffz != b.dropoffz ||
+			a.above_mo != b.above_mo || a.below_mo != b.below_mo ||
+			a.on_ladder != b.on_ladder)
+		{
+			diffs++;
+		}
+	}
+
+	return diffs;
+}
+
+static void CheckPlanesThreaded(int groups)
+{
+	int total = (int)active_planes.size();
+
+	// remember the starting state, so the serial code can run again
+	// from there, and its result (the one which is kept) compared with
+	// what the threads did.
+	std::vector<plane_move_t> before(total);
+
+	for (int m = 0; m < total; m++)
+		before[m] = *active_planes[m];
+
+	plane_state_t before_st;
+
+	SavePlaneState(before_st);
+
+	P_RunJobs(groups, RunMoverGroup, NULL);
+
+	std::vector<plane_move_t> threaded(total);
+
+	for (int m = 0; m < total; m++)
+		threaded[m] = *active_planes[m];
+
+	std::vector<int> threaded_done(mover_done);
+
+	std::vector< std::vector<mover_sound_t> > threaded_sounds(mover_sounds);
+
+	plane_state_t threaded_st;
+
+	SavePlaneState(threaded_st);
+
+	// the serial ones have not run yet
+	for (int m = 0; m < total; m++)
+	{
+		*active_planes[m] = before[m];
+		mover_sounds[m].clear();
+	}
+
+	RestorePlaneState(before_st);
+
+	for (int m = 0; m < total; m++)
+		if (! MoverIsSerial(m))
+			RunMover(m);
+
+	int diffs = 0;
+
+	for (int m = 0; m < total; m++)
+	{
+		plane_move_t *pmov = active_planes[m];
+
+		if (pmov->direction    != threaded[m].direction    ||
+			pmov->olddirection != threaded[m].olddirection ||
+			pmov->speed        != threaded[m].speed        ||
+			pmov->waited       != threaded[m].waited       ||
+			pmov->sfxstarted   != threaded[m].sfxstarted   ||
+			mover_done[m] != threaded_done[m] ||
+			! SameMoverSounds(mover_sounds[m], threaded_sounds[m]))
+		{
+			diffs++;
+		}
+	}
+
+	plane_state_t serial_st;
+
+	SavePlaneState(serial_st);
+
+	int state_diffs = ComparePlaneState(serial_st, threaded_st);
+
+	if (diffs > 0 || state_diffs > 0)
+		I_Warning("P_RunActivePlanes: %d of %d planes (and %d sectors or "
+				  "things) differ from the serial code\n",
+				  diffs, total, state_diffs);
+}
+
+static void CheckSlidersThreaded(int groups)
+{
+	int total = (int)active_sliders.size();
+
+	std::vector<slider_move_t> before(total);
+	std::vector<const linetype_c *> before_special(total);
+
+	for (int m = 0; m < total; m++)
+	{
+		slider_move_t *smov = active_sliders[m];
+
+		before[m] = *smov;
+		before_special[m] = smov->line->special;
+	}
+
+	// what MoveSlider can change besides the slider (when fully open
+	// it clears the line special and the side textures).
+	std::vector<const linetype_c *> before_door(total);
+	std::vector<const image_c *> before_mid(total * 2);
+
+	for (int m = 0; m < total; m++)
+	{
+		line_t *ld = active_sliders[m]->line;
+
+		before_door[m] = ld->slide_door;
+		before_mid[m*2+0] = ld->side[0]->middle.image;
+		before_mid[m*2+1] = ld->side[1]->middle.image;
+	}
+
+	P_RunJobs(groups, RunMoverGroup, NULL);
+
+	std::vector<slider_move_t> threaded(total);
+	std::vector<int> threaded_done(mover_done);
+	std::vector<int> threaded_gaps(total);
+	std::vector< std::vector<mover_sound_t> > threaded_sounds(mover_sounds);
+
+	for (int m = 0; m < total; m++)
+	{
+		threaded[m] = *active_sliders[m];
+		threaded_gaps[m] = active_sliders[m]->line->gap_num;
+	}
+
+	for (int m = 0; m < total; m++)
+	{
+		slider_move_t *smov = active_sliders[m];
+		line_t *ld = smov->line;
+
+		*smov = before[m];
+
+		ld->special    = before_special[m];
+		ld->slide_door = before_door[m];
+		ld->side[0]->middle.image = before_mid[m*2+0];
+		ld->side[1]->middle.image = before_mid[m*2+1];
+
+		P_ComputeGaps(ld);
+
+		mover_sounds[m].clear();
+	}
+
+	for (int m = 0; m < total; m++)
+		RunMover(m);
+
+	int diffs = 0;
+
+	for (int m = 0; m < total; m++)
+	{
+		slider_move_t *smov = active_sliders[m];
+
+		if (smov->opening    != threaded[m].opening    ||
+			smov->direction  != threaded[m].direction  ||
+			smov->waited     != threaded[m].waited     ||
+			smov->sfxstarted != threaded[m].sfxstarted ||
+			smov->line->gap_num != threaded_gaps[m] ||
+			mover_done[m] != threaded_done[m] ||
+			! SameMoverSounds(mover_sounds[m], threaded_sounds[m]))
+		{
+			diffs++;
+		}
+	}
+
+	if (diffs > 0)
+		I_Warning("P_RunActiveSliders: %d of %d sliders differ from the "
+				  "serial code\n", diffs, total);
+}
+
+static void RunPlanesThreaded(void)
+{
+	int total = (int)active_planes.size();
+
+	BeginMoverBatch(total);
+
+	for (int m = 0; m < total; m++)
+		ClaimPlane(m, active_planes[m]);
+
+	int groups = BuildMoverGroups(total);
+
+	mover_run = RunPlane;
+
+	if (debug_threads)
+		CheckPlanesThreaded(groups);
+	else
+		P_RunJobs(groups, RunMoverGroup, NULL);
+
+	RunSerialMovers();
+
+	StartMoverSounds(total);
+
+	EndMoverBatch();
+}
+
+static void RunSlidersThreaded(void)
+{
+	int total = (int)active_sliders.size();
+
+	BeginMoverBatch(total);
+
+	for (int m = 0; m < total; m++)
+		ClaimSlider(m, active_sliders[m]);
+
+	int groups = BuildMoverGroups(total);
+
+	mover_run = RunSlider;
+
+	if (debug_threads)
+		CheckSlidersThreaded(groups);
+	else
+		P_RunJobs(groups, RunMoverGroup, NULL);
+
+	RunSerialMovers();
+
+	StartMoverSounds(total);
+
+	EndMoverBatch();
+}
+
 //
 // Executes one tic's plane_move_t thinking.
 // Active sectors can destroy themselves, but not each other.
 //
 void P_RunActivePlanes(void)
 {
-	std::vector<plane_move_t *> ::iterator PMI;
+	int total = (int)active_planes.size();
+
+	if (total >= MIN_THREADED_MOVERS && P_WorkerThreads() >= 2)
+	{
+		RunPlanesThreaded();
+	}
+	else
+	{
+		mover_done.resize(total);
+
+		for (int m = 0; m < total; m++)
+			mover_done[m] = MovePlane(active_planes[m]) ? 1 : 0;
+	}
 
 	bool removed_plane = false;
 
-	for (PMI  = active_planes.begin();
-		 PMI != active_planes.end();
-		 PMI++)
+	for (int m = 0; m < total; m++)
 	{
-		plane_move_t *pmov = *PMI;
+		plane_move_t *pmov = active_planes[m];
 
-		if (MovePlane(pmov))
+		if (mover_done[m])
 		{
             if (pmov->is_ceiling || pmov->is_elevator)
                 pmov->sector->ceil_move = NULL;
@@ -1248,7 +2055,7 @@ void P_RunActivePlanes(void)
             if (!pmov->is_ceiling)
                 pmov->sector->floor_move = NULL;
 
-			*PMI = NULL;
+			active_planes[m] = NULL;
 			delete pmov;
 
 		    removed_plane = true;
@@ -1269,21 +2076,31 @@ void P_RunActivePlanes(void)
 
 void P_RunActiveSliders(void)
 {
-	std::vector<slider_move_t *>::iterator SMI;
+	int total = (int)active_sliders.size();
+
+	if (total >= MIN_THREADED_MOVERS && P_WorkerThreads() >= 2)
+	{
+		RunSlidersThreaded();
+	}
+	else
+	{
+		mover_done.resize(total);
+
+		for (int m = 0; m < total; m++)
+			mover_done[m] = MoveSlider(active_sliders[m]) ? 1 : 0;
+	}
 
 	bool removed_slider = false;
 
-	for (SMI  = active_sliders.begin();
-		 SMI != active_sliders.end();
-		 SMI++)
+	for (int m = 0; m < total; m++)
 	{
-		slider_move_t *smov = *SMI;
+		slider_move_t *smov = active_sliders[m];
 
-		if (MoveSlider(smov))
+		if (mover_done[m])
 		{
             smov->line->slider_move = NULL;
 
-			*SMI = NULL;
+			active_sliders[m] = NULL;
 			delete smov;
 
 		    removed_slider = true;
@@ -20,6 +20,7 @@
 #include "r_defs.h"
 #include "r_misc.h"
 #include "m_bbox.h"
+#include "p_blockmap.h"
 #include "p_mobj.h"
 #include "p_pobj.h"
 
@@ -242,7 +243,10 @@ void P_PostProcessPolyObjs(void)
 
 		// recompute line data
 		for (int j=0; j<po->count; j++)
+		{
 			PO_RecomputeLinedefData(po->lines[j]);
+			P_BlockmapMovingLine(po->lines[j]);
+		}
 
 		I_Printf("  Done processing for PO %d\n", po->index);
 	}
@@ -49,6 +49,7 @@
 #include "p_setup.h"
 #include "p_mobj.h"
 #include "p_pobj.h"
+#include "p_workers.h"
 #include "am_map.h"
 #include "r_gldefs.h"
 #include "r_sky.h"
@@ -836,35 +837,6 @@ static void LoadSubsectors(int lump, const char *name)
 	W_DoneWithLump(data);
 }
 
-//
-// GroupSectorTags
-//
-// Called during P_LoadSectors to set the tag_next & tag_prev fields of
-// each sector_t, which keep all sectors with the same tag in a linked
-// list for faster handling.
-//
-// -AJA- 1999/07/29: written.
-//
-static void GroupSectorTags(sector_t * dest, sector_t * seclist, int numsecs)
-{
-	// NOTE: `numsecs' does not include the current sector.
-
-	dest->tag_next = dest->tag_prev = NULL;
-
-	for (; numsecs > 0; numsecs--)
-	{
-		sector_t *src = &seclist[numsecs - 1];
-
-		if (src->tag == dest->tag)
-		{
-			src->tag_next = dest;
-			dest->tag_prev = src;
-			return;
-		}
-	}
-}
-
-
 static void LoadSectors(int lump)
 {
 	const void *data;
@@ -959,12 +931,12 @@ static void LoadSectors(int lump)
 		ss->c_lit_abs = false;
 
 		ss->sound_player = -1;
-
-		// -AJA- 1999/07/29: Keep sectors with same tag in a list.
-		GroupSectorTags(ss, sectors, i);
 	}
 
 	W_DoneWithLump(data);
+
+	// -AJA- 1999/07/29: Keep sectors with same tag in a list.
+	P_IndexSectorTags();
 }
 
 static void SetupRootNode(void)
@@ -1219,7 +1191,7 @@ static void SpawnMapThingEx(const mobjtype_c *info,
 
 	mo->typenum = typenum; // set if extended level data, else 0
 	mo->angle = angle;
-	mo->spawnpoint = point;
+	mo->cold->spawnpoint = point;
 
 	if ((typenum & ~3) == 9300)
 	{
@@ -1250,7 +1222,7 @@ static void SpawnMapThingEx(const mobjtype_c *info,
 	if (options & MTF_AMBUSH)
 	{
 		mo->flags |= MF_AMBUSH;
-		mo->spawnpoint.flags |= MF_AMBUSH;
+		mo->cold->spawnpoint.flags |= MF_AMBUSH;
 	}
 
 	// -AJA- 2000/09/22: MBF compatibility flag
@@ -1554,12 +1526,9 @@ static void LoadLineDefs(int lump)
 
 		if (ld->tag && ld->special && ld->special->ef.type)
 		{
-			for (int j=0; j < numsectors; j++)
+			for (sector_t *sec = P_FindSectorFromTag(ld->tag); sec; sec = sec->tag_next)
 			{
-				if (sectors[j].tag != ld->tag)
-					continue;
-
-				sectors[j].exfloor_max++;
+				sec->exfloor_max++;
 				numextrafloors++;
 			}
 		}
@@ -2327,13 +2296,13 @@ static void LoadUDMFSectors(parser_t *psr)
 
 			ss->sound_player = -1;
 
-			// -AJA- 1999/07/29: Keep sectors with same tag in a list.
-			GroupSectorTags(ss, sectors, i);
-
 			i++;
 		}
 	}
 
+	// -AJA- 1999/07/29: Keep sectors with same tag in a list.
+	P_IndexSectorTags();
+
 	I_Debugf("LoadUDMFSectors: finished parsing TEXTMAP\n");
 }
 
@@ -3228,14 +3197,10 @@ static void SetupSlidingDoors(void)
 			ld->slide_door = ld->special;
 		else
 		{
-			for (int k=0; k < numlines; k++)
+			for (line_t *other = P_FindLineFromTag(ld->tag); other; other = other->tag_next)
 			{
-				line_t *other = lines + k;
-
-				if (other->tag != ld->tag || other == ld)
-					continue;
-
-				other->slide_door = ld->special;
+				if (other != ld)
+					other->slide_door = ld->special;
 			}
 		}
 	}
@@ -3839,12 +3804,9 @@ static void SetupUDMFSpecials(void)
 				ld->tag = ld->args[0];
 				ld->special = P_LookupLineType(400); // make an EDGE Thick Extrafloor special
 
-				for (int j=0; j < numsectors; j++)
+				for (sector_t *sec = P_FindSectorFromTag(ld->args[0]); sec; sec = sec->tag_next)
 				{
-					if (sectors[j].tag != ld->args[0])
-						continue;
-
-					sectors[j].exfloor_max++;
+					sec->exfloor_max++;
 					numextrafloors++;
 				}
 			}
@@ -4061,7 +4023,10 @@ void P_ShutdownLevel(void)
 	delete[] v_seclists;
 	v_seclists = NULL;
 
+	P_ClearTagIndex();
 	P_DestroyBlockMap();
+
+	P_StopWorkers();
 }
 
 
@@ -4252,6 +4217,9 @@ void P_SetupLevel(void)
 		SetupUDMFSpecials();
 	}
 
+	// line tags are final now (SetupUDMFSpecials may change them)
+	P_IndexLineTags();
+
 	SetupExtrafloors();
 	SetupSlidingDoors();
 	SetupVertGaps();
@@ -85,7 +85,7 @@ typedef struct sight_info_s
 }
 sight_info_t;
 
-static sight_info_t sight_I;
+static thread_local sight_info_t sight_I;
 
 
 // intercepts found during first pass
@@ -101,7 +101,10 @@ typedef struct wall_intercept_s
 wall_intercept_t;
 
 // intercept array
-static std::vector<wall_intercept_t> wall_icpts;
+static thread_local std::vector<wall_intercept_t> wall_icpts;
+
+// lines already checked (there can be multiple segs on a line)
+static thread_local line_visit_c sight_visit;
 
 // for profiling...
 #ifdef DEVELOPERS
@@ -155,11 +158,9 @@ static bool CrossSubsector(subsector_t *sub)
 		ld = seg->linedef;
 
 		// line already checked ? (e.g. multiple segs on it)
-		if (ld->validcount == validcount)
+		if (! sight_visit.Visit(ld))
 			continue;
 
-		ld->validcount = validcount;
-
 		// line outside of bbox ?
 		if (ld->bbox[BOXLEFT] > sight_I.bbox[BOXRIGHT] ||
 			ld->bbox[BOXRIGHT] < sight_I.bbox[BOXLEFT] ||
@@ -447,7 +448,7 @@ bool P_CheckSight(mobj_t * src, mobj_t * dest)
 	// An unobstructed LOS is possible.
 	// Now look from eyes of t1 to any part of t2.
 
-	validcount++;
+	sight_visit.Begin();
 
 	// The "eyes" of a thing is 75% of its height.
 	SYS_ASSERT(src->info);
@@ -569,7 +570,7 @@ bool P_CheckSightToPoint(mobj_t * src, float x, float y, float z)
 	if (dest_sub == src->subsector)
 		return true;
 
-	validcount++;
+	sight_visit.Begin();
 
 	sight_I.src.x = src->x;
 	sight_I.src.y = src->y;
@@ -0,0 +1,494 @@
+//----------------------------------------------------------------------------
+//  EDGE Playsim SIMD kernels
+//----------------------------------------------------------------------------
+//
+//  Copyright (c) 2023  The EDGE Team.
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//----------------------------------------------------------------------------
+//
+//  The vector code does the very same single precision operations as
+//  the scalar code, just four at a time.  That only gives identical
+//  results when the scalar code uses SSE (or NEON) math too, hence
+//  builds using the x87 FPU (32-bit x86 without -mfpmath=sse) and
+//  32-bit ARM (where NEON flushes denormals) use the scalar code.
+//
+//----------------------------------------------------------------------------
+
+#include "system/i_defs.h"
+
+#include "m_bbox.h"
+#include "p_local.h"
+#include "p_simd.h"
+
+#if defined(__SSE2_MATH__) || defined(_M_X64) || defined(__aarch64__)
+#define SIMD_KERNELS  1
+#endif
+
+#ifdef SIMD_KERNELS
+#if defined(__aarch64__)
+#include "sse2neon.h"
+#else
+#include <emmintrin.h>
+#endif
+#endif
+
+
+#ifdef SIMD_KERNELS
+
+static inline __m128 MaskOf(bool value)
+{
+	return _mm_castsi128_ps(_mm_set1_epi32(value ? -1 : 0));
+}
+
+//
+// Four lots of P_PointOnDivlineSide() for the general case (neither
+// dx nor dy of the divline is zero).  Lanes are all ones for side 1.
+//
+static inline __m128 PointsOnDivlineSide(__m128 x, __m128 y,
+		__m128 div_x, __m128 div_y, __m128 div_dx, __m128 div_dy,
+		__m128 div_dx_neg, __m128 div_dy_neg)
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 ones = MaskOf(true);
+
+	__m128 dx = _mm_sub_ps(x, div_x);
+	__m128 dy = _mm_sub_ps(y, div_y);
+
+	__m128 dx_neg = _mm_cmplt_ps(dx, zero);
+	__m128 dy_neg = _mm_cmplt_ps(dy, zero);
+
+	// try to quickly decide by looking at sign bits
+	__m128 quick = _mm_xor_ps(_mm_xor_ps(div_dy_neg, div_dx_neg),
+							  _mm_xor_ps(dx_neg, dy_neg));
+
+	// left is negative
+	__m128 quick_side = _mm_xor_ps(div_dy_neg, dx_neg);
+
+	__m128 left  = _mm_mul_ps(dx, div_dy);
+	__m128 right = _mm_mul_ps(dy, div_dx);
+
+	__m128 slow_side = _mm_xor_ps(_mm_cmplt_ps(right, left), ones);
+
+	return _mm_or_ps(_mm_and_ps(quick, quick_side),
+					 _mm_andnot_ps(quick, slow_side));
+}
+
+//
+// Four lots of P_BoxOnLineSide() for the four lines whose details
+// are given.  Lanes where a diagonal line has a zero dx or dy (which
+// P_PointOnDivlineSide treats specially) are left for the caller.
+//
+static inline void BoxOnLinesSide(const float *tmbox, __m128 x, __m128 y,
+		__m128 dx, __m128 dy, __m128i slopetype, __m128 *p1, __m128 *p2)
+{
+	const __m128 zero = _mm_setzero_ps();
+
+	__m128 horiz = _mm_castsi128_ps(_mm_cmpeq_epi32(slopetype, _mm_set1_epi32(ST_HORIZONTAL)));
+	__m128 vert  = _mm_castsi128_ps(_mm_cmpeq_epi32(slopetype, _mm_set1_epi32(ST_VERTICAL)));
+	__m128 pos   = _mm_castsi128_ps(_mm_cmpeq_epi32(slopetype, _mm_set1_epi32(ST_POSITIVE)));
+	__m128 diag  = _mm_andnot_ps(_mm_or_ps(horiz, vert), MaskOf(true));
+
+	__m128 left   = _mm_set1_ps(tmbox[BOXLEFT]);
+	__m128 right  = _mm_set1_ps(tmbox[BOXRIGHT]);
+	__m128 bottom = _mm_set1_ps(tmbox[BOXBOTTOM]);
+	__m128 top    = _mm_set1_ps(tmbox[BOXTOP]);
+
+	__m128 dx_neg = _mm_cmplt_ps(dx, zero);
+	__m128 dy_neg = _mm_cmplt_ps(dy, zero);
+
+	// ST_HORIZONTAL
+	__m128 h1 = _mm_xor_ps(_mm_cmpgt_ps(top,    y), dx_neg);
+	__m128 h2 = _mm_xor_ps(_mm_cmpgt_ps(bottom, y), dx_neg);
+
+	// ST_VERTICAL
+	__m128 v1 = _mm_xor_ps(_mm_cmplt_ps(right, x), dy_neg);
+	__m128 v2 = _mm_xor_ps(_mm_cmplt_ps(left,  x), dy_neg);
+
+	// ST_POSITIVE uses the top-left and bottom-right corners,
+	// ST_NEGATIVE the top-right and bottom-left ones.
+	__m128 c1_x = _mm_or_ps(_mm_and_ps(pos, left),  _mm_andnot_ps(pos, right));
+	__m128 c2_x = _mm_or_ps(_mm_and_ps(pos, right), _mm_andnot_ps(pos, left));
+
+	__m128 d1 = PointsOnDivlineSide(c1_x, top,    x, y, dx, dy, dx_neg, dy_neg);
+	__m128 d2 = PointsOnDivlineSide(c2_x, bottom, x, y, dx, dy, dx_neg, dy_neg);
+
+	*p1 = _mm_or_ps(_mm_or_ps(_mm_and_ps(horiz, h1), _mm_and_ps(vert, v1)),
+					_mm_and_ps(diag, d1));
+	*p2 = _mm_or_ps(_mm_or_ps(_mm_and_ps(horiz, h2), _mm_and_ps(vert, v2)),
+					_mm_and_ps(diag, d2));
+}
+
+#endif  // SIMD_KERNELS
+
+
+int P_LinesTouchingBox(const float *left, const float *right,
+					   const float *bottom, const float *top, int count,
+					   float x1, float y1, float x2, float y2, int *touching)
+{
+	int total = 0;
+	int i = 0;
+
+#ifdef SIMD_KERNELS
+	__m128 box_x1 = _mm_set1_ps(x1);
+	__m128 box_y1 = _mm_set1_ps(y1);
+	__m128 box_x2 = _mm_set1_ps(x2);
+	__m128 box_y2 = _mm_set1_ps(y2);
+
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128 miss = _mm_or_ps(
+				_mm_or_ps(_mm_cmple_ps(_mm_loadu_ps(right  + i), box_x1),
+						  _mm_cmpge_ps(_mm_loadu_ps(left   + i), box_x2)),
+				_mm_or_ps(_mm_cmple_ps(_mm_loadu_ps(top    + i), box_y1),
+						  _mm_cmpge_ps(_mm_loadu_ps(bottom + i), box_y2)));
+
+		int bits = _mm_movemask_ps(miss) ^ 15;
+
+		for (; bits; bits &= bits - 1)
+		{
+			int lane = (bits & 1) ? 0 : (bits & 2) ? 1 : (bits & 4) ? 2 : 3;
+
+			touching[total++] = i + lane;
+		}
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		if (right[i] <= x1 || left[i] >= x2 || top[i] <= y1 || bottom[i] >= y2)
+			continue;
+
+		touching[total++] = i;
+	}
+
+	return total;
+}
+
+
+void P_BoxOnLinesSide(const float *tmbox, line_t * const *lines, int count,
+					  int *sides)
+{
+	int i = 0;
+
+#ifdef SIMD_KERNELS
+	for (; i + 4 <= count; i += 4)
+	{
+		line_t *const *L = lines + i;
+
+		__m128 x  = _mm_setr_ps(L[0]->v1->x, L[1]->v1->x, L[2]->v1->x, L[3]->v1->x);
+		__m128 y  = _mm_setr_ps(L[0]->v1->y, L[1]->v1->y, L[2]->v1->y, L[3]->v1->y);
+		__m128 dx = _mm_setr_ps(L[0]->dx, L[1]->dx, L[2]->dx, L[3]->dx);
+		__m128 dy = _mm_setr_ps(L[0]->dy, L[1]->dy, L[2]->dy, L[3]->dy);
+
+		__m128i slopetype = _mm_setr_epi32(L[0]->slopetype, L[1]->slopetype,
+										   L[2]->slopetype, L[3]->slopetype);
+		__m128 p1, p2;
+
+		BoxOnLinesSide(tmbox, x, y, dx, dy, slopetype, &p1, &p2);
+
+		int bits1 = _mm_movemask_ps(p1);
+		int cross = _mm_movemask_ps(_mm_xor_ps(p1, p2));
+
+		for (int k = 0; k < 4; k++)
+		{
+			if (cross & (1 << k))
+				sides[i + k] = -1;
+			else
+				sides[i + k] = (bits1 >> k) & 1;
+
+			// odd diagonal lines are done the slow way
+			if ((L[k]->dx == 0 || L[k]->dy == 0) &&
+				(L[k]->slopetype == ST_POSITIVE || L[k]->slopetype == ST_NEGATIVE))
+			{
+				sides[i + k] = P_BoxOnLineSide(tmbox, L[k]);
+			}
+		}
+	}
+#endif
+
+	for (; i < count; i++)
+		sides[i] = P_BoxOnLineSide(tmbox, lines[i]);
+}
+
+
+int P_LinesCrossingDivline(divline_t *div, const float *x1, const float *y1,
+						   const float *x2, const float *y2, int count,
+						   int *crossing)
+{
+	int total = 0;
+	int i = 0;
+
+#ifdef SIMD_KERNELS
+	if (div->dx != 0 && div->dy != 0)
+	{
+		__m128 div_x  = _mm_set1_ps(div->x);
+		__m128 div_y  = _mm_set1_ps(div->y);
+		__m128 div_dx = _mm_set1_ps(div->dx);
+		__m128 div_dy = _mm_set1_ps(div->dy);
+
+		__m128 div_dx_neg = MaskOf(div->dx < 0);
+		__m128 div_dy_neg = MaskOf(div->dy < 0);
+
+		for (; i + 4 <= count; i += 4)
+		{
+			__m128 s1 = PointsOnDivlineSide(_mm_loadu_ps(x1 + i), _mm_loadu_ps(y1 + i),
+					div_x, div_y, div_dx, div_dy, div_dx_neg, div_dy_neg);
+
+			__m128 s2 = PointsOnDivlineSide(_mm_loadu_ps(x2 + i), _mm_loadu_ps(y2 + i),
+					div_x, div_y, div_dx, div_dy, div_dx_neg, div_dy_neg);
+
+			int bits = _mm_movemask_ps(_mm_xor_ps(s1, s2));
+
+			for (; bits; bits &= bits - 1)
+			{
+				int lane = (bits & 1) ? 0 : (bits & 2) ? 1 : (bits & 4) ? 2 : 3;
+
+				crossing[total++] = i + lane;
+			}
+		}
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		if (P_PointOnDivlineSide(x1[i], y1[i], div) !=
+			P_PointOnDivlineSide(x2[i], y2[i], div))
+		{
+			crossing[total++] = i;
+		}
+	}
+
+	return total;
+}
+
+
+//----------------------------------------------------------------------------
+//
+//  SELF TEST
+//
+
+static u32_t test_seed;
+
+// not the game's random numbers, which would upset demos
+static float TestRandom(float range)
+{
+	test_seed = test_seed * 1103515245 + 12345;
+
+	return ((test_seed >> 8) & 0xFFFF) / 65536.0f * range;
+}
+
+static float TestCoord(void)
+{
+	// mostly whole numbers (like real maps), some fractions, and a
+	// few really large values.
+	switch ((int)TestRandom(8))
+	{
+		case 0:  return TestRandom(65536.0f) - 32768.0f;
+		case 1:  return TestRandom(1.0e9f) - 0.5e9f;
+		default: return (float)(int)(TestRandom(8192.0f) - 4096.0f);
+	}
+}
+
+static void TestLine(line_t *ld, vertex_t *v1, vertex_t *v2)
+{
+	ld->v1 = v1;
+	ld->v2 = v2;
+
+	v1->x = TestCoord();
+	v1->y = TestCoord();
+
+	switch ((int)TestRandom(6))
+	{
+		case 0:  v2->x = v1->x; v2->y = TestCoord(); break;
+		case 1:  v2->y = v1->y; v2->x = TestCoord(); break;
+		case 2:  v2->x = v1->x + 64; v2->y = v1->y + 64; break;
+		default: v2->x = TestCoord(); v2->y = TestCoord(); break;
+	}
+
+	ld->dx = v2->x - v1->x;
+	ld->dy = v2->y - v1->y;
+
+	if (! ld->dx)
+		ld->slopetype = ST_VERTICAL;
+	else if (! ld->dy)
+		ld->slopetype = ST_HORIZONTAL;
+	else if (ld->dy / ld->dx > 0)
+		ld->slopetype = ST_POSITIVE;
+	else
+		ld->slopetype = ST_NEGATIVE;
+
+	// sometimes a stale slope type, as polyobjects could leave
+	if (TestRandom(16) < 1)
+		ld->slopetype = (slopetype_t)(int)TestRandom(4);
+}
+
+static void TestBox(float *bbox, const line_t *near_line)
+{
+	float x = near_line->v1->x + TestRandom(2.0f) * near_line->dx;
+	float y = near_line->v1->y + TestRandom(2.0f) * near_line->dy;
+
+	if (TestRandom(4) < 1)
+	{
+		// exactly on the line's start
+		x = near_line->v1->x;
+		y = near_line->v1->y;
+	}
+
+	float r = (float)(int)TestRandom(128.0f);
+
+	bbox[BOXLEFT]   = x - r;
+	bbox[BOXRIGHT]  = x + r;
+	bbox[BOXBOTTOM] = y - r;
+	bbox[BOXTOP]    = y + r;
+}
+
+
+#define TEST_LINES  23
+
+static int TestGroup(line_t *group[TEST_LINES], const float *bbox)
+{
+	int errors = 0;
+
+	float x1[TEST_LINES], y1[TEST_LINES];
+	float x2[TEST_LINES], y2[TEST_LINES];
+
+	int results[TEST_LINES];
+
+	for (int i = 0; i < TEST_LINES; i++)
+	{
+		x1[i] = group[i]->v1->x;  y1[i] = group[i]->v1->y;
+		x2[i] = group[i]->v2->x;  y2[i] = group[i]->v2->y;
+	}
+
+	// P_BoxOnLinesSide
+
+	P_BoxOnLinesSide(bbox, group, TEST_LINES, results);
+
+	for (int i = 0; i < TEST_LINES; i++)
+		if (results[i] != P_BoxOnLineSide(bbox, group[i]))
+			errors++;
+
+	// P_LinesTouchingBox (the line boxes come from the end points)
+
+	float left[TEST_LINES], right[TEST_LINES];
+	float bottom[TEST_LINES], top[TEST_LINES];
+
+	for (int i = 0; i < TEST_LINES; i++)
+	{
+		left[i]   = MIN(x1[i], x2[i]);  right[i] = MAX(x1[i], x2[i]);
+		bottom[i] = MIN(y1[i], y2[i]);  top[i]   = MAX(y1[i], y2[i]);
+	}
+
+	int num = P_LinesTouchingBox(left, right, bottom, top, TEST_LINES,
+			bbox[BOXLEFT], bbox[BOXBOTTOM], bbox[BOXRIGHT], bbox[BOXTOP], results);
+	int k = 0;
+
+	for (int i = 0; i < TEST_LINES; i++)
+	{
+		if (right[i] <= bbox[BOXLEFT]  || left[i]   >= bbox[BOXRIGHT] ||
+			top[i]   <= bbox[BOXBOTTOM] || bottom[i] >= bbox[BOXTOP])
+			continue;
+
+		if (k >= num || results[k] != i)
+			errors++;
+		k++;
+	}
+
+	if (k != num)
+		errors++;
+
+	// P_LinesCrossingDivline, through the middle of the box
+
+	divline_t div;
+
+	div.x  = (bbox[BOXLEFT] + bbox[BOXRIGHT]) / 2.0f;
+	div.y  = (bbox[BOXBOTTOM] + bbox[BOXTOP]) / 2.0f;
+	div.dx = (TestRandom(8) < 1) ? 0 : TestCoord();
+	div.dy = (TestRandom(8) < 1) ? 0 : TestCoord();
+
+	num = P_LinesCrossingDivline(&div, x1, y1, x2, y2, TEST_LINES, results);
+	k = 0;
+
+	for (int i = 0; i < TEST_LINES; i++)
+	{
+		if (P_PointOnDivlineSide(x1[i], y1[i], &div) ==
+			P_PointOnDivlineSide(x2[i], y2[i], &div))
+			continue;
+
+		if (k >= num || results[k] != i)
+			errors++;
+		k++;
+	}
+
+	if (k != num)
+		errors++;
+
+	return errors;
+}
+
+
+void P_SimdSelfTest(void)
+{
+	const int ROUNDS = 20000;
+
+#ifdef SIMD_KERNELS
+	I_Printf("Testing SIMD playsim kernels against the scalar code...\n");
+#else
+	I_Printf("No SIMD playsim kernels in this build, testing the fallbacks...\n");
+#endif
+
+	test_seed = 1;
+
+	line_t   *group[TEST_LINES];
+	line_t    fake_lines[TEST_LINES];
+	vertex_t  fake_verts[TEST_LINES * 2];
+
+	float bbox[4];
+
+	int errors = 0;
+
+	for (int r = 0; r < ROUNDS; r++)
+	{
+		for (int i = 0; i < TEST_LINES; i++)
+		{
+			TestLine(&fake_lines[i], &fake_verts[i*2], &fake_verts[i*2 + 1]);
+			group[i] = &fake_lines[i];
+		}
+
+		TestBox(bbox, group[(int)TestRandom(TEST_LINES)]);
+
+		errors += TestGroup(group, bbox);
+	}
+
+	I_Printf("  random lines: %d groups, %d errors\n", ROUNDS, errors);
+
+	if (numlines < TEST_LINES)
+		return;
+
+	errors = 0;
+
+	for (int r = 0; r < ROUNDS; r++)
+	{
+		for (int i = 0; i < TEST_LINES; i++)
+			group[i] = &lines[(int)TestRandom(numlines)];
+
+		TestBox(bbox, group[(int)TestRandom(TEST_LINES)]);
+
+		errors += TestGroup(group, bbox);
+	}
+
+	I_Printf("  level lines: %d groups, %d errors\n", ROUNDS, errors);
+}
+
+//--- editor settings ---
+// vi:ts=4:sw=4:noexpandtab
@@ -0,0 +1,52 @@
+//----------------------------------------------------------------------------
+//  EDGE Playsim SIMD kernels
+//----------------------------------------------------------------------------
+//
+//  Copyright (c) 2023  The EDGE Team.
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//----------------------------------------------------------------------------
+
+#ifndef __P_SIMD_H__
+#define __P_SIMD_H__
+
+// These work on several lines at once, and must always give exactly
+// the same answers as the scalar routines in p_maputl.cc, otherwise
+// demos and network games would go out of sync.
+
+int P_LinesCrossingDivline(divline_t *div, const float *x1, const float *y1,
+						   const float *x2, const float *y2, int count,
+						   int *crossing);
+// finds the lines (given by their end points) whose ends are on
+// opposite sides of the divline, as decided by P_PointOnDivlineSide.
+// Their indices are stored in 'crossing' (which needs room for
+// 'count' entries), and the number found is returned.
+
+int P_LinesTouchingBox(const float *left, const float *right,
+					   const float *bottom, const float *top, int count,
+					   float x1, float y1, float x2, float y2, int *touching);
+// finds the line bounding boxes (given as separate arrays of each
+// edge) which overlap the box (x1,y1)-(x2,y2), using the same test as
+// P_BlockLinesIterator.  Works like P_LinesCrossingDivline.
+
+void P_BoxOnLinesSide(const float *tmbox, line_t * const *lines, int count,
+					  int *sides);
+// stores P_BoxOnLineSide(tmbox, lines[i]) in sides[i] for each line.
+
+void P_SimdSelfTest(void);
+// checks the kernels against the scalar code, using random values and
+// the lines of the current level, and prints the results.
+
+#endif /* __P_SIMD_H__ */
+
+//--- editor settings ---
+// vi:ts=4:sw=4:noexpandtab
@@ -31,6 +31,8 @@
 
 #include <limits.h>
 
+#include <unordered_map>
+
 #include "con_main.h"
 #include "dm_data.h"
 #include "dm_defs.h"
@@ -237,6 +239,75 @@ float P_FindRaiseToTexture(sector_t * sec)
 	return sec->f_h + minsize;
 }
 
+//
+// Tag index
+//
+// For each tag used on the level, remember the first sector and the
+// first line having it.  The others are reached by following the
+// tag_next links, which go in map order, so walking a chain visits
+// the same things (in the same order) as scanning the whole array.
+//
+// Tags never change once the level is loaded, so the index is built
+// once by P_SetupLevel and thrown away by P_ShutdownLevel.
+//
+static std::unordered_map<int, sector_t *> sector_tags;
+static std::unordered_map<int, line_t *>   line_tags;
+
+void P_IndexSectorTags(void)
+{
+	std::unordered_map<int, sector_t *> last;
+
+	sector_tags.clear();
+
+	for (int i = 0; i < numsectors; i++)
+	{
+		sector_t *sec = sectors + i;
+
+		sec->tag_next = sec->tag_prev = NULL;
+
+		sector_t *& prev = last[sec->tag];
+
+		if (prev)
+		{
+			prev->tag_next = sec;
+			sec->tag_prev  = prev;
+		}
+		else
+			sector_tags[sec->tag] = sec;
+
+		prev = sec;
+	}
+}
+
+void P_IndexLineTags(void)
+{
+	std::unordered_map<int, line_t *> last;
+
+	line_tags.clear();
+
+	for (int i = 0; i < numlines; i++)
+	{
+		line_t *ld = lines + i;
+
+		ld->tag_next = NULL;
+
+		line_t *& prev = last[ld->tag];
+
+		if (prev)
+			prev->tag_next = ld;
+		else
+			line_tags[ld->tag] = ld;
+
+		prev = ld;
+	}
+}
+
+void P_ClearTagIndex(void)
+{
+	sector_tags.clear();
+	line_tags.clear();
+}
+
 //
 // Returns the FIRST sector that tag refers to.
 //
@@ -245,15 +316,25 @@ float P_FindRaiseToTexture(sector_t * sec)
 //
 sector_t *P_FindSectorFromTag(int tag)
 {
-	int i;
+	std::unordered_map<int, sector_t *>::iterator it = sector_tags.find(tag);
 
-	for (i = 0; i < numsectors; i++)
-	{
-		if (sectors[i].tag == tag)
-			return sectors + i;
-	}
+	if (it == sector_tags.end())
+		return NULL;
+
+	return it->second;
+}
+
+//
+// Returns the FIRST line that tag refers to.
+//
+line_t *P_FindLineFromTag(int tag)
+{
+	std::unordered_map<int, line_t *>::iterator it = line_tags.find(tag);
 
-	return NULL;
+	if (it == line_tags.end())
+		return NULL;
+
+	return it->second;
 }
 
 //
@@ -700,16 +781,11 @@ static void P_PortalEffect(line_t *ld)
 
 	bool is_camera = (ld->special->portal_effect & PORTFX_Camera) ? true : false;
 
-	for (int i=0; i < numlines; i++)
+	for (line_t *other = P_FindLineFromTag(ld->tag); other; other = other->tag_next)
 	{
-		line_t *other = lines + i;
-
 		if (other == ld)
 			continue;
 
-		if (other->tag != ld->tag)
-			continue;
-
 		float h1 = ld->frontsector->c_h - ld->frontsector->f_h;
 		float h2 = other->frontsector->c_h - other->frontsector->f_h;
 
@@ -937,8 +1013,6 @@ static bool P_ActivateSpecialLine(line_t * line,
 	sfx_t *sfx[4];
 	sector_t *tsec;
 
-	int i;
-
 	if (!special)
 	{
 		if (line == NULL)
@@ -1190,11 +1264,9 @@ static bool P_ActivateSpecialLine(line_t * line,
 		}
 		else if (tag)
 		{
-			for (i = 0; i < numlines; i++)
+			for (line_t *other = P_FindLineFromTag(tag); other; other = other->tag_next)
 			{
-				line_t *other = lines + i;
-
-				if (other->tag == tag && other != line)
+				if (other != line)
 					if (EV_DoSlider(other, line, thing, special))
 						texSwitch = true;
 			}
@@ -1256,13 +1328,10 @@ static bool P_ActivateSpecialLine(line_t * line,
 		}
 		else
 		{
-			for (i=0; i < numlines; i++)
+			for (line_t *other = P_FindLineFromTag(tag); other; other = other->tag_next)
 			{
-				if (lines[i].tag == tag)
-				{
-					P_LineEffect(lines + i, line, special);
-					texSwitch = true;
-				}
+				P_LineEffect(other, line, special);
+				texSwitch = true;
 			}
 		}
 	}
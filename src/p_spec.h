@@ -168,11 +168,14 @@ extern int levelTimeCount;
 extern linetype_c donut[2];
 
 // at map load
+void P_IndexSectorTags(void);
+void P_IndexLineTags(void);
 void P_SpawnSpecials1(void);
 void P_SpawnSpecials2(int autotag);
 
 // at map exit
 void P_StopAmbientSectorSfx(void);
+void P_ClearTagIndex(void);
 
 // every tic
 void P_UpdateSpecials(void);
@@ -197,6 +200,7 @@ sector_t *P_GetNextSector(const line_t * line, const sector_t * sec,
 float P_FindSurroundingHeight(const heightref_e ref, const sector_t *sec);
 float P_FindRaiseToTexture(sector_t * sec);  // -KM- 1998/09/01 New func, old inline
 sector_t *P_FindSectorFromTag(int tag);
+line_t *P_FindLineFromTag(int tag);
 int P_FindMinSurroundingLight(sector_t * sector, int max);
 
 // start an action...
@@ -107,22 +107,23 @@ static void StartButton(switchdef_c *sw, line_t *line, bwhere_e w,
 void P_ChangeSwitchTexture(line_t * line, bool useAgain,
 		line_special_e specials, bool noSound)
 {
-	for (int j = 0; j < numlines; j++)
+	// without a tag only this line is switched, otherwise every line
+	// having the tag (in map order, which includes this line).
+	bool whole_tag = (line->tag != 0 && ! (specials & LINSP_SwitchSeparate));
+
+	line_t *ld = whole_tag ? P_FindLineFromTag(line->tag) : line;
+
+	for (; ld; ld = whole_tag ? ld->tag_next : NULL)
 	{
-		if (line != &lines[j])
+		if (ld != line)
 		{
-			if (line->tag == 0 ||
-				line->tag != lines[j].tag ||
-                (specials & LINSP_SwitchSeparate) ||
-                (useAgain && line->special && line->special != lines[j].special))
-			{
+			if (useAgain && line->special && line->special != ld->special)
 				continue;
-			}
 		}
 
-		side_t *side = lines[j].side[0];
+		side_t *side = ld->side[0];
 
-		position_c *sfx_origin = &lines[j].frontsector->sfx_origin;
+		position_c *sfx_origin = &ld->frontsector->sfx_origin;
 
 		bwhere_e pos = BWH_None;
 
@@ -174,12 +175,12 @@ void P_ChangeSwitchTexture(line_t * line, bool useAgain,
 				}
 
 				if (useAgain)
-					StartButton(sw, &lines[j], pos, OLD_SW);
+					StartButton(sw, ld, pos, OLD_SW);
 
 				break;
 			}
 		}   // it.IsValid() - switchdefs
-	}   // j < numlines
+	}   // ld
 }
 
 #undef CHECK_SW
@@ -40,25 +40,14 @@
 
 static sector_t *FindTeleportSec(int tag)
 {
-    for (int i = 0; i < numsectors; i++)
-    {
-        if (sectors[i].tag != tag)
-            continue;
-
-		return sectors + i;
-    }
-
-    return NULL;  // not found
+    return P_FindSectorFromTag(tag);  // NULL if not found
 }
 
 static mobj_t *FindTeleportMan(int tag, const mobjtype_c *info)
 {
-    for (int i = 0; i < numsectors; i++)
+    for (sector_t *sec = P_FindSectorFromTag(tag); sec; sec = sec->tag_next)
     {
-        if (sectors[i].tag != tag)
-            continue;
-
-        for (subsector_t *sub = sectors[i].subsectors; sub; sub = sub->sec_next)
+        for (subsector_t *sub = sec->subsectors; sub; sub = sub->sec_next)
         {
             for (mobj_t *mo = sub->thinglist; mo; mo = mo->snext)
                 if (mo->info == info &&
@@ -72,15 +61,10 @@ static mobj_t *FindTeleportMan(int tag, const mobjtype_c *info)
 
 static line_t *FindTeleportLine(int tag, line_t *original)
 {
-    for (int i = 0; i < numlines; i++)
+    for (line_t *ld = P_FindLineFromTag(tag); ld; ld = ld->tag_next)
     {
-        if (lines[i].tag != tag)
-            continue;
-
-        if (lines + i == original)
-            continue;
-
-        return lines + i;
+        if (ld != original)
+            return ld;
     }
 
     return NULL;  // not found
@@ -283,7 +267,7 @@ bool EV_Teleport(line_t* line, int tag, mobj_t* thing,
     }
     else if (thing->flags & MF_MISSILE)
     {
-        new_z += thing->origheight;
+        new_z += thing->cold->origheight;
     }
 
     if (!P_TeleportMove(thing, new_x, new_y, new_z))
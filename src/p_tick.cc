@@ -32,11 +32,14 @@
 #include "system/i_defs.h"
 #include "p_tick.h"
 
+#include <vector>
+
 #include "dm_state.h"
 #include "g_game.h"
 #include "n_network.h"
 #include "p_local.h"
 #include "p_spec.h"
+#include "r_misc.h"
 #include "rad_trig.h"
 
 int leveltime;
@@ -80,6 +83,8 @@ void P_Ticker(void)
 	P_UpdateSpecials();
 	P_MobjItemRespawn();
 
+	P_CrushStatsTic();
+
 	// for par times
 	leveltime++;
 
@@ -107,5 +112,114 @@ void P_HubFastForward(void)
 	fast_forward_active = false;
 }
 
+
+//
+// P_BenchmarkTics
+//
+// Spawns 'count' monsters of the given type at random spots of the
+// current level, sets them chasing the player and times 'tics' game
+// tics, without drawing anything.  The monsters are removed again
+// afterwards, but the level is left that many tics further on (and
+// the player may be hurt), so this is meant for test maps.
+//
+void P_BenchmarkTics(int count, int tics, const char *type_name)
+{
+	player_t *p = players[consoleplayer1];
+
+	if (numsectors == 0 || ! p || ! p->mo)
+	{
+		I_Printf("No level loaded.\n");
+		return;
+	}
+
+	if (netgame || demorecording || demoplayback)
+	{
+		I_Printf("Cannot benchmark in a netgame or demo.\n");
+		return;
+	}
+
+	const mobjtype_c *info = mobjtypes.Find(type_name);
+
+	if (! info || info->chase_state == 0)
+	{
+		I_Printf("Unknown monster type: %s\n", type_name);
+		return;
+	}
+
+	std::vector<mobj_t *> spawned;
+
+	// the same spots every time, without touching the game's RNG
+	u32_t seed = 1;
+
+	float width  = bmap_width  * BLOCKMAP_UNIT;
+	float height = bmap_height * BLOCKMAP_UNIT;
+
+	for (int tries = 0; tries < count * 8 && (int)spawned.size() < count; tries++)
+	{
+		seed = seed * 1103515245 + 12345;
+		float x = bmap_orgx + (seed >> 8) % (int)width;
+
+		seed = seed * 1103515245 + 12345;
+		float y = bmap_orgy + (seed >> 8) % (int)height;
+
+		// only spots inside the level
+		subsector_t *sub = R_PointInSubsector(x, y);
+
+		if (sub->sector->c_h - sub->sector->f_h < info->height)
+			continue;
+
+		mobj_t *mo = P_MobjCreateObject(x, y, ONFLOORZ, info);
+
+		if (! P_CheckAbsPosition(mo, mo->x, mo->y, mo->z))
+		{
+			P_RemoveMobj(mo);
+			continue;
+		}
+
+		mo->SetTarget(p->mo);
+
+		P_SetMobjStateDeferred(mo, info->chase_state, 0);
+
+		// keep it from being freed while the tics run (the reference
+		// is dropped again below, before it is removed)
+		mo->refcount++;
+
+		spawned.push_back(mo);
+	}
+
+	I_Printf("Tic benchmark: %d %s spawned, mobj_t %d + %d bytes\n",
+		(int)spawned.size(), type_name,
+		(int)sizeof(mobj_t), (int)sizeof(mobj_cold_t));
+
+	u32_t total = 0;
+	u32_t worst = 0;
+
+	for (int t = 0; t < tics; t++)
+	{
+		u32_t start = I_ReadMicroSeconds();
+
+		P_Ticker();
+
+		u32_t spent = I_ReadMicroSeconds() - start;
+
+		total += spent;
+		worst  = MAX(worst, spent);
+	}
+
+	I_Printf("  %d tics in %1.1f ms: %1.2f ms per tic, worst %1.2f ms\n",
+		tics, total / 1000.0, tics ? total / 1000.0 / tics : 0.0,
+		worst / 1000.0);
+
+	for (int i = 0; i < (int)spawned.size(); i++)
+	{
+		mobj_t *mo = spawned[i];
+
+		mo->refcount--;
+
+		if (! mo->isRemoved())
+			P_RemoveMobj(mo);
+	}
+}
+
 //--- editor settings ---
 // vi:ts=4:sw=4:noexpandtab
@@ -33,6 +33,8 @@ void P_Ticker(void);
 
 void P_HubFastForward(void);
 
+void P_BenchmarkTics(int count, int tics, const char *type_name);
+
 #endif // __P_TICK__
 
 //--- editor settings ---
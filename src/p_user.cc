@@ -241,7 +241,7 @@ void P_PlayerJump(player_t *pl, float dz, int wait)
 		pl->jumpwait = wait;
 
 	// enter the JUMP states (if present)
-	statenum_t jump_st = P_MobjFindLabel(pl->mo, "JUMP");
+	statenum_t jump_st = P_MobjFindLabelID(pl->mo, SLAB_JUMP);
 	if (jump_st != S_NULL)
 		P_SetMobjStateDeferred(pl->mo, jump_st, 0);
 
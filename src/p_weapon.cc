@@ -68,9 +68,9 @@ static void P_SetPsprite(player_t * p, int position, int stnum, weapondef_c *inf
 	{
 		state_t *st = &states[stnum];
 
-		if (st->label)
+		if (st->label_id != SLAB_None)
 		{
-			statenum_t new_state = DDF_StateFindLabel(info->state_grp, st->label, true /* quiet */);
+			statenum_t new_state = info->state_labels.Find(info->state_grp, st->label_id);
 			if (new_state != S_NULL)
 				stnum = new_state;
 		}
@@ -1677,12 +1677,12 @@ void A_WeaponDlightSet(mobj_t * mo)
 
 	if (st && st->action_par)
 	{
-		mo->dlight.r = MAX(0.0f, ((int *)st->action_par)[0]);
+		mo->cold->dlight.r = MAX(0.0f, ((int *)st->action_par)[0]);
 
 		if (mo->info->hyperflags & HF_QUADRATIC_COMPAT)
-			mo->dlight.r = DLIT_COMPAT_RAD(mo->dlight.r);
+			mo->cold->dlight.r = DLIT_COMPAT_RAD(mo->cold->dlight.r);
 
-		mo->dlight.target = mo->dlight.r;
+		mo->cold->dlight.target = mo->cold->dlight.r;
 	}
 }
 
@@ -1697,10 +1697,10 @@ void A_WeaponDLightFade(mobj_t * mo)
 
 	if (st && st->action_par)
 	{
-		mo->dlight.target = MAX(0.0f, ((int *)st->action_par)[0]);
+		mo->cold->dlight.target = MAX(0.0f, ((int *)st->action_par)[0]);
 
 		if (mo->info->hyperflags & HF_QUADRATIC_COMPAT)
-			mo->dlight.target = DLIT_COMPAT_RAD(mo->dlight.target);
+			mo->cold->dlight.target = DLIT_COMPAT_RAD(mo->cold->dlight.target);
 	}
 }
 
@@ -0,0 +1,188 @@
+//----------------------------------------------------------------------------
+//  EDGE Playsim Worker Threads
+//----------------------------------------------------------------------------
+//
+//  Copyright (c) 2023  The EDGE Team.
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//----------------------------------------------------------------------------
+//
+//  A small pool of threads which stay asleep until the playsim has a
+//  batch of jobs for them.  The main thread works on the batch too, and
+//  waits until every job is finished, so the callers see no difference
+//  from running the jobs in a loop (apart from the order).
+//
+//----------------------------------------------------------------------------
+
+#include "system/i_defs.h"
+#include "system/i_sdlinc.h"
+
+#include <vector>
+
+#include "con_var.h"
+#include "p_workers.h"
+
+
+// number of threads for the playsim (0 or 1 = none)
+DEF_CVAR(p_threads, int, "c", 0);
+
+#define MAX_WORKERS  16
+
+static std::vector<SDL_Thread *> workers;
+
+// threads asked for (including the main one)
+static int workers_wanted = 1;
+
+// posted once for each worker which should help with a batch, and
+// posted back by that worker once it has run out of jobs.
+static SDL_sem *work_sem;
+static SDL_sem *done_sem;
+
+static SDL_atomic_t workers_quit;
+
+// the current batch
+static int          job_count;
+static worker_job_f job_func;
+static void        *job_data;
+
+static SDL_atomic_t job_next;
+
+
+static void DoJobs(void)
+{
+	for (;;)
+	{
+		int job = SDL_AtomicAdd(&job_next, 1);
+
+		if (job >= job_count)
+			break;
+
+		job_func(job, job_data);
+	}
+}
+
+static int WorkerThreadFunc(void *unused)
+{
+	for (;;)
+	{
+		SDL_SemWait(work_sem);
+
+		if (SDL_AtomicGet(&workers_quit))
+			break;
+
+		DoJobs();
+
+		SDL_SemPost(done_sem);
+	}
+
+	return 0;
+}
+
+int P_WorkerThreads(void)
+{
+	return CLAMP(1, MIN(p_threads, SDL_GetCPUCount()), MAX_WORKERS);
+}
+
+static void P_StartWorkers(int threads)
+{
+	if (workers_wanted == threads)
+		return;
+
+	P_StopWorkers();
+
+	workers_wanted = threads;
+
+	if (threads < 2)
+		return;
+
+	work_sem = SDL_CreateSemaphore(0);
+	done_sem = SDL_CreateSemaphore(0);
+
+	if (! work_sem || ! done_sem)
+	{
+		I_Warning("P_StartWorkers: %s (playsim stays on the main thread)\n", SDL_GetError());
+		return;
+	}
+
+	SDL_AtomicSet(&workers_quit, 0);
+
+	// the main thread is one of the workers
+	for (int t = 1; t < threads; t++)
+	{
+		SDL_Thread *thread = SDL_CreateThread(WorkerThreadFunc, "EDGE Playsim", NULL);
+
+		if (! thread)
+		{
+			I_Warning("P_StartWorkers: %s\n", SDL_GetError());
+			break;
+		}
+
+		workers.push_back(thread);
+	}
+}
+
+void P_StopWorkers(void)
+{
+	if (! workers.empty())
+	{
+		SDL_AtomicSet(&workers_quit, 1);
+
+		for (int t = 0; t < (int)workers.size(); t++)
+			SDL_SemPost(work_sem);
+
+		for (int t = 0; t < (int)workers.size(); t++)
+			SDL_WaitThread(workers[t], NULL);
+
+		workers.clear();
+	}
+
+	if (work_sem)
+	{
+		SDL_DestroySemaphore(work_sem);
+		work_sem = NULL;
+	}
+
+	if (done_sem)
+	{
+		SDL_DestroySemaphore(done_sem);
+		done_sem = NULL;
+	}
+
+	workers_wanted = 1;
+}
+
+void P_RunJobs(int count, worker_job_f func, void *data)
+{
+	if (count <= 0)
+		return;
+
+	P_StartWorkers(P_WorkerThreads());
+
+	job_count = count;
+	job_func  = func;
+	job_data  = data;
+
+	SDL_AtomicSet(&job_next, 0);
+
+	int helpers = MIN((int)workers.size(), count - 1);
+
+	for (int t = 0; t < helpers; t++)
+		SDL_SemPost(work_sem);
+
+	DoJobs();
+
+	for (int t = 0; t < helpers; t++)
+		SDL_SemWait(done_sem);
+}
+
+//--- editor settings ---
+// vi:ts=4:sw=4:noexpandtab
@@ -0,0 +1,41 @@
+//----------------------------------------------------------------------------
+//  EDGE Playsim Worker Threads
+//----------------------------------------------------------------------------
+//
+//  Copyright (c) 2023  The EDGE Team.
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//----------------------------------------------------------------------------
+
+#ifndef __P_WORKERS_H__
+#define __P_WORKERS_H__
+
+typedef void (* worker_job_f)(int job, void *data);
+
+int P_WorkerThreads(void);
+// returns how many threads (including the main one) P_RunJobs will
+// use, based on the p_threads cvar and the number of CPUs.  A result
+// of 1 means everything runs on the main thread.
+
+void P_RunJobs(int count, worker_job_f func, void *data);
+// calls func(job, data) for each job from 0 to count-1, spread over
+// the worker threads, and returns once all of them are done.  The jobs
+// run in no particular order, hence they must never touch the same
+// things.
+
+void P_StopWorkers(void);
+// ends the worker threads.  They are started again when needed.
+
+#endif /* __P_WORKERS_H__ */
+
+//--- editor settings ---
+// vi:ts=4:sw=4:noexpandtab
@@ -90,6 +90,10 @@ typedef struct touch_node_s
 	struct sector_s *sec;
 	struct touch_node_s *sec_next;
 	struct touch_node_s *sec_prev;
+
+	// where this node is in the sector's compact array of things
+	// (see P_SectorThingsIterator).
+	int sec_index;
 }
 touch_node_t;
 
@@ -417,9 +421,6 @@ typedef struct line_s
 	// To aid move clipping.
 	slopetype_t slopetype;
 
-	// if == validcount, already checked
-	int validcount;
-
 	// whether this linedef is "blocking" for rendering purposes.
 	// Always true for 1s lines.  Always false when both sides of the
 	// line reference the same sector.
@@ -444,6 +445,9 @@ typedef struct line_s
 	struct slider_move_s *slider_move;
 
 	struct line_s *portal_pair;
+
+	// next line with the same tag, in map order (see P_IndexLineTags)
+	struct line_s *tag_next;
 }
 line_t;
 
@@ -1114,9 +1114,9 @@ static void DLIT_Model(mobj_t *mo, void *dataptr)
 	if (mo == data->mo)
 		return;
 
-	SYS_ASSERT(mo->dlight.shader);
+	SYS_ASSERT(mo->cold->dlight.shader);
 
-	ShadeNormals(mo->dlight.shader, data);
+	ShadeNormals(mo->cold->dlight.shader, data);
 }
 
 static void DLIT_CollectLights(mobj_t *mo, void *dataptr)
@@ -1539,11 +1539,11 @@ static void DLIT_Wall(mobj_t *mo, void *dataptr)
 
 	R_ColorMapUpdate(NULL, cur_sub->sector->lightcolor, cur_sub->sector->desaturation); // FIXME: shouldn't this use colormaps properly too?
 
-	SYS_ASSERT(mo->dlight.shader);
+	SYS_ASSERT(mo->cold->dlight.shader);
 
 	int blending = (data->blending & ~BL_Alpha) | BL_Add;
 
-	mo->dlight.shader->WorldMix(GL_POLYGON, data->v_count, data->tex_id,
+	mo->cold->dlight.shader->WorldMix(GL_POLYGON, data->v_count, data->tex_id,
 			data->trans, &data->pass, blending, data->mid_masked,
 			data, WallCoordFunc);
 }
@@ -1554,11 +1554,11 @@ static void GLOWLIT_Wall(mobj_t *mo, void *dataptr)
 
 	R_ColorMapUpdate(NULL, cur_sub->sector->lightcolor, cur_sub->sector->desaturation); // FIXME: shouldn't this use colormaps properly too?
 
-	SYS_ASSERT(mo->dlight.shader);
+	SYS_ASSERT(mo->cold->dlight.shader);
 
 	int blending = (data->blending & ~BL_Alpha) | BL_Add;
 
-	mo->dlight.shader->WorldMix(GL_POLYGON, data->v_count, data->tex_id,
+	mo->cold->dlight.shader->WorldMix(GL_POLYGON, data->v_count, data->tex_id,
 			data->trans, &data->pass, blending, data->mid_masked,
 			data, WallCoordFunc);
 }
@@ -1584,11 +1584,11 @@ static void DLIT_Plane(mobj_t *mo, void *dataptr)
 
 	R_ColorMapUpdate(NULL, cur_sub->sector->lightcolor, cur_sub->sector->desaturation); // FIXME: shouldn't this use colormaps properly too?
 
-	SYS_ASSERT(mo->dlight.shader);
+	SYS_ASSERT(mo->cold->dlight.shader);
 
 	int blending = (data->blending & ~BL_Alpha) | BL_Add;
 
-	mo->dlight.shader->WorldMix(GL_POLYGON, data->v_count, data->tex_id,
+	mo->cold->dlight.shader->WorldMix(GL_POLYGON, data->v_count, data->tex_id,
 			data->trans, &data->pass, blending, false /* masked */,
 			data, PlaneCoordFunc);
 }
@@ -1599,11 +1599,11 @@ static void GLOWLIT_Plane(mobj_t *mo, void *dataptr)
 
 	R_ColorMapUpdate(NULL, cur_sub->sector->lightcolor, cur_sub->sector->desaturation); // FIXME: shouldn't this use colormaps properly too?
 
-	SYS_ASSERT(mo->dlight.shader);
+	SYS_ASSERT(mo->cold->dlight.shader);
 
 	int blending = (data->blending & ~BL_Alpha) | BL_Add;
 
-	mo->dlight.shader->WorldMix(GL_POLYGON, data->v_count, data->tex_id,
+	mo->cold->dlight.shader->WorldMix(GL_POLYGON, data->v_count, data->tex_id,
 			data->trans, &data->pass, blending, false,
 			data, PlaneCoordFunc);
 }
@@ -2425,7 +2425,7 @@ static void DLIT_Flood(mobj_t *mo, void *dataptr)
 
 	// NOTE: distance already checked in P_DynamicLightIterator
 
-	SYS_ASSERT(mo->dlight.shader);
+	SYS_ASSERT(mo->cold->dlight.shader);
 
 	float sx = cur_seg->v1->x;
 	float sy = cur_seg->v1->y;
@@ -2450,7 +2450,7 @@ static void DLIT_Flood(mobj_t *mo, void *dataptr)
 
 		R_ColorMapUpdate(NULL, cur_sub->sector->lightcolor, cur_sub->sector->desaturation); // FIXME: shouldn't this use colormaps properly too?
 
-		mo->dlight.shader->WorldMix(GL_QUAD_STRIP, data->v_count,
+		mo->cold->dlight.shader->WorldMix(GL_QUAD_STRIP, data->v_count,
 				data->tex_id, 1.0, &data->pass, blending, false,
 				data, FloodCoordFunc);
 	}
@@ -4298,7 +4298,6 @@ void R_Render(int x, int y, int w, int h, mobj_t *camera,
 
 	// Profiling
 	framecount++;
-	validcount++;
 
 	RGL_RenderTrueBSP();
 }
@@ -221,15 +221,15 @@ private:
 	inline float WhatRadius(int DL)
 	{
 		if (DL == 0)
-			return mo->dlight.r * MIR_XYScale();
+			return mo->cold->dlight.r * MIR_XYScale();
 
-		return mo->info->dlight[1].radius * mo->dlight.r /
+		return mo->info->dlight[1].radius * mo->cold->dlight.r /
 			   mo->info->dlight[0].radius * MIR_XYScale();
 	}
 
 	inline rgbcol_t WhatColor(int DL)
 	{
-		return (DL == 0) ? mo->dlight.color : mo->info->dlight[1].colour;
+		return (DL == 0) ? mo->cold->dlight.color : mo->info->dlight[1].colour;
 	}
 
 	inline dlight_type_e WhatType(int DL)
@@ -434,15 +434,15 @@ private:
 	inline float WhatRadius(int DL)
 	{
 		if (DL == 0)
-			return mo->dlight.r * MIR_XYScale();
+			return mo->cold->dlight.r * MIR_XYScale();
 
-		return mo->info->dlight[1].radius * mo->dlight.r /
+		return mo->info->dlight[1].radius * mo->cold->dlight.r /
 			   mo->info->dlight[0].radius * MIR_XYScale();
 	}
 
 	inline rgbcol_t WhatColor(int DL)
 	{
-		return (DL == 0) ? mo->dlight.color : mo->info->dlight[1].colour;
+		return (DL == 0) ? mo->cold->dlight.color : mo->info->dlight[1].colour;
 	}
 
 	inline dlight_type_e WhatType(int DL)
@@ -629,9 +629,9 @@ public:
 		if (L > 1/256.0)
 		{
 			if (mo->info->dlight[0].type == DLITE_Add)
-				col->add_Give(mo->dlight.color, L);
+				col->add_Give(mo->cold->dlight.color, L);
 			else
-				col->mod_Give(mo->dlight.color, L);
+				col->mod_Give(mo->cold->dlight.color, L);
 		}
 	}
 
@@ -121,9 +121,9 @@ static void DLIT_PSprite(mobj_t *mo, void *dataptr)
 {
 	psprite_coord_data_t *data = (psprite_coord_data_t *)dataptr;
 
-	SYS_ASSERT(mo->dlight.shader);
+	SYS_ASSERT(mo->cold->dlight.shader);
 
-	mo->dlight.shader->Sample(data->col + 0,
+	mo->cold->dlight.shader->Sample(data->col + 0,
 			data->lit_pos.x, data->lit_pos.y, data->lit_pos.z);
 }
 
@@ -621,7 +621,7 @@ void RGL_DrawWeaponModel(player_t * p)
 	case MODEL_MD5_UNIFIED:
 
 		//TODO: w->model_bias
-		MD5_RenderModel(md,p->mo->model_last_animfile,last_frame,p->mo->state->animfile,psp->state->frame,lerp,
+		MD5_RenderModel(md,p->mo->cold->model_last_animfile,last_frame,p->mo->state->animfile,psp->state->frame,lerp,
 				epi::vec3_c(x,y,z),
 				epi::vec3_c(w->model_aspect,w->model_aspect,w->model_zaspect),
 				epi::vec3_c(0,0,w->model_bias),
@@ -1151,7 +1151,7 @@ static void RGL_DrawModel(drawthing_t *dthing)
 	modeldef_c *md = W_GetModel(mo->state->sprite);
 
 
-	if (! md->skins[mo->model_skin].img)
+	if (! md->skins[mo->cold->model_skin].img)
 	{
 		//I_Debugf("Render model: no skin %d\n", mo->model_skin);
 	}
@@ -1167,9 +1167,9 @@ static void RGL_DrawModel(drawthing_t *dthing)
 	int last_frame = mo->state->frame;
 	float lerp = 0.0;
 
-	if (mo->model_last_frame >= 0)
+	if (mo->cold->model_last_frame >= 0)
 	{
-		last_frame = mo->model_last_frame;
+		last_frame = mo->cold->model_last_frame;
 
 		SYS_ASSERT(mo->state->tics > 1);
 
@@ -1180,7 +1180,7 @@ static void RGL_DrawModel(drawthing_t *dthing)
 
 	if (md->modeltype == MODEL_MD2)
 	{
-		MD2_RenderModel(md->model, &md->skins[mo->model_skin], false,
+		MD2_RenderModel(md->model, &md->skins[mo->cold->model_skin], false,
 					last_frame, mo->state->frame, lerp,
 						dthing->mx, dthing->my, z, mo, mo->props,
 						mo->info->model_scale, mo->info->model_aspect,
@@ -1190,7 +1190,7 @@ static void RGL_DrawModel(drawthing_t *dthing)
 	{
 		//TODO add skin_img support
 		MD5_RenderModel(md,
-			mo->model_last_animfile, last_frame,
+			mo->cold->model_last_animfile, last_frame,
 			mo->state->animfile, mo->state->frame, lerp,
 			epi::vec3_c(dthing->mx, dthing->my, z),
 			epi::vec3_c(1.0f,1.0f,1.0f),epi::vec3_c(0,0,0),mo);
@@ -1219,11 +1219,11 @@ static void DLIT_Thing(mobj_t *mo, void *dataptr)
 	if (mo == data->mo)
 		return;
 
-	SYS_ASSERT(mo->dlight.shader);
+	SYS_ASSERT(mo->cold->dlight.shader);
 
 	for (int v = 0; v < 4; v++)
 	{
-		mo->dlight.shader->Sample(data->col + v,
+		mo->cold->dlight.shader->Sample(data->col + v,
 				data->vert[v].x, data->vert[v].y, data->vert[v].z);
 	}
 }
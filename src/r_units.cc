@@ -149,10 +149,10 @@ void RGL_AddLight(mobj_t* mo)
 {
 	bmap_shader.lightParam(bmap_light_count,
 		mo->x, mo->y, mo->z,
-		(float)RGB_RED(mo->dlight.color) / 256.0f,
-		(float)RGB_BLU(mo->dlight.color) / 256.0f,
-		(float)RGB_GRN(mo->dlight.color) / 256.0f,
-		mo->dlight.r);
+		(float)RGB_RED(mo->cold->dlight.color) / 256.0f,
+		(float)RGB_BLU(mo->cold->dlight.color) / 256.0f,
+		(float)RGB_GRN(mo->cold->dlight.color) / 256.0f,
+		mo->cold->dlight.r);
 
 	bmap_light_count++;
 }
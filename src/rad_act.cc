@@ -403,16 +403,16 @@ void RAD_ActSpawnThing(rad_trigger_t *R, void *param)
 
 	P_SetMobjDirAndSpeed(mo, t->angle, t->slope, 0);
 
-	mo->tag = t->tag;
+	mo->cold->tag = t->tag;
 
-	mo->spawnpoint.x = t->x;
-	mo->spawnpoint.y = t->y;
-	mo->spawnpoint.z = t->z;
-	mo->spawnpoint.angle = t->angle;
-	mo->spawnpoint.vertangle = M_ATan(t->slope);
-	mo->spawnpoint.info = minfo;
-	mo->spawnpoint.flags = t->ambush ? MF_AMBUSH : 0;
-	mo->spawnpoint.tag = t->tag;
+	mo->cold->spawnpoint.x = t->x;
+	mo->cold->spawnpoint.y = t->y;
+	mo->cold->spawnpoint.z = t->z;
+	mo->cold->spawnpoint.angle = t->angle;
+	mo->cold->spawnpoint.vertangle = M_ATan(t->slope);
+	mo->cold->spawnpoint.info = minfo;
+	mo->cold->spawnpoint.flags = t->ambush ? MF_AMBUSH : 0;
+	mo->cold->spawnpoint.tag = t->tag;
 
 	if (t->ambush)
 		mo->flags |= MF_AMBUSH;
@@ -421,7 +421,7 @@ void RAD_ActSpawnThing(rad_trigger_t *R, void *param)
 	//       setup the thing to follow the path.
 
 	if (R->info->next_in_path)
-		mo->path_trigger = R->info;
+		mo->cold->path_trigger = R->info;
 }
 
 void RAD_ActDamagePlayers(rad_trigger_t *R, void *param)
@@ -544,7 +544,7 @@ void RAD_ActDamageMonsters(rad_trigger_t *R, void *param)
 		if (info && mo->info != info)
 			continue;
 
-		if (tag && (mo->tag != tag))
+		if (tag && (mo->cold->tag != tag))
 			continue;
 
 		if (! (mo->extendedflags & EF_MONSTER) || mo->health <= 0)
@@ -592,7 +592,7 @@ void RAD_ActThingEvent(rad_trigger_t *R, void *param)
 		if (info && (mo->info != info))
 			continue;
 
-		if (tag && (mo->tag != tag))
+		if (tag && (mo->cold->tag != tag))
 			continue;
 		
 		// ignore certain things (e.g. corpses)
@@ -748,12 +748,12 @@ void RAD_ActChangeTex(rad_trigger_t *R, void *param)
 	// handle the line changers
 	SYS_ASSERT(ctex->what < CHTEX_Sky);
 
-	for (int i=0; i < numlines; i++)
+	for (line_t *ld = P_FindLineFromTag(ctex->tag); ld; ld = ld->tag_next)
 	{
 		side_t *side = (ctex->what <= CHTEX_RightLower) ?
-			lines[i].side[0] : lines[i].side[1];
+			ld->side[0] : ld->side[1];
 
-		if (lines[i].tag != ctex->tag || !side)
+		if (! side)
 			continue;
 
 		if (ctex->subtag && side->sector->tag != ctex->subtag)
@@ -815,7 +815,6 @@ static void MoveOneSector(sector_t *sec, s_movesector_t *t)
 void RAD_ActMoveSector(rad_trigger_t *R, void *param)
 {
 	s_movesector_t *t = (s_movesector_t *) param;
-	int i;
 
 	// SectorV compatibility
 	if (t->tag == 0)
@@ -827,12 +826,8 @@ void RAD_ActMoveSector(rad_trigger_t *R, void *param)
 		return;
 	}
 
-	// OPTIMISE !
-	for (i=0; i < numsectors; i++)
-	{
-		if (sectors[i].tag == t->tag)
-			MoveOneSector(sectors + i, t);
-	}
+	for (sector_t *sec = P_FindSectorFromTag(t->tag); sec; sec = sec->tag_next)
+		MoveOneSector(sec, t);
 }
 
 static void LightOneSector(sector_t *sec, s_lightsector_t *t)
@@ -846,7 +841,6 @@ static void LightOneSector(sector_t *sec, s_lightsector_t *t)
 void RAD_ActLightSector(rad_trigger_t *R, void *param)
 {
 	s_lightsector_t *t = (s_lightsector_t *) param;
-	int i;
 
 	// SectorL compatibility
 	if (t->tag == 0)
@@ -858,12 +852,8 @@ void RAD_ActLightSector(rad_trigger_t *R, void *param)
 		return;
 	}
 
-	// OPTIMISE !
-	for (i=0; i < numsectors; i++)
-	{
-		if (sectors[i].tag == t->tag)
-			LightOneSector(sectors + i, t);
-	}
+	for (sector_t *sec = P_FindSectorFromTag(t->tag); sec; sec = sec->tag_next)
+		LightOneSector(sec, t);
 }
 
 void RAD_ActEnableScript(rad_trigger_t *R, void *param)
@@ -900,15 +890,8 @@ void RAD_ActUnblockLines(rad_trigger_t *R, void *param)
 {
 	s_lineunblocker_t *ub = (s_lineunblocker_t *) param;
 
-	int i;
-
-	for (i=0; i < numlines; i++)
+	for (line_t *ld = P_FindLineFromTag(ub->tag); ld; ld = ld->tag_next)
 	{
-		line_t *ld = lines + i;
-
-		if (ld->tag != ub->tag)
-			continue;
-
 		if (! ld->side[0] || ! ld->side[1])
 			continue;
 
@@ -924,15 +907,8 @@ void RAD_ActBlockLines(rad_trigger_t *R, void *param)
 {
 	s_lineunblocker_t *ub = (s_lineunblocker_t *) param;
 
-	int i;
-
-	for (i=0; i < numlines; i++)
+	for (line_t *ld = P_FindLineFromTag(ub->tag); ld; ld = ld->tag_next)
 	{
-		line_t *ld = lines + i;
-
-		if (ld->tag != ub->tag)
-			continue;
-
 		// set standard flags
 		ld->flags |= (MLF_Blocking | MLF_BlockMonsters);
 	}
@@ -1069,7 +1045,7 @@ void RAD_ActWaitUntilDead(rad_trigger_t *R, void *param)
 
 		// mark the monster
 		mo->hyperflags |= HF_WAIT_UNTIL_DEAD;
-		mo->tag = wud->tag;
+		mo->cold->tag = wud->tag;
 
 		R->wud_count++;
 	}
@@ -445,6 +445,10 @@ typedef struct s_ondeath_s
 	// mobjdef pointer, computed the first time this ONDEATH condition
 	// is tested.
 	const mobjtype_c *cached_info;
+
+	// death count (see RAD_CheckBossTrig) when the condition last
+	// failed, or zero.
+	int failed_deaths;
 }
 s_ondeath_t;
 
@@ -607,6 +611,11 @@ typedef struct rad_trigger_s
 
 	// prevent repeating scripts from clogging the console
 	const char *last_con_message;
+
+	// position in the list, and the tic it was last picked for
+	// checking (see RAD_RunTriggers)
+	int order;
+	int picked_tic;
 }
 rad_trigger_t;
 
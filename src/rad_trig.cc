@@ -34,6 +34,11 @@
 
 #include "system/i_defs.h"
 
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
 #include "../epi/file.h"
 #include "../epi/filesystem.h"
 
@@ -71,6 +76,47 @@ rad_script_t *r_scripts = NULL;
 rad_trigger_t *active_triggers = NULL;
 
 
+//
+// Index of the active triggers.  Radius triggers are placed in the
+// cells of the blockmap grid which their radius touches, so each tic
+// only the triggers near a living player need to be checked.  Other
+// triggers are checked when something can wake them:
+//
+//   - immediate (and whole map) triggers: every tic.
+//   - immediate USE triggers: when a player presses the use key.
+//   - triggers which are counting down a repeat delay, or which are
+//     independent and already activated: every tic, until that ends.
+//
+// The index is rebuilt whenever the list of triggers changes.
+//
+static bool rad_index_valid = false;
+
+static std::vector< std::vector<rad_trigger_t *> > rad_cells;
+
+static std::vector<rad_trigger_t *> rad_always;
+static std::vector<rad_trigger_t *> rad_on_use;
+static std::vector<rad_trigger_t *> rad_awake;
+
+// the triggers to check in the current tic
+static std::vector<rad_trigger_t *> rad_picked;
+
+// the first trigger (in list order) for each tag, rebuilt whenever the
+// list of triggers changes.  The others are found via tag_next.
+static bool rad_tags_valid = false;
+
+static std::unordered_map<int, rad_trigger_t *> rad_tags;
+
+static int rad_tic = 0;
+
+static rad_stats_t rad_stats;
+
+// mobj types used by ONDEATH conditions, and the number of times one
+// of them has died (or gone away).
+static std::unordered_set<const mobjtype_c *> rad_death_types;
+
+static int rad_deaths = 1;
+
+
 class rts_menu_c
 {
 private:
@@ -291,6 +337,19 @@ rts_state_t * RAD_FindStateByLabel(rad_script_t *scr, char *label)
 	return NULL;
 }
 
+static void RAD_BuildTagIndex(void)
+{
+	rad_tags.clear();
+
+	for (rad_trigger_t *trig = active_triggers; trig; trig = trig->next)
+	{
+		// keep the first one
+		rad_tags.insert(std::make_pair(trig->info->tag, trig));
+	}
+
+	rad_tags_valid = true;
+}
+
 //
 // Looks for all current triggers with the given tag number, and
 // either enables them or disables them (based on `disable').
@@ -303,16 +362,17 @@ void RAD_EnableByTag(mobj_t *actor, int tag, bool disable)
 	if (tag <= 0)
 		I_Error("INTERNAL ERROR: RAD_EnableByTag: bad tag %d\n", tag);
 
-	for (trig=active_triggers; trig; trig=trig->next)
-	{
-		if (trig->info->tag == tag)
-			break;
-	}
+	if (! rad_tags_valid)
+		RAD_BuildTagIndex();
+
+	std::unordered_map<int, rad_trigger_t *>::iterator it = rad_tags.find(tag);
 
 	// were there any ?
-	if (! trig)
+	if (it == rad_tags.end())
 		return;
 
+	trig = it->second;
+
 	for (; trig; trig=trig->tag_next)
 	{
 		if (disable)
@@ -419,8 +479,15 @@ static bool RAD_CheckBossTrig(rad_trigger_t *trig, s_ondeath_t *cond)
 				I_Error("RTS ONDEATH: Unknown thing type %d.\n",
 						cond->thing_type);
 		}
+
+		rad_death_types.insert(cond->cached_info);
 	}
 
+	// the number alive can only go down when one of them dies, so
+	// there is no need to count them again until then.
+	if (cond->failed_deaths == rad_deaths)
+		return false;
+
 	// scan the remaining mobjs to see if all bosses are dead
 	for (mo=mobjlisthead; mo != NULL; mo=mo->next)
 	{
@@ -429,7 +496,10 @@ static bool RAD_CheckBossTrig(rad_trigger_t *trig, s_ondeath_t *cond)
 			count++;
 
 			if (count > cond->threshhold)
+			{
+				cond->failed_deaths = rad_deaths;
 				return false;
+			}
 		}
 	}
 
@@ -469,7 +539,7 @@ static bool RAD_CheckHeightTrig(rad_trigger_t *trig,
 
 bool RAD_CheckReachedTrigger(mobj_t * thing)
 {
-	rad_script_t * scr = (rad_script_t *) thing->path_trigger;
+	rad_script_t * scr = (rad_script_t *) thing->cold->path_trigger;
 	rad_trigger_t * trig;
 
 	rts_path_t *path;
@@ -497,7 +567,7 @@ bool RAD_CheckReachedTrigger(mobj_t * thing)
 
 	if (scr->next_path_total == 0)
 	{
-		thing->path_trigger = NULL;
+		thing->cold->path_trigger = NULL;
 		return true;
 	}
 	else if (scr->next_path_total == 1)
@@ -519,12 +589,15 @@ bool RAD_CheckReachedTrigger(mobj_t * thing)
 
 	SYS_ASSERT(path->cached_scr);
 
-	thing->path_trigger = path->cached_scr;
+	thing->cold->path_trigger = path->cached_scr;
 	return true;
 }
 
 static void DoRemoveTrigger(rad_trigger_t *trig)
 {
+	rad_index_valid = false;
+	rad_tags_valid  = false;
+
 	// handle tag linkage
 	if (trig->tag_next)
 		trig->tag_next->tag_prev = trig->tag_prev;
@@ -547,157 +620,353 @@ static void DoRemoveTrigger(rad_trigger_t *trig)
     Z_Free(trig);
 }
 
-//
-// Radius Trigger Event handler.
-//
-void RAD_RunTriggers(void)
+static bool RAD_TriggerAwake(rad_trigger_t *trig)
 {
-	rad_trigger_t *trig, *next;
+	return trig->repeat_delay > 0 ||
+		   (trig->info->tagged_independent && trig->activated);
+}
+
+static void RAD_BuildIndex(void)
+{
+	rad_trigger_t *trig;
+
+	int total_cells = MAX(0, bmap_width * bmap_height);
+
+	rad_cells.resize(total_cells);
+
+	for (int i = 0; i < total_cells; i++)
+		rad_cells[i].clear();
 
-	// Start looking through the trigger list.
-	for (trig=active_triggers; trig; trig=next)
+	rad_always.clear();
+	rad_on_use.clear();
+	rad_awake.clear();
+
+	rad_stats.total = 0;
+	rad_stats.indexed = 0;
+
+	for (trig = active_triggers; trig; trig = trig->next)
 	{
-		next = trig->next;
+		rad_script_t *r = trig->info;
 
-		// stop running all triggers when an RTS menu becomes active
-		if (rts_menuactive)
-			break;
+		trig->order = rad_stats.total++;
+		trig->picked_tic = 0;
 
-		// Don't process, if disabled
-		if (trig->disabled)
+		if (RAD_TriggerAwake(trig))
+			rad_awake.push_back(trig);
+
+		if (r->tagged_immediate && r->tagged_use)
+		{
+			rad_on_use.push_back(trig);
 			continue;
+		}
 
-		// Handle repeat delay (from TAGGED_REPEATABLE).  This must be
-		// done *before* all the condition checks, and that's what makes
-		// it different from `wait_tics'.
-		//
-		if (trig->repeat_delay > 0)
+		if (r->tagged_immediate || r->rad_x < 0 || r->rad_y < 0 || total_cells == 0)
 		{
-			trig->repeat_delay--;
+			rad_always.push_back(trig);
 			continue;
 		}
 
-		// Independent, means you don't have to stay within the trigger
-		// radius for it to operate, It will operate on it's own.
+		int bx1 = CLAMP(0, BLOCKMAP_GET_X(r->x - r->rad_x), bmap_width  - 1);
+		int bx2 = CLAMP(0, BLOCKMAP_GET_X(r->x + r->rad_x), bmap_width  - 1);
+		int by1 = CLAMP(0, BLOCKMAP_GET_Y(r->y - r->rad_y), bmap_height - 1);
+		int by2 = CLAMP(0, BLOCKMAP_GET_Y(r->y + r->rad_y), bmap_height - 1);
+
+		for (int by = by1; by <= by2; by++)
+		for (int bx = bx1; bx <= bx2; bx++)
+			rad_cells[by * bmap_width + bx].push_back(trig);
+
+		rad_stats.indexed++;
+	}
+
+	rad_index_valid = true;
+}
+
+static void RAD_PickTriggers(const std::vector<rad_trigger_t *>& list)
+{
+	for (int i = 0; i < (int)list.size(); i++)
+	{
+		rad_trigger_t *trig = list[i];
 
-		if (! (trig->info->tagged_independent && trig->activated))
+		if (trig->picked_tic != rad_tic)
 		{
-			int mask = RAD_AlivePlayers();
-
-			// Immediate triggers are just that. Immediate.
-			// Not within range so skip it.
-			//
-            if (!trig->info->tagged_immediate)
-            {
-                mask = RAD_AllPlayersInRadius(trig->info, mask);
-                if (mask == 0)
-                    continue;
-            }
-
-            // Check for use key trigger.
-            if (trig->info->tagged_use)
-            {
-                mask = RAD_AllPlayersUsing(mask);
-                if (mask == 0)
-                    continue;
-            }
-
-			// height check...
-			if (trig->info->height_trig)
-			{
-				s_onheight_t *cur;
+			trig->picked_tic = rad_tic;
+			rad_picked.push_back(trig);
+		}
+	}
+}
 
-				for (cur=trig->info->height_trig; cur; cur=cur->next)
-					if (! RAD_CheckHeightTrig(trig, cur))
-						break;
+static bool RAD_CompareOrder(const rad_trigger_t *A, const rad_trigger_t *B)
+{
+	return A->order < B->order;
+}
 
-				// if they all succeeded, then cur will be NULL...
-				if (cur)
-					continue;
-			}
+//
+// Find the triggers which need checking this tic, in the same order
+// as the list of active triggers.
+//
+static void RAD_PickAllTriggers(void)
+{
+	rad_picked.clear();
 
-			// ondeath check...
-			if (trig->info->boss_trig)
-			{
-				s_ondeath_t *cur;
+	RAD_PickTriggers(rad_always);
+	RAD_PickTriggers(rad_awake);
 
-				for (cur=trig->info->boss_trig; cur; cur=cur->next)
-					if (! RAD_CheckBossTrig(trig, cur))
-						break;
+	int mask = RAD_AlivePlayers();
 
-				// if they all succeeded, then cur will be NULL...
-				if (cur)
-					continue;
-			}
+	if (RAD_AllPlayersUsing(mask) != 0)
+		RAD_PickTriggers(rad_on_use);
 
-			// condition check...
-			if (trig->info->cond_trig)
-			{
-                mask = RAD_AllPlayersCheckCond(trig->info, mask);
-                if (mask == 0)
-                    continue;
-			}
+	if (! rad_cells.empty())
+	{
+		for (int pnum = 0; pnum < MAXPLAYERS; pnum++)
+		{
+			if (! (mask & (1 << pnum)))
+				continue;
+
+			mobj_t *mo = players[pnum]->mo;
 
-			trig->activated = true;
-			trig->acti_players = mask;
+			// clamping keeps any overlap with the trigger cells
+			int bx1 = CLAMP(0, BLOCKMAP_GET_X(mo->x - mo->radius), bmap_width  - 1);
+			int bx2 = CLAMP(0, BLOCKMAP_GET_X(mo->x + mo->radius), bmap_width  - 1);
+			int by1 = CLAMP(0, BLOCKMAP_GET_Y(mo->y - mo->radius), bmap_height - 1);
+			int by2 = CLAMP(0, BLOCKMAP_GET_Y(mo->y + mo->radius), bmap_height - 1);
+
+			for (int by = by1; by <= by2; by++)
+			for (int bx = bx1; bx <= bx2; bx++)
+				RAD_PickTriggers(rad_cells[by * bmap_width + bx]);
 		}
+	}
+
+	std::sort(rad_picked.begin(), rad_picked.end(), RAD_CompareOrder);
+}
+
+#define RUN_Acted    1  // some actions were run
+#define RUN_Removed  2  // the trigger was removed (and freed)
 
-		// If we are waiting, decrement count and skip it.
-		// Note that we must do this *after* all the condition checks.
+static int RAD_RunTrigger(rad_trigger_t *trig)
+{
+	int result = 0;
+
+	// Don't process, if disabled
+	if (trig->disabled)
+		return 0;
+
+	rad_stats.checked++;
+
+	// Handle repeat delay (from TAGGED_REPEATABLE).  This must be
+	// done *before* all the condition checks, and that's what makes
+	// it different from `wait_tics'.
+	//
+	if (trig->repeat_delay > 0)
+	{
+		trig->repeat_delay--;
+		return 0;
+	}
+
+	// Independent, means you don't have to stay within the trigger
+	// radius for it to operate, It will operate on it's own.
+
+	if (! (trig->info->tagged_independent && trig->activated))
+	{
+		int mask = RAD_AlivePlayers();
+
+		// Immediate triggers are just that. Immediate.
+		// Not within range so skip it.
 		//
-		if (trig->wait_tics > 0)
+		if (!trig->info->tagged_immediate)
 		{
-			trig->wait_tics--;
-			continue;
+			mask = RAD_AllPlayersInRadius(trig->info, mask);
+			if (mask == 0)
+				return 0;
 		}
 
-		// Waiting until monsters are dead?
-		while (trig->wait_tics == 0 && trig->wud_count <= 0)
+		// Check for use key trigger.
+		if (trig->info->tagged_use)
 		{
-			// Execute current command
-			rts_state_t *state = trig->state;
-			SYS_ASSERT(state);
+			mask = RAD_AllPlayersUsing(mask);
+			if (mask == 0)
+				return 0;
+		}
 
-			// move to next state.  We do this NOW since the action itself
-			// may want to change the trigger's state (to support GOTO type
-			// actions and other possibilities).
-			//
-			trig->state = trig->state->next;
+		// height check...
+		if (trig->info->height_trig)
+		{
+			s_onheight_t *cur;
 
-			(*state->action)(trig, state->param);
+			for (cur=trig->info->height_trig; cur; cur=cur->next)
+				if (! RAD_CheckHeightTrig(trig, cur))
+					break;
 
-			if (! trig->state)
-				break;
+			// if they all succeeded, then cur will be NULL...
+			if (cur)
+				return 0;
+		}
 
-			trig->wait_tics += trig->state->tics;
-			
-			if (trig->disabled || rts_menuactive)
-				break;
+		// ondeath check...
+		if (trig->info->boss_trig)
+		{
+			s_ondeath_t *cur;
+
+			for (cur=trig->info->boss_trig; cur; cur=cur->next)
+				if (! RAD_CheckBossTrig(trig, cur))
+					break;
+
+			// if they all succeeded, then cur will be NULL...
+			if (cur)
+				return 0;
 		}
 
-		if (trig->state)
-			continue;
+		// condition check...
+		if (trig->info->cond_trig)
+		{
+			mask = RAD_AllPlayersCheckCond(trig->info, mask);
+			if (mask == 0)
+				return 0;
+		}
+
+		trig->activated = true;
+		trig->acti_players = mask;
+	}
+
+	// If we are waiting, decrement count and skip it.
+	// Note that we must do this *after* all the condition checks.
+	//
+	if (trig->wait_tics > 0)
+	{
+		trig->wait_tics--;
+		return 0;
+	}
+
+	// Waiting until monsters are dead?
+	while (trig->wait_tics == 0 && trig->wud_count <= 0)
+	{
+		// Execute current command
+		rts_state_t *state = trig->state;
+		SYS_ASSERT(state);
 
-		// we've reached the end of the states.  Delete the trigger unless
-		// it is Tagged_Repeatable and has some more repeats left.
+		// move to next state.  We do this NOW since the action itself
+		// may want to change the trigger's state (to support GOTO type
+		// actions and other possibilities).
 		//
-		if (trig->info->repeat_count != REPEAT_FOREVER)
-			trig->repeats_left--;
+		trig->state = trig->state->next;
+
+		(*state->action)(trig, state->param);
+
+		result |= RUN_Acted;
+
+		if (! trig->state)
+			break;
+
+		trig->wait_tics += trig->state->tics;
+		
+		if (trig->disabled || rts_menuactive)
+			break;
+	}
+
+	if (trig->state)
+		return result;
+
+	// we've reached the end of the states.  Delete the trigger unless
+	// it is Tagged_Repeatable and has some more repeats left.
+	//
+	if (trig->info->repeat_count != REPEAT_FOREVER)
+		trig->repeats_left--;
+
+	if (trig->repeats_left > 0)
+	{
+		trig->state = trig->info->first_state;
+		trig->wait_tics = trig->state->tics;
+		trig->repeat_delay = trig->info->repeat_delay;
+		return result;
+	}
+
+	DoRemoveTrigger(trig);
+
+	return result | RUN_Removed;
+}
+
+//
+// Radius Trigger Event handler.
+//
+void RAD_RunTriggers(void)
+{
+	rad_trigger_t *trig, *next;
 
-		if (trig->repeats_left > 0)
+	if (! rad_index_valid)
+		RAD_BuildIndex();
+
+	rad_tic++;
+
+	rad_stats.checked = 0;
+
+	RAD_PickAllTriggers();
+
+	// the triggers which stay awake for the next tic
+	std::vector<rad_trigger_t *> awake;
+
+	int i = 0;
+
+	// once an action has run, anything could have changed (players
+	// moved, triggers enabled), so the rest of the list is checked
+	// the slow way.
+	bool slow = false;
+
+	for (trig = NULL; ; trig = next)
+	{
+		if (slow)
 		{
-			trig->state = trig->info->first_state;
-			trig->wait_tics = trig->state->tics;
-			trig->repeat_delay = trig->info->repeat_delay;
-			continue;
+			if (! trig)
+				break;
+		}
+		else
+		{
+			if (i >= (int)rad_picked.size())
+				break;
+
+			trig = rad_picked[i++];
+		}
+
+		next = trig->next;
+
+		// stop running all triggers when an RTS menu becomes active
+		if (rts_menuactive)
+		{
+			// keep the awake triggers which were not visited
+			// (unless the index is being rebuilt anyway)
+			if (rad_index_valid)
+			{
+				awake.insert(awake.end(), rad_awake.begin(), rad_awake.end());
+
+				std::sort(awake.begin(), awake.end(), RAD_CompareOrder);
+				awake.erase(std::unique(awake.begin(), awake.end()), awake.end());
+			}
+			break;
 		}
 
-		DoRemoveTrigger(trig);
+		int result = RAD_RunTrigger(trig);
+
+		if (! (result & RUN_Removed) && RAD_TriggerAwake(trig))
+			awake.push_back(trig);
+
+		if (result & RUN_Acted)
+			slow = true;
 	}
+
+	rad_awake.swap(awake);
+
+	rad_stats.checked_max = MAX(rad_stats.checked_max, rad_stats.checked);
+}
+
+void RAD_GetTriggerStats(rad_stats_t *st)
+{
+	*st = rad_stats;
 }
 
 void RAD_MonsterIsDead(mobj_t *mo)
 {
+	if (rad_death_types.find(mo->info) != rad_death_types.end())
+		rad_deaths++;
+
 	if (mo->hyperflags & HF_WAIT_UNTIL_DEAD)
 	{
 		mo->hyperflags &= ~HF_WAIT_UNTIL_DEAD;
@@ -706,7 +975,7 @@ void RAD_MonsterIsDead(mobj_t *mo)
 
 		for (trig = active_triggers ; trig ; trig = trig->next)
 		{
-			if (trig->wud_tag == mo->tag)
+			if (trig->wud_tag == mo->cold->tag)
 			{
 				trig->wud_count--;
 			}
@@ -715,6 +984,20 @@ void RAD_MonsterIsDead(mobj_t *mo)
 }
 
 
+//
+// Called when a (living) mobj is removed from the map or changes
+// into another type, either of which can satisfy an ONDEATH check.
+//
+void RAD_MonsterIsRemoved(mobj_t *mo)
+{
+	if (mo->health > 0 &&
+		rad_death_types.find(mo->info) != rad_death_types.end())
+	{
+		rad_deaths++;
+	}
+}
+
+
 //
 // Called from RAD_SpawnTriggers to set the tag_next & tag_prev fields
 // of each rad_trigger_t, keeping all triggers with the same tag in a
@@ -724,6 +1007,10 @@ void RAD_GroupTriggerTags(rad_trigger_t *trig)
 {
 	rad_trigger_t *cur;
 
+	// the list of triggers has changed
+	rad_index_valid = false;
+	rad_tags_valid  = false;
+
 	trig->tag_next = trig->tag_prev = NULL;
 
 	// find first trigger with the same tag #
@@ -822,6 +1109,7 @@ static void RAD_ClearCachedInfo(void)
 		for (d_cur=scr->boss_trig; d_cur; d_cur=d_cur->next)
 		{
 			d_cur->cached_info = NULL;
+			d_cur->failed_deaths = 0;
 		}
 
 		// clear ONHEIGHT cached info
@@ -844,6 +1132,16 @@ void RAD_ClearTriggers(void)
 		Z_Free(trig);
 	}
 
+	rad_index_valid = false;
+	rad_tags_valid  = false;
+	rad_death_types.clear();
+
+	rad_tags.clear();
+	rad_awake.clear();
+	rad_picked.clear();
+
+	rad_stats.checked_max = 0;
+
 	RAD_ClearCachedInfo();
 	RAD_ResetTips();
 }
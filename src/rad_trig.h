@@ -40,7 +40,20 @@ void RAD_SpawnTriggers(const char *map_name);
 void RAD_ClearTriggers(void);
 void RAD_GroupTriggerTags(rad_trigger_t *trig);
 
+typedef struct
+{
+	// active triggers, and those placed in the spatial index
+	int total;
+	int indexed;
+
+	// triggers checked in the last tic, and the most in any tic
+	int checked;
+	int checked_max;
+}
+rad_stats_t;
+
 void RAD_RunTriggers(void);
+void RAD_GetTriggerStats(rad_stats_t *st);
 void RAD_Ticker(void);
 void RAD_Drawer(void);
 bool RAD_Responder(event_t * ev);
@@ -50,6 +63,7 @@ rad_trigger_t *RAD_FindTriggerByName(const char *name);
 rts_state_t *RAD_FindStateByLabel(rad_script_t *scr, char *label);
 void RAD_EnableByTag(mobj_t *actor, int tag, bool disable);
 void RAD_MonsterIsDead(mobj_t *mo);
+void RAD_MonsterIsRemoved(mobj_t *mo);
 
 // Menu support
 void RAD_StartMenu(rad_trigger_t *R, s_show_menu_t *menu);
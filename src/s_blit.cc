@@ -66,9 +66,16 @@
 #define MIN_CHANNELS    8
 #define MAX_CHANNELS  128
 
+#define MAX_VIRTUAL   1024
+
 mix_channel_c *mix_chan[MAX_CHANNELS];
 int num_chan;
 
+mix_channel_c *virt_chan[MAX_VIRTUAL];
+int num_virt;
+
+DEF_CVAR(sound_virtual, int, "c", 1);
+
 bool vacuum_sfx = false;
 bool submerged_sfx = false;
 bool outdoor_reverb = false;
@@ -88,12 +95,22 @@ static std::list<epi::sound_data_c *> playing_qbufs;
 
 static mix_channel_c *queue_chan;
 
+static int  queue_limit = 0;
+static int  queue_underruns = 0;
+static bool queue_starved = false;
+
 
 DEF_CVAR(au_sfx_volume, int, "c", CFGDEF_SOUND_VOLUME);
 //int sfx_volume = 0;
 
 static bool sfxpaused = false;
 
+// mixer timing, accumulated by the audio callback
+static int    mix_calls = 0;
+static Uint64 mix_total_ticks = 0;
+static Uint64 mix_min_ticks = 0;
+static Uint64 mix_max_ticks = 0;
+
 // these are analogous to viewx/y/z/angle
 float listen_x;
 float listen_y;
@@ -617,7 +634,11 @@ static void MixQueues(int pairs)
 			free_qbufs.push_back(buf);
 
 			if (! QueueNextBuffer())
+			{
+				// ran dry: an underrun if more data turns up later
+				queue_starved = true;
 				break;
+			}
 		}
 
 		dest  += count * (dev_stereo ? 2 : 1);
@@ -642,6 +663,8 @@ void S_MixAllChannels(void *stream, int len)
 
 	SYS_ASSERT(mix_buffer && samples <= mix_buf_len);
 
+	Uint64 start_time = SDL_GetPerformanceCounter();
+
 	// clear mixer buffer
 	memset(mix_buffer, 0, mix_buf_len * sizeof(int));
 
@@ -682,6 +705,16 @@ void S_MixAllChannels(void *stream, int len)
 		else
 			BlitToU16(mix_buffer, (u16_t *)stream, samples);
 	}
+
+	Uint64 elapsed = SDL_GetPerformanceCounter() - start_time;
+
+	if (mix_calls == 0 || elapsed < mix_min_ticks)
+		mix_min_ticks = elapsed;
+	if (elapsed > mix_max_ticks)
+		mix_max_ticks = elapsed;
+
+	mix_total_ticks += elapsed;
+	mix_calls++;
 }
 
 
@@ -699,6 +732,11 @@ void S_InitChannels(int total)
 	for (int i = 0; i < num_chan; i++)
 		mix_chan[i] = new mix_channel_c();
 
+	num_virt = MAX_VIRTUAL;
+
+	for (int v = 0; v < num_virt; v++)
+		virt_chan[v] = new mix_channel_c();
+
 	// allocate mixer buffer
 	mix_buf_len = dev_frag_pairs * (dev_stereo ? 2 : 1);
 	mix_buffer = new int[mix_buf_len];
@@ -728,6 +766,16 @@ void S_FreeChannels(void)
 	}
 
 	memset(mix_chan, 0, sizeof(mix_chan));
+
+	for (int v = 0; v < num_virt; v++)
+	{
+		S_KillVirtual(v);
+
+		delete virt_chan[v];
+	}
+
+	memset(virt_chan, 0, sizeof(virt_chan));
+	num_virt = 0;
 }
 
 void S_KillChannel(int k)
@@ -743,6 +791,51 @@ void S_KillChannel(int k)
 	}
 }
 
+int S_FindFreeVirtual(void)
+{
+	for (int v = 0; v < num_virt; v++)
+	{
+		if (virt_chan[v]->state != CHAN_Playing)
+			return v;
+	}
+
+	return -1;
+}
+
+void S_KillVirtual(int v)
+{
+	mix_channel_c *chan = virt_chan[v];
+
+	if (chan->state != CHAN_Empty)
+	{
+		S_CacheRelease(chan->data);
+
+		chan->data = NULL;
+		chan->state = CHAN_Empty;
+	}
+}
+
+bool S_VirtualizeChannel(int k)
+{
+	int v = S_FindFreeVirtual();
+
+	if (v < 0)
+	{
+		S_KillChannel(k);
+		return false;
+	}
+
+	S_KillVirtual(v);
+
+	// SWAP !
+	mix_channel_c *tmp = virt_chan[v];
+
+	virt_chan[v] = mix_chan[k];
+	mix_chan[k]  = tmp;
+
+	return true;
+}
+
 void S_ReallocChannels(int total)
 {
 	// NOTE: assumes audio is locked!
@@ -799,6 +892,125 @@ void S_ReallocChannels(int total)
 	num_chan = total;
 }
 	
+static inline bool CanVirtualize(const mix_channel_c *chan)
+{
+	return (chan->pos && chan->category >= SNCAT_Opponent && ! chan->boss);
+}
+
+static inline float ListenerDist(const mix_channel_c *chan)
+{
+	const position_c *pos = chan->pos;
+
+	return P_ApproxDistance(listen_x - pos->x, listen_y - pos->y, listen_z - pos->z);
+}
+
+static void UpdateVirtualVoices(void)
+{
+	// NOTE: assume SDL_LockAudio has been called
+
+	// advance all virtual voices by one tic
+	fixed22_t pairs_per_tic = dev_freq / TICRATE;
+
+	for (int v = 0; v < num_virt; v++)
+	{
+		mix_channel_c *chan = virt_chan[v];
+
+		if (chan->state != CHAN_Playing)
+			continue;
+
+		if (sfxpaused && chan->category >= SNCAT_Player)
+			continue;
+
+		chan->offset += chan->delta * pairs_per_tic;
+
+		if (chan->offset >= chan->length)
+		{
+			if (! chan->loop)
+			{
+				S_KillVirtual(v);
+				continue;
+			}
+
+			// same as the mixer: looping needs another "pump"
+			chan->loop = false;
+			chan->offset %= chan->length;
+		}
+	}
+
+	if (! sound_virtual)
+		return;
+
+	// demote real channels which cannot be heard, and remember
+	// the furthest audible one for swapping with closer voices.
+	int   far_k    = -1;
+	float far_dist = 0;
+
+	for (int k = 0; k < num_chan; k++)
+	{
+		mix_channel_c *chan = mix_chan[k];
+
+		if (chan->state != CHAN_Playing || ! CanVirtualize(chan))
+			continue;
+
+		float dist = ListenerDist(chan);
+
+		if (dist > chan->def->max_distance)
+		{
+			S_VirtualizeChannel(k);
+			continue;
+		}
+
+		if (dist > far_dist)
+		{
+			far_k    = k;
+			far_dist = dist;
+		}
+	}
+
+	// promote virtual voices which have become audible
+	int free_k = 0;
+
+	for (int v = 0; v < num_virt; v++)
+	{
+		mix_channel_c *chan = virt_chan[v];
+
+		if (chan->state != CHAN_Playing)
+			continue;
+
+		float dist = ListenerDist(chan);
+
+		if (dist > chan->def->max_distance)
+			continue;
+
+		for (; free_k < num_chan; free_k++)
+		{
+			if (mix_chan[free_k]->state == CHAN_Finished)
+				S_KillChannel(free_k);
+
+			if (mix_chan[free_k]->state == CHAN_Empty)
+				break;
+		}
+
+		int k = free_k;
+
+		if (k >= num_chan)
+		{
+			// no free channel, steal the furthest one when this
+			// voice is clearly closer (hysteresis prevents the two
+			// from swapping back and forth every tic).
+			if (far_k < 0 || dist > far_dist * 0.75f)
+				continue;
+
+			k = far_k;
+			far_k = -1;
+		}
+
+		// SWAP !
+		virt_chan[v] = mix_chan[k];
+		mix_chan[k]  = chan;
+	}
+}
+
 void S_UpdateSounds(position_c *listener, angle_t angle)
 {
 	// NOTE: assume SDL_LockAudio has been called
@@ -809,6 +1021,8 @@ void S_UpdateSounds(position_c *listener, angle_t angle)
 
 	listen_angle = angle;
 
+	UpdateVirtualVoices();
+
 	for (int i = 0; i < num_chan; i++)
 	{
 		mix_channel_c *chan = mix_chan[i];
@@ -915,6 +1129,8 @@ void S_QueueStop(void)
 
 		queue_chan->state = CHAN_Finished;
 		queue_chan->data  = NULL;
+
+		queue_starved = false;
 	}
 	I_UnlockAudio();
 }
@@ -927,7 +1143,8 @@ epi::sound_data_c * S_QueueGetFreeBuffer(int samples, int buf_mode)
 
 	I_LockAudio();
 	{
-		if (! free_qbufs.empty())
+		if (! free_qbufs.empty() &&
+			(queue_limit <= 0 || (int)playing_qbufs.size() < queue_limit))
 		{
 			buf = free_qbufs.front();
 			free_qbufs.pop_front();
@@ -954,6 +1171,12 @@ void S_QueueAddBuffer(epi::sound_data_c *buf, int freq)
 
 		if (queue_chan->state != CHAN_Playing)
 		{
+			if (queue_starved)
+			{
+				queue_underruns++;
+				queue_starved = false;
+			}
+
 			QueueNextBuffer();
 		}
 	}
@@ -972,5 +1195,86 @@ void S_QueueReturnBuffer(epi::sound_data_c *buf)
 	I_UnlockAudio();
 }
 
+void S_QueueSetLimit(int bufs)
+{
+	queue_limit = MIN(bufs, MAX_QUEUE_BUFS);
+}
+
+int S_QueueNumPlaying(void)
+{
+	if (nosound) return 0;
+
+	int count;
+
+	I_LockAudio();
+	{
+		count = (int)playing_qbufs.size();
+	}
+	I_UnlockAudio();
+
+	return count;
+}
+
+int S_QueueUnderruns(void)
+{
+	if (nosound) return 0;
+
+	int count;
+
+	// written by the music thread, under the audio lock
+	I_LockAudio();
+	{
+		count = queue_underruns;
+	}
+	I_UnlockAudio();
+
+	return count;
+}
+
+
+//----------------------------------------------------------------------------
+
+void S_GetMixStats(mix_stats_t *st, bool reset)
+{
+	memset(st, 0, sizeof(mix_stats_t));
+
+	if (nosound)
+		return;
+
+	for (int i = 0; i < num_chan; i++)
+		if (mix_chan[i]->state == CHAN_Playing)
+			st->real_voices[mix_chan[i]->category] += 1;
+
+	for (int v = 0; v < num_virt; v++)
+		if (virt_chan[v]->state == CHAN_Playing)
+			st->virt_voices[virt_chan[v]->category] += 1;
+
+	I_LockAudio();
+	{
+		double freq = (double)SDL_GetPerformanceFrequency();
+
+		st->mix_calls = mix_calls;
+
+		if (mix_calls > 0)
+		{
+			st->mix_min_us = (float)(mix_min_ticks * 1000000.0 / freq);
+			st->mix_max_us = (float)(mix_max_ticks * 1000000.0 / freq);
+			st->mix_avg_us = (float)(mix_total_ticks * 1000000.0 / freq / mix_calls);
+		}
+
+		st->queue_depth = (int)playing_qbufs.size();
+		st->queue_underruns = queue_underruns;
+
+		if (reset)
+		{
+			mix_calls = 0;
+			mix_total_ticks = 0;
+			mix_min_ticks = 0;
+			mix_max_ticks = 0;
+		}
+	}
+	I_UnlockAudio();
+}
+
 //--- editor settings ---
 // vi:ts=4:sw=4:noexpandtab
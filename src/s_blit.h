@@ -30,6 +30,8 @@
 
 #include "../ddf/types.h"
 
+#include "s_sound.h"  // SNCAT_NUMTYPES
+
 // Forward declarations
 class sfxdef_c;
 class position_c; ///not class.
@@ -85,6 +87,15 @@ public:
 
 extern mix_channel_c *mix_chan[];
 extern int num_chan;
+
+// Virtual voices: sounds which are currently inaudible (too far
+// away, or crowded out of the real channels).  They are not mixed,
+// but their offset keeps advancing every tic, and S_UpdateSounds()
+// swaps them with a real channel once they can be heard again.
+extern mix_channel_c *virt_chan[];
+extern int num_virt;
+
+extern int sound_virtual;
 extern bool vacuum_sfx;
 extern bool submerged_sfx;
 extern bool outdoor_reverb;
@@ -101,6 +112,16 @@ void S_FreeChannels(void);
 void S_KillChannel(int k);
 void S_ReallocChannels(int total);
 
+int  S_FindFreeVirtual(void);
+// returns index of an unused virtual voice, or -1 if all in use.
+
+void S_KillVirtual(int v);
+
+bool S_VirtualizeChannel(int k);
+// move the sound on real channel 'k' into a virtual voice, leaving
+// the real channel empty.  Returns false (and kills the sound)
+// when no virtual voice is free.
+
 void S_MixAllChannels(void *stream, int len);
 // mix all active channels into the output stream.
 // 'len' is the number of samples (for stereo: pairs)
@@ -109,6 +130,28 @@ void S_MixAllChannels(void *stream, int len);
 void S_UpdateSounds(position_c *listener, angle_t angle);
 
 
+typedef struct
+{
+	// number of sounds per SNCAT_XXX category
+	int real_voices[SNCAT_NUMTYPES];
+	int virt_voices[SNCAT_NUMTYPES];
+
+	// time spent in S_MixAllChannels() per callback (microseconds)
+	int   mix_calls;
+	float mix_min_us;
+	float mix_avg_us;
+	float mix_max_us;
+
+	int queue_depth;
+	int queue_underruns;
+}
+mix_stats_t;
+
+void S_GetMixStats(mix_stats_t *st, bool reset);
+// get current voice usage and mixer timing.  When 'reset' is true,
+// the timing figures begin a new measurement period afterwards.
+
+
 //-------- API for Synthesised MUSIC --------------------
 
 void S_QueueInit(void);
@@ -135,6 +178,18 @@ void S_QueueReturnBuffer(epi::sound_data_c *buf);
 // if something goes wrong and you cannot add the buffer,
 // then this call will return the buffer to the free list.
 
+void S_QueueSetLimit(int bufs);
+// limit how many buffers may be queued ahead of the mixer.
+// S_QueueGetFreeBuffer() returns NULL once the limit is reached.
+// A value of zero means no limit (all buffers can be queued).
+
+int S_QueueNumPlaying(void);
+// returns the number of buffers waiting in the playing queue.
+
+int S_QueueUnderruns(void);
+// returns how many times the queue ran dry before the decoder
+// could supply the next buffer (end of track is not counted).
+
 #endif // __S_BLIT__
 
 //--- editor settings ---
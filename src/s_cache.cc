@@ -55,6 +55,9 @@ extern int dev_freq;
 
 static std::vector<epi::sound_data_c *> fx_cache;
 
+static int cache_hits;
+static int cache_misses;
+
 
 static void Load_Silence(epi::sound_data_c *buf)
 {
@@ -214,10 +217,13 @@ epi::sound_data_c *S_CacheLoad(sfxdef_c *def)
 		if (fx_cache[i]->priv_data == (void*)def)
 		{
 			fx_cache[i]->ref_count++;
+			cache_hits++;
 			return fx_cache[i];
 		}
 	}
 
+	cache_misses++;
+
 	// create data structure
 	epi::sound_data_c *buf = new epi::sound_data_c();
 
@@ -239,5 +245,31 @@ void S_CacheRelease(epi::sound_data_c *data)
 	data->ref_count--;
 }
 
+
+static int BufferBytes(const epi::sound_data_c *buf)
+{
+	int per_sample = (buf->mode == epi::SBUF_Mono) ? 1 : 2;
+	int count = 0;
+
+	if (buf->data_L)
+		count += buf->length * per_sample;
+
+	if (buf->fx_data_L)
+		count += buf->length * per_sample;
+
+	return count * (int)sizeof(s16_t);
+}
+
+void S_CacheGetStats(cache_stats_t *st)
+{
+	st->entries = (int)fx_cache.size();
+	st->bytes   = 0;
+	st->hits    = cache_hits;
+	st->misses  = cache_misses;
+
+	for (int i = 0; i < (int)fx_cache.size(); i++)
+		st->bytes += BufferBytes(fx_cache[i]);
+}
+
 //--- editor settings ---
 // vi:ts=4:sw=4:noexpandtab
@@ -49,6 +49,20 @@ void S_CacheRelease(epi::sound_data_c *data);
 // Typically though the sound is kept, as it will likely
 // be needed again shortly.
 
+typedef struct
+{
+	int entries;
+	int bytes;   // sample memory, including mixed FX copies
+
+	int hits;
+	int misses;
+}
+cache_stats_t;
+
+void S_CacheGetStats(cache_stats_t *st);
+// get current size of the cache, and the number of lookups which
+// found (or did not find) an existing entry.
+
 #endif /* __S_CACHE_H__ */
 
 //--- editor settings ---
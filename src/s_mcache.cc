@@ -0,0 +1,547 @@
+//----------------------------------------------------------------------------
+//  EDGE Rendered Music Cache
+//----------------------------------------------------------------------------
+//
+//  Copyright (c) 2023  The EDGE Team.
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//----------------------------------------------------------------------------
+//
+//  Synthesizing MIDI (OPL emulation or TinySoundFont) in real time is
+//  costly on slow machines.  When au_mus_cache is enabled, the first
+//  time a song is played it is also rendered on a worker thread into
+//  a zlib-compressed PCM file in the cache directory.  Later plays
+//  stream that file instead of running the synthesizer.
+//
+//  The file name is made from a CRC of the song data and of the
+//  settings which affect the output (device, rate, channels, OPL
+//  mode, GENMIDI lump or soundfont), so changing any of them simply
+//  renders a new file.
+//
+
+#include "system/i_defs.h"
+#include "system/i_sdlinc.h"
+
+#include <zlib.h>
+
+#include "../epi/endianess.h"
+#include "../epi/filesystem.h"
+#include "../epi/math_crc.h"
+#include "../epi/path.h"
+#include "../epi/str_format.h"
+
+#include "dm_state.h"  // cache_dir
+#include "m_misc.h"
+#include "s_blit.h"
+#include "s_music.h"
+#include "s_mcache.h"
+#include "s_opl.h"
+#include "s_tsf.h"
+#include "w_wad.h"
+
+extern bool dev_stereo;  // FIXME: encapsulation
+extern int  dev_freq;
+
+DEF_CVAR(au_mus_cache, int, "c", 0);
+
+#define MCACHE_MAGIC        "EDGEPCM1"
+#define MCACHE_HEADER_SIZE  20
+
+#define MCACHE_NUM_SAMPLES  4096
+#define MCACHE_INPUT_SIZE   16384
+
+// safety limit for songs which never end
+#define MCACHE_MAX_SECONDS  (30 * 60)
+
+
+//----------------------------------------------------------------------------
+//  PLAYBACK
+//----------------------------------------------------------------------------
+
+class mcache_player_c : public abstract_music_c
+{
+private:
+	enum status_e
+	{
+		NOT_LOADED, PLAYING, PAUSED, STOPPED
+	};
+
+	int status;
+	bool looping;
+
+	FILE *fp;
+	z_stream zs;
+
+	int freq;
+	int channels;
+
+	byte in_buf[MCACHE_INPUT_SIZE];
+
+public:
+	mcache_player_c() : status(NOT_LOADED), fp(NULL)
+	{ }
+
+	~mcache_player_c()
+	{
+		Close();
+	}
+
+	bool Open(const char *filename)
+	{
+		fp = fopen(filename, "rb");
+		if (!fp)
+			return false;
+
+		byte header[MCACHE_HEADER_SIZE];
+
+		if (fread(header, MCACHE_HEADER_SIZE, 1, fp) != 1 ||
+			memcmp(header, MCACHE_MAGIC, 8) != 0)
+		{
+			fclose(fp);
+			fp = NULL;
+			return false;
+		}
+
+		u32_t value;
+
+		memcpy(&value, header +  8, 4); freq     = EPI_LE_U32(value);
+		memcpy(&value, header + 12, 4); channels = EPI_LE_U32(value);
+
+		if (channels != (dev_stereo ? 2 : 1))
+		{
+			fclose(fp);
+			fp = NULL;
+			return false;
+		}
+
+		memset(&zs, 0, sizeof(zs));
+		inflateInit(&zs);
+
+		status = STOPPED;
+		return true;
+	}
+
+	void Close(void)
+	{
+		if (status == NOT_LOADED)
+			return;
+
+		Stop();
+
+		inflateEnd(&zs);
+
+		fclose(fp);
+		fp = NULL;
+
+		status = NOT_LOADED;
+	}
+
+	void Play(bool loop)
+	{
+		if (status != STOPPED)
+			return;
+
+		status = PLAYING;
+		looping = loop;
+
+		Rewind();
+
+		// Load up initial buffer data
+		Ticker();
+	}
+
+	void Stop(void)
+	{
+		if (! (status == PLAYING || status == PAUSED))
+			return;
+
+		S_QueueStop();
+
+		status = STOPPED;
+	}
+
+	void Pause(void)
+	{
+		if (status != PLAYING)
+			return;
+
+		status = PAUSED;
+	}
+
+	void Resume(void)
+	{
+		if (status != PAUSED)
+			return;
+
+		status = PLAYING;
+	}
+
+	void Ticker(void)
+	{
+		while (status == PLAYING)
+		{
+			epi::sound_data_c *buf = S_QueueGetFreeBuffer(MCACHE_NUM_SAMPLES,
+					(channels == 2) ? epi::SBUF_Interleaved : epi::SBUF_Mono);
+
+			if (! buf)
+				break;
+
+			if (StreamIntoBuffer(buf))
+			{
+				S_QueueAddBuffer(buf, freq);
+			}
+			else
+			{
+				// finished playing
+				S_QueueReturnBuffer(buf);
+
+				Stop();
+			}
+		}
+	}
+
+	void Volume(float gain)
+	{
+		// not needed, music volume is handled in s_blit.cc
+		// (see mix_channel_c::ComputeMusicVolume).
+	}
+
+private:
+	void Rewind(void)
+	{
+		fseek(fp, MCACHE_HEADER_SIZE, SEEK_SET);
+
+		inflateReset(&zs);
+
+		zs.next_in  = in_buf;
+		zs.avail_in = 0;
+	}
+
+	bool StreamIntoBuffer(epi::sound_data_c *buf)
+	{
+		int want = MCACHE_NUM_SAMPLES * channels * sizeof(s16_t);
+
+		zs.next_out  = (Bytef *) buf->data_L;
+		zs.avail_out = want;
+
+		bool rewound = false;
+
+		while (zs.avail_out > 0)
+		{
+			if (zs.avail_in == 0)
+			{
+				zs.next_in  = in_buf;
+				zs.avail_in = fread(in_buf, 1, MCACHE_INPUT_SIZE, fp);
+			}
+
+			int res = inflate(&zs, Z_NO_FLUSH);
+
+			if (res == Z_STREAM_END)
+			{
+				// don't loop forever on an empty file
+				if (! looping || rewound)
+					break;
+
+				Rewind();
+				rewound = true;
+				continue;
+			}
+
+			if (res != Z_OK || (zs.avail_in == 0 && feof(fp)))
+			{
+				I_Debugf("[mcache_player_c::StreamIntoBuffer] Failed\n");
+				break;
+			}
+
+			rewound = false;
+		}
+
+		int got = want - zs.avail_out;
+
+		if (got == 0)
+			return false;
+
+		// silence the end of the last buffer
+		memset((byte *) buf->data_L + got, 0, zs.avail_out);
+
+#if EPI_BYTEORDER == EPI_BIG_ENDIAN
+		for (int i = 0; i < got / 2; i++)
+			buf->data_L[i] = EPI_LE_S16(buf->data_L[i]);
+#endif
+		return true;
+	}
+};
+
+
+//----------------------------------------------------------------------------
+//  RENDERING
+//----------------------------------------------------------------------------
+
+static SDL_Thread  *render_thread;
+static SDL_atomic_t render_busy;
+static SDL_atomic_t render_abort;
+
+// the job, owned by the render thread while it is busy
+static music_renderer_c *render_job;
+static std::string render_filename;
+
+
+static void PutU32(byte *dest, u32_t value)
+{
+	value = EPI_LE_U32(value);
+	memcpy(dest, &value, 4);
+}
+
+static bool RenderToFile(music_renderer_c *renderer, const char *filename)
+{
+	FILE *out = fopen(filename, "wb");
+	if (! out)
+		return false;
+
+	int channels = dev_stereo ? 2 : 1;
+
+	byte header[MCACHE_HEADER_SIZE];
+
+	memcpy(header, MCACHE_MAGIC, 8);
+	PutU32(header +  8, dev_freq);
+	PutU32(header + 12, channels);
+	PutU32(header + 16, 0);  // total samples, written at the end
+
+	fwrite(header, MCACHE_HEADER_SIZE, 1, out);
+
+	z_stream zs;
+	memset(&zs, 0, sizeof(zs));
+
+	deflateInit(&zs, Z_DEFAULT_COMPRESSION);
+
+	s16_t *pcm = new s16_t[MCACHE_NUM_SAMPLES * channels];
+	byte  *comp = new byte[MCACHE_INPUT_SIZE];
+
+	int total = 0;
+	int limit = MCACHE_MAX_SECONDS * dev_freq;
+
+	bool ok = true;
+	bool done = false;
+
+	while (ok && ! done)
+	{
+		if (SDL_AtomicGet(&render_abort) || total >= limit)
+		{
+			ok = false;
+			break;
+		}
+
+		memset(pcm, 0, MCACHE_NUM_SAMPLES * channels * sizeof(s16_t));
+
+		done = ! renderer->Render(pcm, MCACHE_NUM_SAMPLES);
+
+#if EPI_BYTEORDER == EPI_BIG_ENDIAN
+		for (int i = 0; i < MCACHE_NUM_SAMPLES * channels; i++)
+			pcm[i] = EPI_LE_S16(pcm[i]);
+#endif
+		// the last block still holds the final notes and their release
+		total += MCACHE_NUM_SAMPLES;
+
+		zs.next_in  = (Bytef *) pcm;
+		zs.avail_in = MCACHE_NUM_SAMPLES * channels * sizeof(s16_t);
+
+		do
+		{
+			zs.next_out  = comp;
+			zs.avail_out = MCACHE_INPUT_SIZE;
+
+			deflate(&zs, done ? Z_FINISH : Z_NO_FLUSH);
+
+			int have = MCACHE_INPUT_SIZE - zs.avail_out;
+
+			if (have > 0 && fwrite(comp, have, 1, out) != 1)
+				ok = false;
+		}
+		while (zs.avail_out == 0);
+	}
+
+	deflateEnd(&zs);
+
+	delete[] pcm;
+	delete[] comp;
+
+	if (ok)
+	{
+		PutU32(header + 16, total);
+
+		fseek(out, 0, SEEK_SET);
+		fwrite(header, MCACHE_HEADER_SIZE, 1, out);
+	}
+
+	fclose(out);
+
+	return ok && total > 0;
+}
+
+static int RenderThreadFunc(void *data)
+{
+	std::string temp_name = render_filename + ".tmp";
+
+	u32_t start = I_GetMillies();
+
+	bool ok = RenderToFile(render_job, temp_name.c_str());
+
+	delete render_job;
+	render_job = NULL;
+
+	if (ok && epi::FS_Rename(temp_name.c_str(), render_filename.c_str()))
+	{
+		I_Debugf("Music cache: rendered %s in %d ms\n", render_filename.c_str(),
+				 (int)(I_GetMillies() - start));
+	}
+	else
+	{
+		epi::FS_Delete(temp_name.c_str());
+	}
+
+	SDL_AtomicSet(&render_busy, 0);
+	return 0;
+}
+
+static void WaitForRender(void)
+{
+	if (render_thread)
+	{
+		SDL_WaitThread(render_thread, NULL);
+		render_thread = NULL;
+	}
+}
+
+static void StartRender(music_renderer_c *renderer, const std::string& filename)
+{
+	WaitForRender();
+
+	render_job = renderer;
+	render_filename = filename;
+
+	SDL_AtomicSet(&render_abort, 0);
+	SDL_AtomicSet(&render_busy, 1);
+
+	render_thread = SDL_CreateThread(RenderThreadFunc, "EDGE Music Render", NULL);
+
+	if (! render_thread)
+	{
+		delete render_job;
+		render_job = NULL;
+
+		SDL_AtomicSet(&render_busy, 0);
+	}
+}
+
+
+//----------------------------------------------------------------------------
+
+static std::string CacheFilename(const byte *data, int length, bool is_mus)
+{
+	epi::crc32_c song_crc;
+	song_crc.AddBlock(data, length);
+
+	epi::crc32_c conf_crc;
+
+	// the system device plays MIDI through OPL too
+	conf_crc += (s32_t) (var_music_dev == 1 ? 1 : 2);
+	conf_crc += (s32_t) dev_freq;
+	conf_crc += (s32_t) (dev_stereo ? 2 : 1);
+	conf_crc += (s32_t) (is_mus ? 1 : 0);
+
+	if (var_music_dev == 1)
+	{
+		// the soundfont is fixed, but its size catches replacements
+		conf_crc.AddCStr("soundfont/default.sf2");
+
+		epi::file_c *F = epi::FS_Open("soundfont/default.sf2", epi::file_c::ACCESS_READ);
+		if (F)
+		{
+			conf_crc += (s32_t) F->GetLength();
+			delete F;
+		}
+	}
+	else
+	{
+		conf_crc += (s32_t) (var_opl_opl3mode ? 1 : 0);
+
+		int lump = W_CheckNumForName("GENMIDI");
+		if (lump >= 0)
+		{
+			const byte *genmidi = (const byte *) W_CacheLumpNum(lump);
+
+			conf_crc.AddBlock(genmidi, W_LumpLength(lump));
+
+			W_DoneWithLump(genmidi);
+		}
+	}
+
+	std::string name = epi::STR_Format("music-%08X-%08X.pcz", song_crc.crc, conf_crc.crc);
+
+	return epi::PATH_Join(cache_dir.c_str(), name.c_str());
+}
+
+abstract_music_c * S_PlayCachedMusic(const byte *data, int length, bool is_mus,
+									 float volume, bool loop)
+{
+	if (! au_mus_cache)
+		return NULL;
+
+	// MUS on the system device is played natively, see DoChangeMusic
+	if (var_music_dev == 0 && is_mus)
+		return NULL;
+
+	std::string filename = CacheFilename(data, length, is_mus);
+
+	if (epi::FS_Access(filename.c_str(), epi::file_c::ACCESS_READ))
+	{
+		mcache_player_c *player = new mcache_player_c();
+
+		if (player->Open(filename.c_str()))
+		{
+			I_Debugf("Music cache: playing %s\n", filename.c_str());
+
+			player->Volume(volume);
+			player->Play(loop);
+
+			return player;
+		}
+
+		delete player;
+	}
+
+	// only one song is rendered at a time
+	if (SDL_AtomicGet(&render_busy))
+		return NULL;
+
+	music_renderer_c *renderer;
+
+	if (var_music_dev == 1)
+		renderer = S_CreateTSFRenderer(data, length, is_mus);
+	else
+		renderer = S_CreateOPLRenderer(data, length);
+
+	if (renderer)
+		StartRender(renderer, filename);
+
+	return NULL;
+}
+
+void S_ShutdownMusicCache(void)
+{
+	SDL_AtomicSet(&render_abort, 1);
+
+	WaitForRender();
+}
+
+//--- editor settings ---
+// vi:ts=4:sw=4:noexpandtab
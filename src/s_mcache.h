@@ -0,0 +1,58 @@
+//----------------------------------------------------------------------------
+//  EDGE Rendered Music Cache (HEADER)
+//----------------------------------------------------------------------------
+//
+//  Copyright (c) 2023  The EDGE Team.
+//
+//  This program is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU General Public License
+//  as published by the Free Software Foundation; either version 2
+//  of the License, or (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//----------------------------------------------------------------------------
+
+#ifndef __S_MCACHE_H__
+#define __S_MCACHE_H__
+
+#include "system/i_defs.h"
+
+/* abstract base class */
+class music_renderer_c
+{
+public:
+	music_renderer_c() { }
+	virtual ~music_renderer_c() { }
+
+	// synthesize the next 'pairs' samples of the song (interleaved
+	// when dev_stereo) into 'buf'.  Returns false once the end of
+	// the song has been reached, the samples from that call being
+	// the last ones of the song.  Called from the render thread.
+	virtual bool Render(s16_t *buf, int pairs) = 0;
+};
+
+/* VARIABLES */
+
+extern int au_mus_cache;
+
+/* FUNCTIONS */
+
+abstract_music_c * S_PlayCachedMusic(const byte *data, int length, bool is_mus,
+									 float volume, bool loop);
+// when the MUS/MIDI song has already been rendered (with the
+// current synthesizer and settings), play it from the cache.
+// Otherwise returns NULL and (when au_mus_cache is enabled) starts
+// rendering the song on a worker thread for next time.
+// The data is not freed.
+
+void S_ShutdownMusicCache(void);
+// stops any rendering in progress.
+
+#endif /* __S_MCACHE_H__ */
+
+//--- editor settings ---
+// vi:ts=4:sw=4:noexpandtab
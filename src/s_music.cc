@@ -20,6 +20,7 @@
 //
 
 #include "system/i_defs.h"
+#include "system/i_sdlinc.h"
 
 #include <stdlib.h>
 
@@ -32,7 +33,9 @@
 
 #include "dm_state.h"
 #include "s_sound.h"
+#include "s_blit.h"
 #include "s_music.h"
+#include "s_mcache.h"
 #include "s_mp3.h"
 #include "s_ogg.h"
 #include "s_tsf.h"
@@ -46,6 +49,11 @@
 // music slider value
 DEF_CVAR(au_mus_volume, int, "c", CFGDEF_MUSIC_VOLUME);
 
+// decode music on a background thread, keeping this many
+// buffers queued ahead of the mixer.
+DEF_CVAR(au_mus_thread, int, "c", 1);
+DEF_CVAR(au_mus_prefetch, int, "c", 4);
+
 int var_music_dev;
 
 bool nomusic = false;
@@ -58,12 +66,123 @@ static abstract_music_c *music_player;
 static int  entry_playing = -1;
 static bool entry_looped;
 
+// -- background decoding --
+//
+// The music_lock protects music_player (and everything it owns)
+// against the decoder thread.  Lock order is always music_lock
+// first, then the audio device lock (taken by the S_Queue calls).
+
+#define MUSIC_THREAD_DELAY  10  // millisecs
+
+static SDL_Thread  *music_thread;
+static SDL_mutex   *music_lock;
+static SDL_atomic_t music_thread_quit;
+
+// decoder statistics, protected by music_lock
+static int   decode_passes;
+static u64_t decode_total_us;
+static u32_t decode_max_us;
+
+
+static inline void LockMusic(void)
+{
+	if (music_lock)
+		SDL_LockMutex(music_lock);
+}
+
+static inline void UnlockMusic(void)
+{
+	if (music_lock)
+		SDL_UnlockMutex(music_lock);
+}
+
+static void DecodeMusic(void)
+{
+	// NOTE: assumes music_lock is held
+
+	if (! music_player)
+		return;
+
+	u32_t start = I_ReadMicroSeconds();
+
+	music_player->Ticker();
+
+	u32_t spent = I_ReadMicroSeconds() - start;
+
+	decode_passes++;
+	decode_total_us += spent;
+	decode_max_us = MAX(decode_max_us, spent);
+}
+
+static int MusicThreadFunc(void *data)
+{
+	while (! SDL_AtomicGet(&music_thread_quit))
+	{
+		if (au_mus_thread)
+		{
+			LockMusic();
+			{
+				S_QueueSetLimit(CLAMP(2, au_mus_prefetch, 16));
+
+				DecodeMusic();
+			}
+			UnlockMusic();
+		}
+
+		SDL_Delay(MUSIC_THREAD_DELAY);
+	}
+
+	return 0;
+}
+
+void S_StartMusicThread(void)
+{
+	// offline rendering must decode in step with the game tics
+	if (nomusic || offline_audio || music_thread)
+		return;
+
+	if (! music_lock)
+		music_lock = SDL_CreateMutex();
+
+	SDL_AtomicSet(&music_thread_quit, 0);
+
+	music_thread = SDL_CreateThread(MusicThreadFunc, "EDGE Music", NULL);
+
+	if (! music_thread)
+		I_Warning("S_StartMusicThread: %s (decoding on main thread)\n", SDL_GetError());
+}
+
+void S_StopMusicThread(void)
+{
+	if (music_thread)
+	{
+		SDL_AtomicSet(&music_thread_quit, 1);
+		SDL_WaitThread(music_thread, NULL);
+
+		music_thread = NULL;
+	}
+
+	S_QueueSetLimit(0);
+}
+
+
+static void DoChangeMusic(int entrynum, bool loop);
 
 void S_ChangeMusic(int entrynum, bool loop)
 {
 	if (nomusic)
 		return;
 
+	LockMusic();
+	{
+		DoChangeMusic(entrynum, loop);
+	}
+	UnlockMusic();
+}
+
+static void DoChangeMusic(int entrynum, bool loop)
+{
+
 	// -AJA- playlist number 0 reserved to mean "no music"
 	if (entrynum <= 0)
 	{
@@ -230,6 +349,19 @@ void S_ChangeMusic(int entrynum, bool loop)
 	}
 	bool is_mus = (data[0] == 'M' && data[1] == 'U' && data[2] == 'S');
 
+	if (var_music_dev != 0 || ! is_mus)
+	{
+		// already rendered?  (also starts rendering if not)
+		music_player = S_PlayCachedMusic(data, length, is_mus, volume, loop);
+
+		if (music_player)
+		{
+			delete F;
+			delete[] data;
+			return;
+		}
+	}
+
 	if (var_music_dev == 0 && is_mus)
 		music_player = I_PlayNativeMusic(data, length, volume, loop);
     else if (var_music_dev == 1)
@@ -324,15 +456,23 @@ void S_ChangeMusic(int entrynum, bool loop)
 
 void S_ResumeMusic(void)
 {
-	if (music_player)
-		music_player->Resume();
+	LockMusic();
+	{
+		if (music_player)
+			music_player->Resume();
+	}
+	UnlockMusic();
 }
 
 
 void S_PauseMusic(void)
 {
-	if (music_player)
-		music_player->Pause();
+	LockMusic();
+	{
+		if (music_player)
+			music_player->Pause();
+	}
+	UnlockMusic();
 }
 
 
@@ -340,30 +480,68 @@ void S_StopMusic(void)
 {
 	// You can't stop the rock!! This does...
 
-	if (music_player)
+	// NOTE: the lock is recursive, DoChangeMusic() calls us too.
+	LockMusic();
 	{
-		music_player->Stop();
+		if (music_player)
+		{
+			music_player->Stop();
 
-		delete music_player;
-		music_player = NULL;
-	}
+			delete music_player;
+			music_player = NULL;
+		}
 
-	entry_playing = -1;
-	entry_looped  = false;
+		entry_playing = -1;
+		entry_looped  = false;
+	}
+	UnlockMusic();
 }
 
 
 void S_MusicTicker(void)
 {
-	if (music_player)
-		music_player->Ticker();
+	// the decoder thread does the work when it is running
+	if (music_thread && au_mus_thread)
+		return;
+
+	LockMusic();
+	{
+		S_QueueSetLimit(0);
+
+		DecodeMusic();
+	}
+	UnlockMusic();
 }
 
 
 void S_ChangeMusicVolume(void)
 {
-	if (music_player)
-		music_player->Volume(slider_to_gain[au_mus_volume]);
+	LockMusic();
+	{
+		if (music_player)
+			music_player->Volume(slider_to_gain[au_mus_volume]);
+	}
+	UnlockMusic();
+}
+
+
+void S_ShowMusicStats(void)
+{
+	int queued = S_QueueNumPlaying();
+
+	LockMusic();
+	{
+		I_Printf("Music decoding: %s\n",
+			(music_thread && au_mus_thread) ? "background thread" : "main loop");
+
+		I_Printf("  queued buffers: %d (prefetch %d)\n", queued, au_mus_prefetch);
+		I_Printf("  underruns: %d\n", S_QueueUnderruns());
+
+		if (decode_passes > 0)
+			I_Printf("  decode passes: %d  avg %1.2f ms  max %1.2f ms\n", decode_passes,
+				(double)decode_total_us / 1000.0 / decode_passes, decode_max_us / 1000.0);
+	}
+	UnlockMusic();
 }
 
 
@@ -61,6 +61,12 @@ void S_MusicTicker(void);
 
 void S_ChangeMusicVolume(void);
 
+void S_StartMusicThread(void);
+void S_StopMusicThread(void);
+// start/stop the background decoder thread (see au_mus_thread).
+
+void S_ShowMusicStats(void);
+
 #endif /* __S_MUSIC_H__ */
 
 //--- editor settings ---
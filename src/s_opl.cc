@@ -22,6 +22,7 @@
 
 #include "s_blit.h"
 #include "s_music.h"
+#include "s_mcache.h"
 #include "s_opl.h"
 #include "w_wad.h"
 #include "m_misc.h"
@@ -188,6 +189,65 @@ void S_ShutdownOPL(void)
 }
 
 
+// renders a whole song with a private OPL_Player (used by the
+// music cache, see s_mcache.cc).
+class opl_renderer_c : public music_renderer_c
+{
+private:
+	OPL_Player *player;
+
+public:
+	opl_renderer_c(OPL_Player *_player) : player(_player)
+	{ }
+
+	~opl_renderer_c()
+	{
+		delete player;
+	}
+
+	bool Render(s16_t *buf, int pairs)
+	{
+		player->OPL_Generate(buf, pairs);
+
+		return player->OPL_IsPlaying();
+	}
+};
+
+
+music_renderer_c * S_CreateOPLRenderer(const byte *data, int length)
+{
+	if (!opl_inited)
+		return NULL;
+
+	byte *genmidi = (byte*)W_CacheLumpName("GENMIDI");
+	if (!genmidi)
+		return NULL;
+
+	OPL_Player *render_player = new OPL_Player();
+
+	bool ok = render_player->OPL_LoadGENMIDI((void*)genmidi);
+
+	W_DoneWithLump(genmidi);
+
+	if (ok)
+		ok = render_player->OPL_LoadSong((void*)data, length);
+
+	if (!ok)
+	{
+		delete render_player;
+		return NULL;
+	}
+
+	opl_config conf = { dev_freq, var_opl_opl3mode, dev_stereo };
+
+	render_player->OPL_SendConfig(conf);
+	render_player->OPL_Loop(false);
+	render_player->OPL_PlaySong();
+
+	return new opl_renderer_c(render_player);
+}
+
+
 abstract_music_c * S_PlayOPL(byte *data, int length, float volume, bool loop)
 {
 	if (!opl_inited)
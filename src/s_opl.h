@@ -8,4 +8,10 @@ void S_ShutdownOPL(void);
 
 abstract_music_c * S_PlayOPL(byte *data, int length, float volume, bool loop);
 
+class music_renderer_c;
+
+music_renderer_c * S_CreateOPLRenderer(const byte *data, int length);
+// prepares offline rendering of a MUS/MIDI song (the data is copied).
+// Returns NULL when the song cannot be played.
+
 #endif
@@ -29,6 +29,8 @@
 #include "s_sound.h"
 #include "s_cache.h"
 #include "s_blit.h"
+#include "s_music.h"
+#include "s_mcache.h"
 
 #include "p_local.h" // P_ApproxDistance
 #include "p_user.h" // room_area
@@ -152,6 +154,26 @@ static int FindPlayingFX(sfxdef_c *def, int cat, position_c *pos)
 	return -1; // not found
 }
 
+static int FindVirtualFX(sfxdef_c *def, int cat, position_c *pos)
+{
+	for (int v=0; v < num_virt; v++)
+	{
+		mix_channel_c *chan = virt_chan[v];
+
+		if (chan->state == CHAN_Playing && chan->category == cat &&
+			chan->pos == pos)
+		{
+			if (chan->def == def)
+				return v;
+
+			if (chan->def->singularity > 0 && chan->def->singularity == def->singularity)
+				return v;
+		}
+	}
+
+	return -1; // not found
+}
+
 static int FindBiggestHog(int real_cat)
 {
 	int biggest_hog = -1;
@@ -269,6 +291,8 @@ void S_Init(void)
 
 	S_QueueInit();
 
+	S_StartMusicThread();
+
 	// okidoke, start the ball rolling!
 	SDL_PauseAudioDevice(mydev_id, 0);
 }
@@ -277,6 +301,9 @@ void S_Shutdown(void)
 {
 	if (nosound) return;
 
+	S_StopMusicThread();
+	S_ShutdownMusicCache();
+
 	SDL_PauseAudioDevice(mydev_id, 1);
 
 	// make sure mixing thread is not running our code
@@ -308,17 +335,15 @@ sfxdef_c * LookupEffectDef(const sfx_t *s)
 	return sfxdefs[num];
 }
 
-static void S_PlaySound(int idx, sfxdef_c *def, int category, position_c *pos, int flags, epi::sound_data_c *buf)
+static void S_PlaySound(mix_channel_c *chan, sfxdef_c *def, int category, position_c *pos, int flags, epi::sound_data_c *buf)
 {
-//I_Printf("S_PlaySound on idx #%d DEF:%p\n", idx, def);
+//I_Printf("S_PlaySound on chan %p DEF:%p\n", chan, def);
 
 //I_Printf("Looked up def: %p, caching...\n", def);
 	//epi::sound_data_c *buf = S_CacheLoad(def);
 	//if (! buf)
 		//return;
 
-	mix_channel_c *chan = mix_chan[idx];
-
 	chan->state = CHAN_Playing;
 	chan->data  = buf;
 
@@ -364,10 +389,59 @@ static void S_PlaySound(int idx, sfxdef_c *def, int category, position_c *pos, i
 //I_Printf("FINISHED: delta=0x%lx\n", chan->delta);
 }
 
-static void DoStartFX(sfxdef_c *def, int category, position_c *pos, int flags, epi::sound_data_c *buf)
+static bool StartVirtualFX(sfxdef_c *def, int category, position_c *pos, int flags, epi::sound_data_c *buf)
+{
+	// only positional sounds can become virtual, since they are
+	// the only ones which can become audible again.
+	if (! sound_virtual || ! pos || category < SNCAT_Opponent || (flags & FX_Boss))
+		return false;
+
+	int v = S_FindFreeVirtual();
+
+	if (v < 0)
+		return false;
+
+	S_KillVirtual(v);
+	S_PlaySound(virt_chan[v], def, category, pos, flags, buf);
+
+	return true;
+}
+
+static void DoStartFX(sfxdef_c *def, int category, position_c *pos, int flags, epi::sound_data_c *buf, bool inaudible)
 {
 	CountPlayingCats();
 
+	int v = FindVirtualFX(def, category, pos);
+
+	if (v >= 0)
+	{
+		mix_channel_c *chan = virt_chan[v];
+
+		if (def->looping && def == chan->def)
+		{
+			chan->loop = true;
+			S_CacheRelease(buf);
+			return;
+		}
+		else if (flags & FX_Single)
+		{
+			if (flags & FX_Precious)
+			{
+				S_CacheRelease(buf);
+				return;
+			}
+
+			S_KillVirtual(v);
+		}
+	}
+
+	if (inaudible)
+	{
+		if (! StartVirtualFX(def, category, pos, flags, buf))
+			S_CacheRelease(buf);
+		return;
+	}
+
 	int k = FindPlayingFX(def, category, pos);
 
 	if (k >= 0)
@@ -379,16 +453,20 @@ static void DoStartFX(sfxdef_c *def, int category, position_c *pos, int flags, e
 		{
 //I_Printf("@@ RE-LOOPING\n");
 			chan->loop = true;
+			S_CacheRelease(buf);
 			return;
 		}
 		else if (flags & FX_Single)
 		{
 			if (flags & FX_Precious)
+			{
+				S_CacheRelease(buf);
 				return;
+			}
 
 //I_Printf("@@ Killing sound for SINGULAR\n");
 			S_KillChannel(k);
-			S_PlaySound(k, def, category, pos, flags, buf);
+			S_PlaySound(mix_chan[k], def, category, pos, flags, buf);
 			return;
 		}
 	}
@@ -426,13 +504,21 @@ static void DoStartFX(sfxdef_c *def, int category, position_c *pos, int flags, e
 
 //if (k<0) I_Printf("- new score too low\n");
 		if (k < 0)
+		{
+			// keep tracking it, it may become audible later
+			if (! StartVirtualFX(def, category, pos, flags, buf))
+				S_CacheRelease(buf);
 			return;
+		}
 
 //I_Printf("- killing channel %d (kill_cat:%d)  my_cat:%d\n", k, kill_cat, category);
-		S_KillChannel(k);
+		if (sound_virtual && mix_chan[k]->pos && kill_cat >= SNCAT_Opponent && ! mix_chan[k]->boss)
+			S_VirtualizeChannel(k);
+		else
+			S_KillChannel(k);
 	}
 
-	S_PlaySound(k, def, category, pos, flags, buf);
+	S_PlaySound(mix_chan[k], def, category, pos, flags, buf);
 }
 
 
@@ -450,13 +536,20 @@ void S_StartFX(sfx_t *sfx, int category, position_c *pos, int flags)
 	sfxdef_c *def = LookupEffectDef(sfx);
 	SYS_ASSERT(def);
 
-	// ignore very far away sounds
+	// ignore very far away sounds (or track them as virtual voices)
+	bool inaudible = false;
+
 	if (category >= SNCAT_Opponent && !(flags & FX_Boss))
 	{
 		float dist = P_ApproxDistance(listen_x - pos->x, listen_y - pos->y, listen_z - pos->z);
 
 		if (dist > def->max_distance)
-			return;
+		{
+			if (! sound_virtual)
+				return;
+
+			inaudible = true;
+		}
 	}
 
 	if (def->singularity > 0)
@@ -487,7 +580,7 @@ void S_StartFX(sfx_t *sfx, int category, position_c *pos, int flags)
 	}
 	I_LockAudio();
 	{
-		DoStartFX(def, category, pos, flags, buf);
+		DoStartFX(def, category, pos, flags, buf, inaudible);
 	}
 	I_UnlockAudio();
 }
@@ -509,6 +602,12 @@ void S_StopFX(position_c *pos)
 				S_KillChannel(i);
 			}
 		}
+
+		for (int v = 0; v < num_virt; v++)
+		{
+			if (virt_chan[v]->state == CHAN_Playing && virt_chan[v]->pos == pos)
+				S_KillVirtual(v);
+		}
 	}
 	I_UnlockAudio();
 }
@@ -528,6 +627,9 @@ void S_StopLevelFX(void)
 				S_KillChannel(i);
 			}
 		}
+
+		for (int v = 0; v < num_virt; v++)
+			S_KillVirtual(v);
 	}
 	I_UnlockAudio();
 }
@@ -582,5 +684,45 @@ void S_PrecacheSounds(void)
 	}
 }
 
+void S_ShowAudioStats(void)
+{
+	static const char *cat_names[SNCAT_NUMTYPES] =
+	{
+		"UI", "Player", "Weapon", "Opponent", "Monster", "Object", "Level"
+	};
+
+	if (nosound)
+	{
+		I_Printf("Sound is disabled.\n");
+		return;
+	}
+
+	mix_stats_t ms;
+	S_GetMixStats(&ms, false);
+
+	cache_stats_t cs;
+	S_CacheGetStats(&cs);
+
+	I_Printf("Audio voices: %d real, %d virtual\n", num_chan, num_virt);
+
+	for (int c = 0; c < SNCAT_NUMTYPES; c++)
+		I_Printf("  %-8s active %2d  virtual %2d\n", cat_names[c],
+			ms.real_voices[c], ms.virt_voices[c]);
+
+	if (ms.mix_calls > 0)
+		I_Printf("Mixer: %d callbacks  min %1.1f us  avg %1.1f us  max %1.1f us\n",
+			ms.mix_calls, ms.mix_min_us, ms.mix_avg_us, ms.mix_max_us);
+
+	I_Printf("Music queue: %d buffers, %d underruns\n", ms.queue_depth, ms.queue_underruns);
+
+	int lookups = cs.hits + cs.misses;
+
+	I_Printf("SFX cache: %d sounds, %d KB, hit rate %1.1f%% (%d / %d)\n",
+		cs.entries, (cs.bytes + 1023) / 1024,
+		lookups ? cs.hits * 100.0f / lookups : 0.0f, cs.hits, lookups);
+
+	I_Printf("FX mix recomputations: %d\n", epi::sound_data_c::mix_passes);
+}
+
 //--- editor settings ---
 // vi:ts=4:sw=4:noexpandtab
@@ -108,6 +108,9 @@ void S_SoundTicker(void);
 void S_ChangeSoundVolume(void);
 void S_ChangeChannelNum(void);
 
+void S_ShowAudioStats(void);
+// print voice, mixer and sfx cache statistics to the console.
+
 #endif /* __S_SOUND_H__ */
 
 //--- editor settings ---
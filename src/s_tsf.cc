@@ -27,6 +27,7 @@
 
 #include "s_blit.h"
 #include "s_music.h"
+#include "s_mcache.h"
 #include "s_tsf.h"
 
 #include "dm_state.h"
@@ -46,6 +47,55 @@ static bool tsf_inited;
 
 tsf *edge_tsf;
 
+static bool TSF_PlaySome(tsf *synth, tml_message **song_p, double *time_p,
+						 s16_t *data_buf, int samples)
+{
+	// plays the next 'samples' of the song, returns true once the
+	// end of the song has been reached.
+
+	tml_message *song = *song_p;
+	double current_time = *time_p;
+
+	int SampleBlock, SampleCount = samples;
+
+	for (SampleBlock = TSF_RENDER_EFFECTSAMPLEBLOCK; SampleCount; SampleCount -= SampleBlock, data_buf += SampleBlock * (dev_stereo ? 2 : 1))
+	{
+		//We progress the MIDI playback and then process TSF_RENDER_EFFECTSAMPLEBLOCK samples at once
+		if (SampleBlock > SampleCount) SampleBlock = SampleCount;
+
+		for (current_time += SampleBlock * (1000.0 / dev_freq); song && current_time >= song->time; song = song->next)
+		{
+			switch (song->type)
+			{
+				case TML_PROGRAM_CHANGE: //channel program (preset) change (special handling for 10th MIDI channel with drums)
+					tsf_channel_set_presetnumber(synth, song->channel, song->program, (song->channel == 9));
+					break;
+				case TML_NOTE_ON: //play a note
+					tsf_channel_note_on(synth, song->channel, song->key, song->velocity / 127.0f);
+					break;
+				case TML_NOTE_OFF: //stop a note
+					tsf_channel_note_off(synth, song->channel, song->key);
+					break;
+				case TML_PITCH_BEND: //pitch wheel modification
+					tsf_channel_set_pitchwheel(synth, song->channel, song->pitch_bend);
+					break;
+				case TML_CONTROL_CHANGE: //MIDI controller messages
+					tsf_channel_midi_control(synth, song->channel, song->control, song->control_value);
+					break;
+			}
+		}
+
+		// Render the block of audio samples in short format
+		tsf_render_short(synth, data_buf, SampleBlock, 0);
+	}
+
+	*song_p = song;
+	*time_p = current_time;
+
+	return (song == NULL);
+}
+
+
 class tsf_player_c : public abstract_music_c
 {
 private:
@@ -167,42 +217,9 @@ public:
 
 private:
 
-	bool PlaySome(s16_t *data_buf, int samples) {
-
-		int SampleBlock, SampleCount = samples;
-
-		for (SampleBlock = TSF_RENDER_EFFECTSAMPLEBLOCK; SampleCount; SampleCount -= SampleBlock, data_buf += (SampleBlock * (dev_stereo ? 2 : 1 * sizeof(float))))
-		{
-			//We progress the MIDI playback and then process TSF_RENDER_EFFECTSAMPLEBLOCK samples at once
-			if (SampleBlock > SampleCount) SampleBlock = SampleCount;
-
-			for (current_time += SampleBlock * (1000.0 / dev_freq); song && current_time >= song->time; song = song->next)
-			{
-				switch (song->type)
-				{
-					case TML_PROGRAM_CHANGE: //channel program (preset) change (special handling for 10th MIDI channel with drums)
-						tsf_channel_set_presetnumber(edge_tsf, song->channel, song->program, (song->channel == 9));
-						break;
-					case TML_NOTE_ON: //play a note
-						tsf_channel_note_on(edge_tsf, song->channel, song->key, song->velocity / 127.0f);
-						break;
-					case TML_NOTE_OFF: //stop a note
-						tsf_channel_note_off(edge_tsf, song->channel, song->key);
-						break;
-					case TML_PITCH_BEND: //pitch wheel modification
-						tsf_channel_set_pitchwheel(edge_tsf, song->channel, song->pitch_bend);
-						break;
-					case TML_CONTROL_CHANGE: //MIDI controller messages
-						tsf_channel_midi_control(edge_tsf, song->channel, song->control, song->control_value);
-						break;
-				}
-			}
-
-			// Render the block of audio samples in short format
-			tsf_render_short(edge_tsf, data_buf, SampleBlock, 0);
-		}
-		
-		return (song == NULL);
+	bool PlaySome(s16_t *data_buf, int samples)
+	{
+		return TSF_PlaySome(edge_tsf, &song, &current_time, data_buf, samples);
 	}
 
 	bool StreamIntoBuffer(epi::sound_data_c *buf)
@@ -237,6 +254,35 @@ private:
 	}
 };
 
+// renders a whole song with a private copy of the synthesizer
+// (used by the music cache, see s_mcache.cc).
+class tsf_renderer_c : public music_renderer_c
+{
+private:
+	tsf *synth;
+
+	tml_message *first;
+	tml_message *song;
+	double current_time;
+
+public:
+	tsf_renderer_c(tsf *_synth, tml_message *_song) :
+		synth(_synth), first(_song), song(_song), current_time(0)
+	{ }
+
+	~tsf_renderer_c()
+	{
+		tml_free(first);
+		tsf_close(synth);
+	}
+
+	bool Render(s16_t *buf, int pairs)
+	{
+		return ! TSF_PlaySome(synth, &song, &current_time, buf, pairs);
+	}
+};
+
+
 bool S_StartupTSF(void)
 {
 
@@ -305,5 +351,45 @@ abstract_music_c * S_PlayTSF(byte *data, int length, bool is_mus,
 	return player;
 }
 
+music_renderer_c * S_CreateTSFRenderer(const byte *data, int length, bool is_mus)
+{
+	if (!tsf_inited)
+		return NULL;
+
+	tml_message *song;
+
+	if (is_mus)
+	{
+		byte *midi_data;
+		int midi_len;
+
+		if (! Mus2Midi::Convert(data, length, &midi_data, &midi_len,
+					Mus2Midi::DOOM_DIVIS, true))
+			return NULL;
+
+		song = tml_load_memory(midi_data, midi_len);
+
+		delete[] midi_data;
+	}
+	else
+		song = tml_load_memory(data, length);
+
+	if (!song)
+		return NULL;
+
+	// the copy shares the (read-only) soundfont data
+	tsf *synth = tsf_copy(edge_tsf);
+
+	if (!synth)
+	{
+		tml_free(song);
+		return NULL;
+	}
+
+	tsf_channel_set_bank_preset(synth, 9, 128, 0);
+
+	return new tsf_renderer_c(synth, song);
+}
+
 //--- editor settings ---
 // vi:ts=4:sw=4:noexpandtab
@@ -27,6 +27,12 @@ bool S_StartupTSF(void);
 abstract_music_c * S_PlayTSF(byte *data, int length, bool is_mus,
 			float volume, bool loop);
 
+class music_renderer_c;
+
+music_renderer_c * S_CreateTSFRenderer(const byte *data, int length, bool is_mus);
+// prepares offline rendering of a MUS/MIDI song (the data is copied).
+// Returns NULL when the song cannot be played.
+
 #endif /* __S_TSF_H__ */
 
 //--- editor settings ---
@@ -200,7 +200,6 @@ static savefield_t sv_fields_line[] =
 	// NOT HERE:
 	//   (many): values are kept from level load.
 	//   gap stuff: regenerated from sector heights.
-	//   validcount: only a temporary value for some routines.
 	//   slider_move: regenerated by a pass of the active part list.
 
 	SVFIELD_END
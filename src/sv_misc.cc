@@ -245,6 +245,7 @@ static savefield_t sv_fields_trigger[] =
 	//   - tag_next & tag_prev: ditto
 	//   - sound: can be recomputed.
 	//   - last_con_message: doesn't matter.
+	//   - order & picked_tic: regenerated with the trigger index.
 
 	SVFIELD_END
 };
@@ -64,6 +64,29 @@ void SR_MobjPutState(void *storage, int index, void *extra);
 void SR_MobjPutSpawnPoint(void *storage, int index, void *extra);
 void SR_MobjPutAttack(void *storage, int index, void *extra);
 
+// The rarely used fields are in mobj_t::cold, so their entries below
+// refer to that pointer, and these routines follow it to the field.
+#define COLD_FIELD_RW(name, field, getter, putter)  \
+	static bool SR_MobjGetCold_##name(void *storage, int index, void *extra)  \
+	{  \
+		mobj_cold_t *cold = *(mobj_cold_t **)storage;  \
+		return getter(&cold->field, index, extra);  \
+	}  \
+	static void SR_MobjPutCold_##name(void *storage, int index, void *extra)  \
+	{  \
+		mobj_cold_t *cold = *(mobj_cold_t **)storage;  \
+		putter(&cold->field, index, extra);  \
+	}
+
+COLD_FIELD_RW(model_skin,    model_skin,    SR_GetInt,   SR_PutInt)
+COLD_FIELD_RW(tag,           tag,           SR_GetInt,   SR_PutInt)
+COLD_FIELD_RW(spawnpoint,    spawnpoint,    SR_MobjGetSpawnPoint, SR_MobjPutSpawnPoint)
+COLD_FIELD_RW(origheight,    origheight,    SR_GetFloat, SR_PutFloat)
+COLD_FIELD_RW(path_trigger,  path_trigger,  SR_TriggerGetScript, SR_TriggerPutScript)
+COLD_FIELD_RW(dlight_qty,    dlight.r,      SR_GetFloat, SR_PutFloat)
+COLD_FIELD_RW(dlight_target, dlight.target, SR_GetFloat, SR_PutFloat)
+COLD_FIELD_RW(dlight_color,  dlight.color,  SR_GetRGB,   SR_PutRGB)
+
 //----------------------------------------------------------------------------
 //
 //  MOBJ STRUCTURE AND ARRAY
@@ -98,14 +121,17 @@ static savefield_t sv_fields_mobj[] =
 	SF(movecount, "movecount", 1, SVT_INT, SR_GetInt, SR_PutInt),
 	SF(reactiontime, "reactiontime", 1, SVT_INT, SR_GetInt, SR_PutInt),
 	SF(threshold, "threshold", 1, SVT_INT, SR_GetInt, SR_PutInt),
-	SF(model_skin, "model_skin", 1, SVT_INT, SR_GetInt, SR_PutInt),
-	SF(tag, "tag", 1, SVT_INT, SR_GetInt, SR_PutInt),
+	SF(cold, "model_skin", 1, SVT_INT,
+		SR_MobjGetCold_model_skin, SR_MobjPutCold_model_skin),
+	SF(cold, "tag", 1, SVT_INT,
+		SR_MobjGetCold_tag, SR_MobjPutCold_tag),
 	SF(side, "side", 1, SVT_INT, SR_GetInt, SR_PutInt),
 	SF(player, "player", 1, SVT_INDEX("players"), 
 		SR_MobjGetPlayer, SR_MobjPutPlayer),
-	SF(spawnpoint, "spawnpoint", 1, SVT_STRUCT("spawnpoint_t"), 
-		SR_MobjGetSpawnPoint, SR_MobjPutSpawnPoint),
-	SF(origheight, "origheight", 1, SVT_FLOAT, SR_GetFloat, SR_PutFloat),
+	SF(cold, "spawnpoint", 1, SVT_STRUCT("spawnpoint_t"),
+		SR_MobjGetCold_spawnpoint, SR_MobjPutCold_spawnpoint),
+	SF(cold, "origheight", 1, SVT_FLOAT,
+		SR_MobjGetCold_origheight, SR_MobjPutCold_origheight),
 	SF(visibility, "visibility", 1, SVT_FLOAT, SR_GetFloat, SR_PutFloat),
 	SF(vis_target, "vis_target", 1, SVT_FLOAT, SR_GetFloat, SR_PutFloat),
 	SF(vertangle, "vertangle", 1, SVT_FLOAT, SR_GetAngleFromSlope, SR_PutAngleToSlope),
@@ -120,16 +146,20 @@ static savefield_t sv_fields_mobj[] =
 	SF(ride_dx, "ride_dx", 1, SVT_FLOAT, SR_GetFloat, SR_PutFloat),
 	SF(ride_dy, "ride_dy", 1, SVT_FLOAT, SR_GetFloat, SR_PutFloat),
 	SF(on_ladder, "on_ladder", 1, SVT_INT, SR_GetInt, SR_PutInt),
-	SF(path_trigger, "path_trigger", 1, SVT_STRING,
-	    SR_TriggerGetScript, SR_TriggerPutScript),
-	SF(dlight.r, "dlight_qty", 1, SVT_FLOAT, SR_GetFloat, SR_PutFloat),
-	SF(dlight.target, "dlight_target", 1, SVT_FLOAT, SR_GetFloat, SR_PutFloat),
-	SF(dlight.color, "dlight_color", 1, SVT_RGBCOL, SR_GetRGB, SR_PutRGB),
+	SF(cold, "path_trigger", 1, SVT_STRING,
+		SR_MobjGetCold_path_trigger, SR_MobjPutCold_path_trigger),
+	SF(cold, "dlight_qty", 1, SVT_FLOAT,
+		SR_MobjGetCold_dlight_qty, SR_MobjPutCold_dlight_qty),
+	SF(cold, "dlight_target", 1, SVT_FLOAT,
+		SR_MobjGetCold_dlight_target, SR_MobjPutCold_dlight_target),
+	SF(cold, "dlight_color", 1, SVT_RGBCOL,
+		SR_MobjGetCold_dlight_color, SR_MobjPutCold_dlight_color),
 	SF(shot_count, "shot_count", 1, SVT_INT, SR_GetInt, SR_PutInt),
 
 	// NOT HERE:
 	//   subsector & region: these are regenerated.
 	//   next,prev,snext,sprev,bnext,bprev: links are regenerated.
+	//   live_index: regenerated.
 	//   tunnel_hash: would be meaningless, and not important.
 	//   lastlookup: being reset to zero won't hurt.
 	//   ...
@@ -322,24 +352,16 @@ void SV_MobjCreateElems(int num_elems)
 
 	for (; num_elems > 0; num_elems--)
 	{
-		mobj_t *cur = Z_New(mobj_t, 1);
-
-		Z_Clear(cur, mobj_t, 1);
-
-		cur->next = mobjlisthead;
-		cur->prev = NULL;
-
-		if (mobjlisthead)
-			mobjlisthead->prev = cur;
+		mobj_t *cur = P_MobjAlloc();
 
-		mobjlisthead = cur;
+		P_AddMobjToList(cur);
 
 		// initialise defaults
 		cur->info  = NULL;
 		cur->state = cur->next_state = states+1;
 
-		cur->model_skin = 1;
-		cur->model_last_frame = -1;
+		cur->cold->model_skin = 1;
+		cur->cold->model_last_frame = -1;
 	}
 }
 
@@ -30,6 +30,8 @@
 #include <sys/time.h>
 #endif
 
+#include "../../epi/endianess.h"
+
 #include "../m_argv.h"
 #include "../m_misc.h"
 #include "../m_random.h"
@@ -42,6 +44,10 @@
 // If true, sound system is off/not working. Changed to false if sound init ok.
 bool nosound = false;
 
+// If true, there is no audio device: the mixer is pulled once per
+// game tic by I_SoundTicker() (-nullaudio or -wavout).
+bool offline_audio = false;
+
 // Pitch to stepping lookup
 static int steptable[256];
 
@@ -80,7 +86,8 @@ static sound_mode_t mode_try_list[2 * 6 * 2];
 static char errordesc[256] = "FOO";
 static char scratcherror[256];
 
-static bool audio_is_locked = false;
+// per thread, since the music decoder locks audio too
+static thread_local bool audio_is_locked = false;
 
 void SoundFill_Callback(void* udata, Uint8* stream, int len)
 {
@@ -88,6 +95,153 @@ void SoundFill_Callback(void* udata, Uint8* stream, int len)
 	S_MixAllChannels(stream, len);
 }
 
+//----------------------------------------------------------------------------
+//  OFFLINE RENDERING
+//----------------------------------------------------------------------------
+
+static FILE *wav_fp;
+static int   wav_data_bytes;
+
+static byte *offline_buf;
+static int   offline_frac;  // leftover samples*TICRATE between tics
+
+// mixer throughput
+static int   offline_tics;
+static float offline_mix_ms;
+
+static void WAV_PutU32(byte *dest, u32_t value)
+{
+	value = EPI_LE_U32(value);
+	memcpy(dest, &value, 4);
+}
+
+static void WAV_PutU16(byte *dest, u16_t value)
+{
+	value = EPI_LE_U16(value);
+	memcpy(dest, &value, 2);
+}
+
+static void WAV_WriteHeader(void)
+{
+	int channels = dev_stereo ? 2 : 1;
+
+	byte header[44];
+
+	memcpy(header +  0, "RIFF", 4);
+	WAV_PutU32(header +  4, 36 + wav_data_bytes);
+	memcpy(header +  8, "WAVEfmt ", 8);
+	WAV_PutU32(header + 16, 16);  // size of fmt chunk
+	WAV_PutU16(header + 20, 1);   // PCM
+	WAV_PutU16(header + 22, channels);
+	WAV_PutU32(header + 24, dev_freq);
+	WAV_PutU32(header + 28, dev_freq * dev_bytes_per_sample);
+	WAV_PutU16(header + 32, dev_bytes_per_sample);
+	WAV_PutU16(header + 34, dev_bits);
+	memcpy(header + 36, "data", 4);
+	WAV_PutU32(header + 40, wav_data_bytes);
+
+	fseek(wav_fp, 0, SEEK_SET);
+	fwrite(header, sizeof(header), 1, wav_fp);
+	fseek(wav_fp, 0, SEEK_END);
+}
+
+static void I_StartupOfflineSound(const char *wav_name, int want_freq, bool want_stereo)
+{
+	// always 16 bit signed, since that is what WAV files want
+	dev_freq   = want_freq;
+	dev_bits   = 16;
+	dev_signed = true;
+	dev_float  = false;
+	dev_stereo = want_stereo;
+
+	dev_bytes_per_sample = (dev_stereo ? 2 : 1) * 2;
+	dev_frag_pairs = dev_freq / TICRATE + 1;
+
+	offline_buf  = new byte[dev_frag_pairs * dev_bytes_per_sample];
+	offline_frac = 0;
+	offline_tics = 0;
+	offline_mix_ms = 0;
+
+	offline_audio = true;
+
+	if (wav_name)
+	{
+		wav_fp = fopen(wav_name, "wb");
+
+		if (! wav_fp)
+			I_Error("I_StartupSound: cannot create WAV file: %s\n", wav_name);
+
+		wav_data_bytes = 0;
+
+		WAV_WriteHeader();
+	}
+
+	I_Printf("I_StartupSound: Offline @ %d Hz, %d bit %s%s%s\n",
+		dev_freq, dev_bits, dev_stereo ? "Stereo" : "Mono",
+		wav_name ? " --> " : "", wav_name ? wav_name : "");
+}
+
+static void I_ShutdownOfflineSound(void)
+{
+	if (offline_tics > 0)
+		I_Printf("I_ShutdownSound: mixed %d tics (%1.1f sec) in %1.1f ms\n",
+			offline_tics, offline_tics / (float)TICRATE, offline_mix_ms);
+
+	if (wav_fp)
+	{
+		WAV_WriteHeader();
+
+		fclose(wav_fp);
+		wav_fp = NULL;
+
+		I_Printf("I_ShutdownSound: wrote %d bytes of WAV data\n", wav_data_bytes);
+	}
+
+	delete[] offline_buf;
+	offline_buf = NULL;
+
+	offline_audio = false;
+}
+
+void I_SoundTicker(void)
+{
+	// the SDL callback does the work for a real device
+	if (nosound || ! offline_audio)
+		return;
+
+	// exactly dev_freq samples every TICRATE tics, no matter how
+	// fast (or slow) the tics are being run.
+	offline_frac += dev_freq;
+
+	int pairs = offline_frac / TICRATE;
+	offline_frac -= pairs * TICRATE;
+
+	int len = pairs * dev_bytes_per_sample;
+
+	u32_t start = I_ReadMicroSeconds();
+
+	memset(offline_buf, 0, len);
+	S_MixAllChannels(offline_buf, len);
+
+	offline_mix_ms += (I_ReadMicroSeconds() - start) / 1000.0f;
+	offline_tics++;
+
+	if (wav_fp)
+	{
+#if EPI_BYTEORDER == EPI_BIG_ENDIAN
+		s16_t *samp = (s16_t *) offline_buf;
+
+		for (int i = 0; i < len / 2; i++)
+			samp[i] = EPI_LE_S16(samp[i]);
+#endif
+		fwrite(offline_buf, len, 1, wav_fp);
+
+		wav_data_bytes += len;
+	}
+}
+
+//----------------------------------------------------------------------------
+
 static bool I_TryOpenSound(const sound_mode_t* mode)
 {
 	SDL_AudioSpec firstdev;
@@ -183,6 +337,22 @@ void I_StartupSound(void)
 {
 	if (nosound) return;
 
+	const char *wav_name = M_GetParm("-wavout");
+
+	if (wav_name || M_CheckParm("-nullaudio"))
+	{
+		int want_freq = sample_rates[var_sample_rate];
+
+		const char *p = M_GetParm("-freq");
+		if (p)
+			want_freq = atoi(p);
+
+		bool want_stereo = ! (M_CheckParm("-mono") > 0);
+
+		I_StartupOfflineSound(wav_name, want_freq, want_stereo);
+		return;
+	}
+
 	if (M_CheckParm("-waveout"))
 		force_waveout = true;
 
@@ -355,6 +525,12 @@ void I_ShutdownSound(void)
 
 	nosound = true;
 
+	if (offline_audio)
+	{
+		I_ShutdownOfflineSound();
+		return;
+	}
+
 	SDL_CloseAudio();
 }
 
@@ -376,7 +552,7 @@ void I_LockAudio(void)
 		I_Error("I_LockAudio: called twice without unlock!\n");
 	}
 
-	SDL_LockAudio();
+	SDL_LockAudioDevice(mydev_id);
 	audio_is_locked = true;
 }
 
@@ -384,7 +560,7 @@ void I_UnlockAudio(void)
 {
 	if (audio_is_locked)
 	{
-		SDL_UnlockAudio();
+		SDL_UnlockAudioDevice(mydev_id);
 		audio_is_locked = false;
 	}
 }
@@ -197,6 +197,11 @@ extern bool nosound;
 // to true by the "-nosound" option.  Can also be set to true by the
 // platform code when no working sound device is found.
 
+extern bool offline_audio;
+// True when there is no audio device and the mixer output is
+// produced once per game tic by I_SoundTicker(), either discarded
+// (the "-nullaudio" option) or written to a WAV file ("-wavout").
+
 void I_StartupSound(void);
 // Initialises the sound system.  Returns true if successful,
 // otherwise false if something went wrong (NOTE: you must set nosound
@@ -257,7 +262,8 @@ bool I_SoundKill(unsigned int chanid);
 // true on success, otherwise false.
 
 void I_SoundTicker(void);
-// Called every tic to keep the sounds playing.
+// Called every tic to keep the sounds playing.  For offline audio
+// this mixes exactly one tic worth of samples.
 
 const char *I_SoundReturnError(void);
 // Returns an error message string that describes the error from the
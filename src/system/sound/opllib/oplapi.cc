@@ -1352,6 +1352,11 @@ void OPL_Player::OPL_StopSong(void)
     MUS_StopSong();
 }
 
+bool OPL_Player::OPL_IsPlaying(void)
+{
+    return player_active;
+}
+
 void OPL_Player::OPL_Generate(Bit16s *buffer, Bit32u length)
 {
     for (Bit32u i = 0; i < length; i++)
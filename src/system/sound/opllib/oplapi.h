@@ -201,6 +201,7 @@ public:
     void OPL_SetMUSRate(Bit32u rate);
     bool OPL_PlaySong(void);
     void OPL_StopSong(void);
+    bool OPL_IsPlaying(void);
     void OPL_Generate(Bit16s *buffer, Bit32u length);
     void OPL_Loop(bool loop);
 };
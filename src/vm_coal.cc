@@ -22,11 +22,14 @@
 
 #include "../epi/file.h"
 #include "../epi/filesystem.h"
+#include "../epi/math_crc.h"
 #include "../epi/path.h"
+#include "../epi/str_format.h"
 
 #include "../ddf/main.h"
 
 #include "vm_coal.h"
+#include "con_var.h"
 #include "dm_state.h"
 #include "e_main.h"
 #include "g_game.h"
@@ -43,6 +46,28 @@
 // user interface VM
 coal::vm_c *ui_vm;
 
+// keep compiled scripts in the cache directory
+DEF_CVAR(coal_cache, int, "c", 1);
+
+
+// a script waiting to be compiled
+class coal_source_c
+{
+public:
+	std::string name;
+	bool is_lump;
+
+	byte *data;
+	int length;
+
+public:
+	coal_source_c(const char *_name, bool _lump, byte *_data, int _len) :
+		name(_name), is_lump(_lump), data(_data), length(_len)
+	{ }
+};
+
+static std::vector<coal_source_c> coal_sources;
+
 
 void VM_Printer(const char *msg, ...)
 {
@@ -71,17 +96,27 @@ void VM_SetString(coal::vm_c *vm, const char *name, const char *value)
 }
 
 
-void VM_CallFunction(coal::vm_c *vm, const char *name)
+int VM_FindFunction(coal::vm_c *vm, const char *name)
 {
 	int func = vm->FindFunction(name);
 
 	if (func == coal::vm_c::NOT_FOUND)
 		I_Error("Missing coal function: %s\n", name);
 
+	return func;
+}
+
+void VM_CallFunction(coal::vm_c *vm, int func, const char *name)
+{
 	if (vm->Execute(func) != 0)
 		I_Error("Coal script terminated with an error in the function: %s\n", name);
 }
 
+void VM_CallFunction(coal::vm_c *vm, const char *name)
+{
+	VM_CallFunction(vm, VM_FindFunction(vm, name), name);
+}
+
 
 //------------------------------------------------------------------------
 //  SYSTEM MODULE
@@ -584,6 +619,13 @@ void VM_QuitCoal()
 }
 
 
+void VM_ShowStats()
+{
+	if (ui_vm)
+		ui_vm->ShowStats();
+}
+
+
 void VM_LoadCoalFire(const char *filename)
 {
 	epi::file_c *F = epi::FS_Open(filename, epi::file_c::ACCESS_READ | epi::file_c::ACCESS_BINARY);
@@ -594,15 +636,12 @@ void VM_LoadCoalFire(const char *filename)
 		return;
 	}
 
-	I_Printf("Compiling COAL script: %s\n", filename);
-
+	int length = F->GetLength();
 	byte *data = F->LoadIntoMemory();
 
-	if (! ui_vm->CompileFile((char *)data, filename))
-		I_Error("Errors compiling coal script: %s\n", filename);
-
-	delete[] data;
 	delete F;
+
+	coal_sources.push_back(coal_source_c(filename, false, data, length));
 }
 
 void VM_LoadLumpOfCoal(int lump)
@@ -612,12 +651,98 @@ void VM_LoadLumpOfCoal(int lump)
 	int length;
 	byte *data = W_ReadLumpAlloc(lump, &length);
 
-	I_Printf("Compiling %s lump\n", name);
+	coal_sources.push_back(coal_source_c(name, true, data, length));
+}
+
 
-	if (! ui_vm->CompileFile((char *)data, name))
-		I_Error("Errors compiling %s lump.\n", name);
+static std::string ImageFilename(void)
+{
+	// the image depends on the exact source of every script, in the
+	// same order, and on the engine version.
+	epi::crc32_c crc;
 
-	delete[] data;
+	crc.AddCStr(EDGEVERSTR);
+	crc += (s32_t) coal_sources.size();
+
+	for (int i = 0; i < (int)coal_sources.size(); i++)
+	{
+		const coal_source_c& src = coal_sources[i];
+
+		crc.AddCStr(src.name.c_str());
+		crc += (s32_t) src.length;
+		crc.AddBlock(src.data, src.length);
+	}
+
+	std::string name = epi::STR_Format("coal-%08X.img", crc.crc);
+
+	return epi::PATH_Join(cache_dir.c_str(), name.c_str());
+}
+
+static void CompileSources(void)
+{
+	for (int i = 0; i < (int)coal_sources.size(); i++)
+	{
+		const coal_source_c& src = coal_sources[i];
+
+		if (src.is_lump)
+		{
+			I_Printf("Compiling %s lump\n", src.name.c_str());
+
+			if (! ui_vm->CompileFile((char *)src.data, src.name.c_str()))
+				I_Error("Errors compiling %s lump.\n", src.name.c_str());
+		}
+		else
+		{
+			I_Printf("Compiling COAL script: %s\n", src.name.c_str());
+
+			if (! ui_vm->CompileFile((char *)src.data, src.name.c_str()))
+				I_Error("Errors compiling coal script: %s\n", src.name.c_str());
+		}
+	}
+}
+
+static void VM_CompileScripts(void)
+{
+	std::string img_name;
+
+	int start = I_GetMillies();
+
+	if (coal_cache > 0 && ! cache_dir.empty())
+	{
+		img_name = ImageFilename();
+
+		if (ui_vm->LoadImage(img_name.c_str()))
+		{
+			I_Printf("Loaded COAL image: %s (%d ms)\n", img_name.c_str(),
+				I_GetMillies() - start);
+			return;
+		}
+	}
+
+	CompileSources();
+
+	I_Printf("COAL: compiled %d scripts in %d ms\n", (int)coal_sources.size(),
+		I_GetMillies() - start);
+
+	if (! img_name.empty())
+	{
+		std::string temp_name = img_name + ".tmp";
+
+		// an unusable image may already exist
+		if (epi::FS_Access(img_name.c_str(), epi::file_c::ACCESS_READ))
+			epi::FS_Delete(img_name.c_str());
+
+		if (ui_vm->SaveImage(temp_name.c_str()) &&
+			epi::FS_Rename(temp_name.c_str(), img_name.c_str()))
+		{
+			I_Debugf("Saved COAL image: %s\n", img_name.c_str());
+		}
+		else
+		{
+			I_Warning("Failed to save COAL image: %s\n", img_name.c_str());
+			epi::FS_Delete(temp_name.c_str());
+		}
+	}
 }
 
 
@@ -640,6 +765,13 @@ void VM_LoadScripts()
 	ddf_dir.clear(); //used to be script_dir...
 
 	W_ReadCoalLumps();
+
+	VM_CompileScripts();
+
+	for (int i = 0; i < (int)coal_sources.size(); i++)
+		delete[] coal_sources[i].data;
+
+	coal_sources.clear();
 }
 
 
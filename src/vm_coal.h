@@ -29,6 +29,18 @@ void VM_LoadCoalFire(const char *filename);
 void VM_LoadLumpOfCoal(int lump);
 void VM_LoadScripts();
 
+int  VM_FindFunction(coal::vm_c *vm, const char *name);
+// look up a script function, giving an error if it does not exist.
+// The result can be kept and passed to VM_CallFunction() each time,
+// since scripts are only compiled at startup.
+
+void VM_CallFunction(coal::vm_c *vm, int func, const char *name);
+void VM_CallFunction(coal::vm_c *vm, const char *name);
+
+void VM_ShowStats();
+// print memory usage of the UI vm (including the temporary strings
+// used by the last frame).
+
 void VM_RegisterHUD(coal::vm_c *vm);
 void VM_RegisterPlaysim(coal::vm_c *vm);
 
@@ -735,9 +735,17 @@ void VM_RegisterHUD(coal::vm_c *vm)
 	vm->AddNativeFunction("hud.play_sound",      HD_play_sound);
 }
 
+// script entry points, looked up on first use
+static int func_begin_level = 0;
+static int func_draw_all    = 0;
+static int func_draw_split  = 0;
+
 void VM_BeginLevel(void)
 {
-    VM_CallFunction(ui_vm, "begin_level");
+	if (! func_begin_level)
+		func_begin_level = VM_FindFunction(ui_vm, "begin_level");
+
+	VM_CallFunction(ui_vm, func_begin_level, "begin_level");
 }
 
 void VM_RunHud(int split)
@@ -753,9 +761,19 @@ void VM_RunHud(int split)
 
 	//VM_CallFunction(ui_vm, "draw_all");
 	if (split > 0)
-		VM_CallFunction(ui_vm, "draw_split");
+	{
+		if (! func_draw_split)
+			func_draw_split = VM_FindFunction(ui_vm, "draw_split");
+
+		VM_CallFunction(ui_vm, func_draw_split, "draw_split");
+	}
 	else
-		VM_CallFunction(ui_vm, "draw_all");
+	{
+		if (! func_draw_all)
+			func_draw_all = VM_FindFunction(ui_vm, "draw_all");
+
+		VM_CallFunction(ui_vm, func_draw_all, "draw_all");
+	}
 
 	if (split > 0)
 		HUD_FrameSetup(0);
@@ -35,6 +35,7 @@
 //
 
 #include "system/i_defs.h"
+#include "system/i_sdlinc.h"
 
 #include <limits.h>
 
@@ -58,6 +59,7 @@
 #include "../ddf/style.h"
 #include "../ddf/switch.h"
 
+#include "con_var.h"
 #include "dm_data.h"
 #include "dm_defs.h"
 #include "dm_state.h"
@@ -67,9 +69,11 @@
 #include "e_search.h"
 #include "l_deh.h"
 #include "l_ajbsp.h"
+#include "m_argv.h"
 #include "m_misc.h"
 #include "r_image.h"
 #include "rad_trig.h"
+#include "version.h"
 #include "vm_coal.h"
 #include "games/wolf3d/wlf_local.h"
 #include "games/wolf3d/wlf_rawdef.h"
@@ -3108,6 +3112,273 @@ static void LoadTntPlutGame(void)
 		TryLoadExtraGame("PLUTGAME");
 }
 
+// keep a snapshot of the parsed DDF in the cache directory
+DEF_CVAR(ddf_snapshot, int, "c", 1);
+
+// maximum number of threads for staging DDF lumps (0 = none)
+DEF_CVAR(ddf_threads, int, "c", 0);
+
+//
+// Time taken by each reader, and the DDF bytes it lexed or replayed
+// (from a snapshot or staging).  The -ddfbench option shows them, and
+// times the name/number lookups which the rest of the engine uses.
+//
+static u32_t ddf_bench_time[NUM_DDF_READERS];
+static int   ddf_bench_size[NUM_DDF_READERS];
+static int   ddf_bench_replayed[NUM_DDF_READERS];
+static u32_t ddf_bench_replay_time[NUM_DDF_READERS];
+
+static void W_BenchmarkLookups(void)
+{
+	const int REPEAT = 100;
+
+	int total = 0;
+	int found = 0;
+
+	u32_t start = I_ReadMicroSeconds();
+
+	for (int r = 0; r < REPEAT; r++)
+	{
+		for (int i = 0; i < mobjtypes.GetSize(); i++)
+		{
+			const mobjtype_c *m = mobjtypes[i];
+
+			found += (mobjtypes.Lookup(m->name.c_str()) == m) ? 1 : 0;
+
+			if (m->number > 0)
+				found += mobjtypes.Lookup(m->number) ? 1 : 0;
+
+			total += (m->number > 0) ? 2 : 1;
+		}
+
+		for (int i = 0; i < weapondefs.GetSize(); i++, total++)
+			found += weapondefs.Lookup(weapondefs[i]->name.c_str()) ? 1 : 0;
+
+		for (int i = 0; i < atkdefs.GetSize(); i++, total++)
+			found += atkdefs.Lookup(atkdefs[i]->name.c_str()) ? 1 : 0;
+
+		for (int i = 0; i < sfxdefs.GetSize(); i++, total++)
+			found += sfxdefs.Lookup(sfxdefs[i]->name.c_str()) ? 1 : 0;
+	}
+
+	u32_t elapsed = I_ReadMicroSeconds() - start;
+
+	I_Printf("DDF lookups: %d things, %d weapons, %d attacks, %d sounds\n",
+		mobjtypes.GetSize(), weapondefs.GetSize(), atkdefs.GetSize(),
+		sfxdefs.GetSize());
+
+	I_Printf("DDF lookups: %d in %u us (%1.3f us each), %d found\n",
+		total, elapsed, total ? elapsed / (double)total : 0.0, found);
+}
+
+static void W_ShowDDFBenchmark(void)
+{
+	u32_t total_time = 0;
+	int   total_size = 0;
+	int   total_replayed = 0;
+
+	I_Printf("DDF load benchmark:\n");
+
+	for (int d = 0; d < NUM_DDF_READERS; d++)
+	{
+		I_Printf("  %-12s %8d bytes %8d replayed %8.2f ms\n", DDF_Readers[d].print_name,
+			ddf_bench_size[d], ddf_bench_replayed[d], ddf_bench_time[d] / 1000.0);
+
+		total_time += ddf_bench_time[d];
+		total_size += ddf_bench_size[d];
+		total_replayed += ddf_bench_replayed[d];
+	}
+
+	I_Printf("  %-12s %8d bytes %8d replayed %8.2f ms\n", "TOTAL", total_size,
+		total_replayed, total_time / 1000.0);
+
+	W_BenchmarkLookups();
+}
+
+//
+// Staging: all the DDF lumps are lexed on worker threads before
+// the normal (serial) loading.  That replays what was staged, in
+// the usual order, so the definitions and any overrides come out
+// exactly the same.
+//
+typedef struct
+{
+	int lump;
+
+	char *data;
+	int length;
+
+	snap_block_c *block;
+}
+ddf_stage_job_t;
+
+static std::vector<ddf_stage_job_t> stage_jobs;
+static SDL_atomic_t stage_next;
+
+static int W_StageThreadFunc(void *unused)
+{
+	for (;;)
+	{
+		int i = SDL_AtomicAdd(&stage_next, 1);
+
+		if (i >= (int)stage_jobs.size())
+			break;
+
+		ddf_stage_job_t& job = stage_jobs[i];
+
+		job.block = DDF_StageFile(job.data, job.length);
+	}
+
+	return 0;
+}
+
+static void W_StageDDF(void)
+{
+	// no gain with a single core
+	if (MIN(ddf_threads, SDL_GetCPUCount()) < 2)
+		return;
+
+	u32_t start = I_ReadMicroSeconds();
+
+	for (int d = 0; d < NUM_DDF_READERS; d++)
+	{
+		// RTS scripts have their own parser
+		if (d == RTS_READER)
+			continue;
+
+		for (int f = 0; f < (int)data_files.size(); f++)
+		{
+			data_file_c *df = data_files[f];
+
+			if (df->kind >= FLKIND_Demo || df->kind == FLKIND_EWad)
+				continue;
+
+			if (df->ddf_lumps[d] < 0)
+				continue;
+
+			ddf_stage_job_t job;
+
+			job.lump  = df->ddf_lumps[d];
+			job.data  = (char *)W_ReadLumpAlloc(job.lump, &job.length);
+			job.block = NULL;
+
+			stage_jobs.push_back(job);
+		}
+	}
+
+	int total = (int)stage_jobs.size();
+
+	if (total == 0)
+		return;
+
+	int threads = MIN(ddf_threads, MIN(SDL_GetCPUCount(), total));
+
+	// the main thread is one of the workers
+	std::vector<SDL_Thread *> workers;
+
+	SDL_AtomicSet(&stage_next, 0);
+
+	for (int t = 1; t < threads; t++)
+	{
+		SDL_Thread *thread = SDL_CreateThread(W_StageThreadFunc, "EDGE DDF Stage", NULL);
+
+		if (thread)
+			workers.push_back(thread);
+	}
+
+	W_StageThreadFunc(NULL);
+
+	for (int t = 0; t < (int)workers.size(); t++)
+		SDL_WaitThread(workers[t], NULL);
+
+	int staged = 0;
+
+	for (int i = 0; i < total; i++)
+	{
+		if (stage_jobs[i].block)
+		{
+			DDF_AddStaged(stage_jobs[i].block);
+			staged++;
+		}
+	}
+
+	I_Printf("DDF: staged %d of %d lumps on %d threads in %1.1f ms\n", staged,
+		total, (int)workers.size() + 1, (I_ReadMicroSeconds() - start) / 1000.0);
+}
+
+// use the copy of a lump read for staging, if there is one
+static char * W_ReadDDFLump(int lump, int *length)
+{
+	for (int i = 0; i < (int)stage_jobs.size(); i++)
+	{
+		ddf_stage_job_t& job = stage_jobs[i];
+
+		if (job.lump == lump && job.data)
+		{
+			char *data = job.data;
+			*length = job.length;
+
+			job.data = NULL;
+			return data;
+		}
+	}
+
+	return (char *)W_ReadLumpAlloc(lump, length);
+}
+
+static void W_FreeStagedLumps(void)
+{
+	for (int i = 0; i < (int)stage_jobs.size(); i++)
+		delete[] stage_jobs[i].data;
+
+	stage_jobs.clear();
+}
+
+static void W_FinishDDFSnapshot(const std::string& snap_name)
+{
+	int replayed, staged, parsed;
+
+	DDF_SnapshotStats(&replayed, &staged, &parsed);
+
+	I_Printf("DDF snapshot: %d files replayed, %d staged, %d parsed\n",
+		replayed, staged, parsed);
+
+	if (snap_name.empty() || ! DDF_SnapshotChanged())
+	{
+		DDF_SnapshotEnd(NULL);
+		return;
+	}
+
+	std::string temp_name = snap_name + ".tmp";
+
+	if (epi::FS_Access(snap_name.c_str(), epi::file_c::ACCESS_READ))
+		epi::FS_Delete(snap_name.c_str());
+
+	if (DDF_SnapshotEnd(temp_name.c_str()) &&
+		epi::FS_Rename(temp_name.c_str(), snap_name.c_str()))
+	{
+		I_Debugf("Saved DDF snapshot: %s\n", snap_name.c_str());
+	}
+	else
+	{
+		I_Warning("Failed to save DDF snapshot: %s\n", snap_name.c_str());
+		epi::FS_Delete(temp_name.c_str());
+	}
+}
+
+// call a DDF reader for one file, and keep track of the time spent
+// replaying it (instead of lexing it).
+static void W_CallDDFReader(int d, char *data, int length)
+{
+	u32_t start = I_ReadMicroSeconds();
+	int   start_replayed = DDF_MainReplayedBytes();
+
+	(*DDF_Readers[d].func)(data, length);
+
+	if (DDF_MainReplayedBytes() != start_replayed)
+		ddf_bench_replay_time[d] += I_ReadMicroSeconds() - start;
+}
+
 void W_ReadDDF(void)
 {
 	// -AJA- the order here may look strange.  Since DDF files
@@ -3115,14 +3386,42 @@ void W_ReadDDF(void)
 	// load all lumps of a certain type together (e.g. all
 	// DDFSFX lumps before all the DDFTHING lumps).
 
+	bool bench = (M_CheckParm("-ddfbench") > 0);
+
+	u32_t load_start = I_ReadMicroSeconds();
+
+	std::string snap_name;
+
+	if (ddf_snapshot > 0 && ! cache_dir.empty())
+	{
+		snap_name = epi::PATH_Join(cache_dir.c_str(), "ddf.snap");
+
+		if (! DDF_SnapshotBegin(snap_name.c_str(), EDGEVERSTR))
+			I_Debugf("No usable DDF snapshot: %s\n", snap_name.c_str());
+	}
+	else
+	{
+		// still needed for staging
+		DDF_SnapshotBegin(NULL, EDGEVERSTR);
+	}
+
+	if (ddf_threads > 0)
+		W_StageDDF();
+
 	for (int d = 0; d < NUM_DDF_READERS; d++)
 	{
+		u32_t start = I_ReadMicroSeconds();
+		int   start_bytes = DDF_MainParsedBytes();
+		int   start_replayed = DDF_MainReplayedBytes();
+
+		ddf_bench_replay_time[d] = 0;
+
 		if (true)
 		{
 			I_Printf("Loading external %s\n", DDF_Readers[d].print_name);
 
 			// call read function
-			(*DDF_Readers[d].func)(NULL, 0);
+			W_CallDDFReader(d, NULL, 0);
 		}
 
 		for (int f = 0; f < (int)data_files.size(); f++)
@@ -3161,10 +3460,10 @@ void W_ReadDDF(void)
 				I_Printf("Loading %s from: %s\n", DDF_Readers[d].name, df->file_name);
 
 				int length;
-				char *data = (char *)W_ReadLumpAlloc(lump, &length);
+				char *data = W_ReadDDFLump(lump, &length);
 
 				// call read function
-				(*DDF_Readers[d].func)(data, length);
+				W_CallDDFReader(d, data, length);
 				delete[] data;
 			}
 
@@ -3208,8 +3507,41 @@ void W_ReadDDF(void)
 		///
 		///		E_ProgressMessage(msg_buf.c_str());
 
+		ddf_bench_time[d] = I_ReadMicroSeconds() - start;
+		ddf_bench_size[d] = DDF_MainParsedBytes() - start_bytes;
+		ddf_bench_replayed[d] = DDF_MainReplayedBytes() - start_replayed;
+
 		E_LocalProgress(d, NUM_DDF_READERS);
 	}
+
+	// parse throughput (RTS scripts have their own parser).  Replayed
+	// files were not lexed, so their bytes and time are left out.
+	u32_t parse_time  = 0;
+	int   parse_bytes = 0;
+	int   replay_bytes = 0;
+
+	for (int d = 0; d < NUM_DDF_READERS; d++)
+	{
+		if (d != RTS_READER)
+		{
+			parse_time  += ddf_bench_time[d] - ddf_bench_replay_time[d];
+			parse_bytes += ddf_bench_size[d];
+			replay_bytes += ddf_bench_replayed[d];
+		}
+	}
+
+	I_Printf("DDF: parsed %d KB in %1.1f ms (%1.2f MB/s), replayed %d KB\n",
+		parse_bytes / 1024, parse_time / 1000.0,
+		parse_time ? parse_bytes / (double)parse_time : 0.0,
+		replay_bytes / 1024);
+
+	I_Printf("DDF: loaded in %1.1f ms\n", (I_ReadMicroSeconds() - load_start) / 1000.0);
+
+	W_FreeStagedLumps();
+	W_FinishDDFSnapshot(snap_name);
+
+	if (bench)
+		W_ShowDDFBenchmark();
 }
 
 void W_ReadCoalLumps(void)